@@ -1,4 +0,0 @@
-.\glslc.exe .\Shader\Vertex\Shader0.vert -o .\Shader\Compiled_SPV\Vert0.spv
-.\glslc.exe .\Shader\Frag\Shader0.frag -o .\Shader\Compiled_SPV\Frag0.spv
-
-pause
\ No newline at end of file
@@ -2,24 +2,316 @@
 
 #include "VulkanApplication.h"
 #include "log.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
 #include <windows.h>
 
+// MyShaderToy.exe --offline <shader.frag> [--size 1920x1080] [--fps 60] [--frames 0:600] [--output frame_%05d.png]
+// Poster : MyShaderToy.exe --offline <shader.frag> --size 32768x16384 --tile 2048x256 --frames 120:121 --output poster.exr
+// Video : MyShaderToy.exe --offline <shader.frag> --video - [--video-format yuv420|yuv444|nv12|rgba8|rgba16] | ffmpeg -i - out.mp4
+// Batch : MyShaderToy.exe --batch <directory> [--size 256x144] [--timestamps 1,5,10] [--timeout 2] [--threads N] [--output thumbnails]
+// Golden tests : MyShaderToy.exe --golden <manifest> --reference <directory> [--pixel-threshold 2] [--max-diff-pixels 0.001] [--min-ssim 0.98] [--output golden_failures]
+//                without --reference the thumbnails are written as the references, exits with an error on any regression
+//                --record-hashes rewrites the expected hashes of the manifest with the ones of the run
+// Benchmark : MyShaderToy.exe --benchmark <directory|manifest> [--size 1920x1080] [--frames 0:600] [--warmup 60] [--timeout 2] [--output benchmark.json]
+//             [--baseline previous.json] [--regression 0.05], exits with an error when a median GPU time regressed
+//             [--ab O] renders every frame with --spirv and this recipe per shader and reports the GPU time delta
+// SPIR-V : [--spirv O0|O|Os|O+unroll] optimization recipe of every offline mode, O+unroll needs spirv-opt.exe
+// Multi device : [--devices all|N] spreads frame chunks or poster bands over the eligible physical devices, --offline only
+// 8/16 bits captures : [--tonemap clamp|reinhard|aces] [--exposure 1.0] [--srgb] [--dither]
+// Motion blur : [--subframes 16] [--shutter 0.5] [--jitter] averages jittered sub-frames on the GPU per output frame, frame sequences and videos only
+
+static bool ParseOfflineArguments(int argc, char** argv, OfflineRenderSettings& settings)
+{
+    bool offline = false;
+    bool sizeSet = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--srgb")
+        {
+            settings.Capture.SrgbEncode = true;
+        }
+        else if (arg == "--dither")
+        {
+            settings.Capture.Dither = true;
+        }
+        else if (arg == "--jitter")
+        {
+            settings.SubPixelJitter = true;
+        }
+        else if (arg == "--offline" && hasValue)
+        {
+            settings.ShaderPath = argv[++i];
+            offline = true;
+        }
+        else if (arg == "--size" && hasValue)
+        {
+            if (sscanf_s(argv[++i], "%ux%u", &settings.Width, &settings.Height) != 2 || settings.Width == 0 || settings.Height == 0)
+                throw std::runtime_error("Invalid --size, expected <width>x<height> !");
+            sizeSet = true;
+        }
+        else if (arg == "--fps" && hasValue)
+        {
+            settings.Fps = atof(argv[++i]);
+            if (settings.Fps <= 0.)
+                throw std::runtime_error("Invalid --fps !");
+        }
+        else if (arg == "--frames" && hasValue)
+        {
+            if (sscanf_s(argv[++i], "%u:%u", &settings.StartFrame, &settings.EndFrame) != 2 || settings.EndFrame < settings.StartFrame)
+                throw std::runtime_error("Invalid --frames, expected <start>:<end> !");
+        }
+        else if (arg == "--tile" && hasValue)
+        {
+            if (sscanf_s(argv[++i], "%ux%u", &settings.TileSize.x, &settings.TileSize.y) != 2 || settings.TileSize.x == 0 || settings.TileSize.y == 0)
+                throw std::runtime_error("Invalid --tile, expected <width>x<height> !");
+        }
+        else if (arg == "--output" && hasValue)
+        {
+            settings.OutputPattern = argv[++i];
+        }
+        else if (arg == "--video" && hasValue)
+        {
+            settings.VideoTarget = argv[++i];
+        }
+        else if (arg == "--video-format" && hasValue)
+        {
+            if (!VideoStreamWriter::ParseFormat(argv[++i], settings.VideoOutputFormat))
+                throw std::runtime_error("Invalid --video-format, expected rgba8, rgba16, yuv420, yuv444 or nv12 !");
+        }
+        else if (arg == "--batch" && hasValue)
+        {
+            settings.Batch.Directory = argv[++i];
+            offline = true;
+        }
+        else if (arg == "--timestamps" && hasValue)
+        {
+            settings.Batch.Timestamps.clear();
+
+            std::stringstream list(argv[++i]);
+            std::string timestamp;
+            while (std::getline(list, timestamp, ','))
+                settings.Batch.Timestamps.push_back(static_cast<float>(atof(timestamp.c_str())));
+
+            if (settings.Batch.Timestamps.empty())
+                throw std::runtime_error("Invalid --timestamps, expected <t0>,<t1>,... !");
+        }
+        else if (arg == "--timeout" && hasValue)
+        {
+            settings.Batch.TimeoutSeconds = static_cast<float>(atof(argv[++i]));
+            if (settings.Batch.TimeoutSeconds <= 0.f)
+                throw std::runtime_error("Invalid --timeout !");
+        }
+        else if (arg == "--threads" && hasValue)
+        {
+            const int threads = atoi(argv[++i]);
+            if (threads <= 0)
+                throw std::runtime_error("Invalid --threads, expected a positive thread count !");
+            settings.Batch.ThreadCount = static_cast<uint32_t>(threads);
+        }
+        else if (arg == "--devices" && hasValue)
+        {
+            std::string devices = argv[++i];
+            settings.DeviceCount = devices == "all" ? 0u : static_cast<uint32_t>(atoi(devices.c_str()));
+            if (devices != "all" && settings.DeviceCount == 0)
+                throw std::runtime_error("Invalid --devices, expected all or a device count !");
+        }
+        else if (arg == "--tonemap" && hasValue)
+        {
+            std::string op = argv[++i];
+            if (op == "clamp")
+                settings.Capture.ToneMap = ToneMapOperator::Clamp;
+            else if (op == "reinhard")
+                settings.Capture.ToneMap = ToneMapOperator::Reinhard;
+            else if (op == "aces")
+                settings.Capture.ToneMap = ToneMapOperator::Aces;
+            else
+                throw std::runtime_error("Invalid --tonemap, expected clamp, reinhard or aces !");
+        }
+        else if (arg == "--exposure" && hasValue)
+        {
+            settings.Capture.Exposure = static_cast<float>(atof(argv[++i]));
+            if (settings.Capture.Exposure <= 0.f)
+                throw std::runtime_error("Invalid --exposure !");
+        }
+        else if (arg == "--golden" && hasValue)
+        {
+            settings.Batch.Manifest = argv[++i];
+            offline = true;
+        }
+        else if (arg == "--record-hashes")
+        {
+            settings.Batch.RecordHashes = true;
+        }
+        else if (arg == "--reference" && hasValue)
+        {
+            settings.Batch.ReferenceDirectory = argv[++i];
+        }
+        else if (arg == "--pixel-threshold" && hasValue)
+        {
+            settings.Batch.Tolerance.PixelThreshold = static_cast<uint8_t>(std::clamp(atoi(argv[++i]), 0, 255));
+        }
+        else if (arg == "--max-diff-pixels" && hasValue)
+        {
+            settings.Batch.Tolerance.MaxDifferentPixels = static_cast<float>(atof(argv[++i]));
+        }
+        else if (arg == "--min-ssim" && hasValue)
+        {
+            settings.Batch.Tolerance.MinSsim = static_cast<float>(atof(argv[++i]));
+        }
+        else if (arg == "--benchmark" && hasValue)
+        {
+            std::string shaders = argv[++i];
+            if (std::filesystem::is_directory(shaders))
+                settings.Batch.Directory = shaders;
+            else
+                settings.Batch.Manifest = shaders;
+            settings.Benchmark.Enabled = true;
+            offline = true;
+        }
+        else if (arg == "--warmup" && hasValue)
+        {
+            settings.Benchmark.WarmupFrames = static_cast<uint32_t>(atoi(argv[++i]));
+        }
+        else if (arg == "--baseline" && hasValue)
+        {
+            settings.Benchmark.BaselinePath = argv[++i];
+        }
+        else if (arg == "--regression" && hasValue)
+        {
+            settings.Benchmark.RegressionThreshold = static_cast<float>(atof(argv[++i]));
+            if (settings.Benchmark.RegressionThreshold < 0.f)
+                throw std::runtime_error("Invalid --regression, expected a relative slowdown !");
+        }
+        else if ((arg == "--spirv" || arg == "--ab") && hasValue)
+        {
+            int32_t recipe = FindSpirvRecipe(argv[++i]);
+            if (recipe < 0)
+                throw std::runtime_error("Invalid " + arg + ", expected O0, O, Os or O+unroll !");
+
+            if (arg == "--spirv")
+                settings.SpirvRecipe = static_cast<uint32_t>(recipe);
+            else
+                settings.Benchmark.CompareRecipe = recipe;
+        }
+        else if (arg == "--subframes" && hasValue)
+        {
+            settings.SubFrames = static_cast<uint32_t>(atoi(argv[++i]));
+            if (settings.SubFrames == 0)
+                throw std::runtime_error("Invalid --subframes !");
+        }
+        else if (arg == "--shutter" && hasValue)
+        {
+            settings.Shutter = static_cast<float>(atof(argv[++i]));
+            if (settings.Shutter < 0.f || settings.Shutter > 1.f)
+                throw std::runtime_error("Invalid --shutter, expected a fraction of the frame interval !");
+        }
+        else
+        {
+            throw std::runtime_error("Unknown argument " + arg + " !");
+        }
+    }
+
+    // Every option configures an offline mode, the window takes none
+    if (!offline && argc > 1)
+        throw std::runtime_error(std::string(argv[1]) + " needs --offline, --batch, --golden or --benchmark !");
+
+    // Batch, golden and benchmark runs compare devices through their timings and hashes, they stay on one
+    if ((settings.Benchmark.Enabled || settings.Batch.IsEnabled()) && settings.DeviceCount != 1)
+        throw std::runtime_error("--devices only applies to --offline renders !");
+
+    // Sub-frames are averaged per frame of a sequence, thumbnails, benchmark frames and posters are single instants
+    const bool poster = settings.TileSize.x > 0 && settings.TileSize.y > 0;
+    if ((settings.Benchmark.Enabled || settings.Batch.IsEnabled() || poster) && settings.SubFrames > 1)
+        throw std::runtime_error("--subframes only applies to --offline frame sequences and videos !");
+
+    // The hashes are recorded from the thumbnails of a golden manifest, against no reference
+    if (settings.Batch.RecordHashes && (settings.Batch.Manifest.empty() || settings.Benchmark.Enabled || !settings.Batch.ReferenceDirectory.empty()))
+        throw std::runtime_error("--record-hashes needs --golden <manifest> without --reference !");
+
+    if (settings.Benchmark.Enabled)
+    {
+        // Full size by default, --output names the report
+        if (settings.OutputPattern != OfflineRenderSettings().OutputPattern)
+            settings.Benchmark.OutputPath = settings.OutputPattern;
+    }
+    else if (settings.Batch.IsEnabled())
+    {
+        // Thumbnails by default, --output names the output directory
+        if (!sizeSet)
+        {
+            settings.Width = 256;
+            settings.Height = 144;
+        }
+
+        if (settings.OutputPattern != OfflineRenderSettings().OutputPattern)
+            settings.Batch.OutputDirectory = settings.OutputPattern;
+        else if (!settings.Batch.ReferenceDirectory.empty())
+            settings.Batch.OutputDirectory = "golden_failures";
+    }
+    else if (offline)
+    {
+        if (poster && !settings.VideoTarget.empty())
+            throw std::runtime_error("--video and --tile can't be combined !");
+
+        // One file per frame needs the frame number, a poster is a single file
+        const int conversions = CountFrameConversions(settings.OutputPattern);
+        if ((poster || settings.VideoTarget.empty()) && (conversions < 0 || conversions > 1 || (conversions == 0 && !poster)))
+            throw std::runtime_error("Invalid --output, expected a single %d frame number conversion (%05d) and %% for a literal % !");
+
+        // The tiles are offset through the generated main, a complete source renders the same tile everywhere
+        if (poster)
+        {
+            std::ifstream file(settings.ShaderPath, std::ios::binary);
+            const std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            if (IsCompleteShaderSource(source))
+                throw std::runtime_error("--tile needs a mainImage shader, " + settings.ShaderPath + " has its own #version and main !");
+        }
+    }
+
+    return offline;
+}
+
+static int Run(int argc, char** argv)
+{
+    OfflineRenderSettings offlineSettings;
+
+    if (ParseOfflineArguments(argc, argv, offlineSettings))
+    {
+        // Before anything is logged, stdout then only carries the video
+        if (offlineSettings.VideoTarget == "-")
+            VideoStreamWriter::ReserveStdout();
+
+        VulkanApplication VulkanApp("MyShaderToy", 0, "MyEngine", 0, offlineSettings);
+        return VulkanApp.run();
+    }
+
+    VulkanApplication VulkanApp("MyShaderToy", 0, "MyEngine", 0, 1080, 720);
+    return VulkanApp.run();
+}
+
 #ifdef NDEBUG
 
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
 {
     try
     {
-        VulkanApplication VulkanApp("MyShaderToy", 0, "MyEngine", 0, 1080, 720);
-        VulkanApp.run();
+        return Run(__argc, __argv);
     }
     catch (std::exception& e)
     {
-        MessageBoxA(NULL, e.what(), "Erreur", MB_ICONERROR | MB_OK);
+        // Command line runs are scripted : a message box would wait for a click
+        if (__argc > 1)
+            std::cerr << e.what() << std::endl;
+        else
+            MessageBoxA(NULL, e.what(), "Erreur", MB_ICONERROR | MB_OK);
         exit(-1);
     }
-    
-    return 0;
 }
 
 #else
@@ -28,16 +320,13 @@ int main(int argc, char** argv)
 {
     try
     {
-        VulkanApplication VulkanApp("MyShaderToy", 0, "MyEngine", 0, 1080, 720);
-        VulkanApp.run();
+        return Run(argc, argv);
     }
     catch (std::exception& e)
     {
         debug_log(e.what());
         exit(-1);
     }
-    
-    return 0;
 
 }
 
@@ -0,0 +1,19 @@
+// Benchmark : fbm value noise, two levels of domain warping for 40 noise evaluations per pixel
+
+#include "../Include/Fbm.glsl"
+
+void mainImage( out vec4 fragColor, in vec2 fragCoord )
+{
+    vec2 uv = 3.0 * fragCoord / iResolution.y;
+
+    vec2 q = vec2(fbm(uv + 0.05 * iTime), fbm(uv + vec2(5.2, 1.3)));
+    vec2 r = vec2(fbm(uv + 4.0 * q + vec2(1.7, 9.2) + 0.15 * iTime),
+                  fbm(uv + 4.0 * q + vec2(8.3, 2.8) + 0.126 * iTime));
+    float f = fbm(uv + 4.0 * r);
+
+    vec3 col = mix(vec3(0.1, 0.35, 0.4), vec3(0.65, 0.6, 0.45), clamp(f * f * 4.0, 0.0, 1.0));
+    col = mix(col, vec3(0.0, 0.0, 0.16), clamp(length(q), 0.0, 1.0));
+    col = mix(col, vec3(0.95, 0.9, 0.8), clamp(abs(r.x), 0.0, 1.0));
+
+    fragColor = vec4(1.6 * col * (f * f * f + 0.6 * f * f + 0.5 * f), 1.0);
+}
@@ -0,0 +1,44 @@
+// Benchmark : second pass of a fluid simulation. The simulation pass advances the Gray-Scott state of iChannel1
+// once per benchmark frame (batch and golden thumbnails see the state after its first step),
+// this pass derives a divergence free velocity from it (curl of the B concentration) and advects dye along it
+// with a semi-Lagrangian backtrace : 24 steps of 5 dependent fetches each.
+
+float concentration(vec2 uv)
+{
+    return textureLod(iChannel1, uv, 0.0).y;
+}
+
+vec2 velocity(vec2 uv, vec2 texel)
+{
+    float n = concentration(uv + vec2(0.0, texel.y));
+    float s = concentration(uv - vec2(0.0, texel.y));
+    float e = concentration(uv + vec2(texel.x, 0.0));
+    float w = concentration(uv - vec2(texel.x, 0.0));
+
+    // Curl of a scalar stream function
+    return 40.0 * vec2(n - s, w - e);
+}
+
+void mainImage( out vec4 fragColor, in vec2 fragCoord )
+{
+    vec2 uv = fragCoord / iResolution.xy;
+    vec2 texel = 1.0 / vec2(textureSize(iChannel1, 0));
+
+    const float decay = 0.92;
+
+    vec2 p = uv;
+    float dye = 0.0;
+    float weight = 1.0;
+    for (int i = 0; i < 24; i++)
+    {
+        p -= 2.0 * velocity(p, texel) * texel;
+        dye += weight * concentration(p);
+        weight *= decay;
+    }
+    dye *= (1.0 - decay) / (1.0 - pow(decay, 24.0));
+
+    vec3 col = mix(vec3(0.02, 0.05, 0.1), vec3(0.9, 0.6, 0.3), clamp(3.0 * dye, 0.0, 1.0));
+    col += vec3(0.2, 0.5, 0.9) * clamp(0.2 * length(velocity(uv, texel)), 0.0, 1.0);
+
+    fragColor = vec4(col, 1.0);
+}
@@ -0,0 +1,39 @@
+// Benchmark : loop heavy fractal, a Mandelbrot zoom with up to 1024 iterations per sample and 2x2 supersampling
+
+const int MaxIterations = 1024;
+
+// Smooth iteration count, -1 inside the set
+float mandelbrot(vec2 c)
+{
+    vec2 z = vec2(0.0);
+    for (int i = 0; i < MaxIterations; i++)
+    {
+        z = vec2(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + c;
+        float m = dot(z, z);
+        if (m > 256.0)
+            return float(i) - log2(log2(m)) + 4.0;
+    }
+    return -1.0;
+}
+
+void mainImage( out vec4 fragColor, in vec2 fragCoord )
+{
+    // Single precision stops resolving details below a 2^-12 zoom
+    float zoom = pow(0.5, 8.0 + 4.0 * (0.5 - 0.5 * cos(0.1 * iTime)));
+    vec2 center = vec2(-0.743643887, 0.131825904);
+
+    vec3 col = vec3(0.0);
+    for (int sy = 0; sy < 2; sy++)
+    {
+        for (int sx = 0; sx < 2; sx++)
+        {
+            vec2 offset = 0.5 * vec2(sx, sy) - 0.25;
+            vec2 p = (2.*(fragCoord + offset) - iResolution.xy) / iResolution.y;
+
+            float n = mandelbrot(center + zoom * p);
+            col += n < 0.0 ? vec3(0.0) : 0.5 + 0.5 * cos(3.0 + 0.05 * n + vec3(0.0, 0.6, 1.0));
+        }
+    }
+
+    fragColor = vec4(0.25 * col, 1.0);
+}
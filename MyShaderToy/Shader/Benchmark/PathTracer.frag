@@ -0,0 +1,139 @@
+// Benchmark : path tracer, spheres in a box lit by a spherical area light, 4 samples per pixel and 5 bounces.
+// The random sequence is seeded with the pixel and iFrame, every frame is deterministic.
+
+uint seed;
+
+uint pcgHash(uint v)
+{
+    uint state = v * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float random()
+{
+    seed = pcgHash(seed);
+    return float(seed) / 4294967295.0;
+}
+
+struct Hit
+{
+    float T;
+    vec3 Normal;
+    vec3 Albedo;
+    vec3 Emission;
+};
+
+void intersectSphere(vec3 ro, vec3 rd, vec4 sphere, vec3 albedo, vec3 emission, inout Hit hit)
+{
+    vec3 oc = ro - sphere.xyz;
+    float b = dot(oc, rd);
+    float h = b * b - dot(oc, oc) + sphere.w * sphere.w;
+    if (h < 0.0)
+        return;
+
+    h = sqrt(h);
+    float t = -b - h < 1e-3 ? -b + h : -b - h;
+    if (t < 1e-3 || t > hit.T)
+        return;
+
+    hit.T = t;
+    hit.Normal = normalize(ro + rd * t - sphere.xyz);
+    hit.Albedo = albedo;
+    hit.Emission = emission;
+}
+
+// plane : dot(plane.xyz, p) + plane.w = 0
+void intersectPlane(vec3 ro, vec3 rd, vec4 plane, vec3 albedo, inout Hit hit)
+{
+    float denom = dot(plane.xyz, rd);
+    if (abs(denom) < 1e-6)
+        return;
+
+    float t = -(dot(plane.xyz, ro) + plane.w) / denom;
+    if (t < 1e-3 || t > hit.T)
+        return;
+
+    hit.T = t;
+    hit.Normal = plane.xyz;
+    hit.Albedo = albedo;
+    hit.Emission = vec3(0.0);
+}
+
+Hit intersectScene(vec3 ro, vec3 rd)
+{
+    Hit hit;
+    hit.T = 1e9;
+    hit.Normal = vec3(0.0);
+    hit.Albedo = vec3(0.0);
+    hit.Emission = vec3(0.0);
+
+    intersectPlane(ro, rd, vec4(0.0, 1.0, 0.0, 1.0), vec3(0.75), hit);
+    intersectPlane(ro, rd, vec4(0.0, -1.0, 0.0, 1.0), vec3(0.75), hit);
+    intersectPlane(ro, rd, vec4(0.0, 0.0, 1.0, 1.0), vec3(0.75), hit);
+    intersectPlane(ro, rd, vec4(1.0, 0.0, 0.0, 1.0), vec3(0.75, 0.2, 0.2), hit);
+    intersectPlane(ro, rd, vec4(-1.0, 0.0, 0.0, 1.0), vec3(0.2, 0.75, 0.2), hit);
+
+    intersectSphere(ro, rd, vec4(-0.45, -0.6, -0.3, 0.4), vec3(0.8), vec3(0.0), hit);
+    intersectSphere(ro, rd, vec4(0.5, -0.65, 0.2, 0.35), vec3(0.9, 0.8, 0.5), vec3(0.0), hit);
+
+    // Light : a cap of the sphere goes through the ceiling
+    intersectSphere(ro, rd, vec4(0.0, 1.9, 0.0, 1.0), vec3(0.0), vec3(12.0), hit);
+
+    hit.Normal = faceforward(hit.Normal, rd, hit.Normal);
+
+    return hit;
+}
+
+vec3 cosineDirection(vec3 n)
+{
+    float u = random();
+    float v = random();
+
+    float a = 6.2831853 * v;
+    float r = sqrt(u);
+
+    vec3 t = normalize(cross(n, abs(n.y) < 0.9 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+    vec3 b = cross(n, t);
+
+    return normalize(r * cos(a) * t + r * sin(a) * b + sqrt(1.0 - u) * n);
+}
+
+vec3 radiance(vec3 ro, vec3 rd)
+{
+    vec3 color = vec3(0.0);
+    vec3 throughput = vec3(1.0);
+
+    for (int bounce = 0; bounce < 5; bounce++)
+    {
+        Hit hit = intersectScene(ro, rd);
+        if (hit.T > 1e8)
+            break;
+
+        color += throughput * hit.Emission;
+        throughput *= hit.Albedo;
+
+        ro += rd * hit.T + hit.Normal * 1e-3;
+        rd = cosineDirection(hit.Normal);
+    }
+
+    return color;
+}
+
+void mainImage( out vec4 fragColor, in vec2 fragCoord )
+{
+    seed = (uint(fragCoord.x) * 1973u + uint(fragCoord.y) * 9277u + iFrame * 26699u) | 1u;
+
+    vec3 col = vec3(0.0);
+    for (int s = 0; s < 4; s++)
+    {
+        vec2 jitter = vec2(random(), random()) - 0.5;
+        vec2 p = (2.*(fragCoord + jitter) - iResolution.xy) / iResolution.y;
+
+        col += radiance(vec3(0.0, 0.0, 3.2), normalize(vec3(p, -2.0)));
+    }
+    col *= 0.25;
+
+    col = col / (1.0 + col);
+    fragColor = vec4(pow(col, vec3(0.4545)), 1.0);
+}
@@ -0,0 +1,114 @@
+// Benchmark : raymarched SDF scene, sphere tracing over repeated cells with soft shadows and ambient occlusion
+
+// Quality controls of the Shader panel, the defaults are the benchmarked values
+layout(constant_id = 0) const int MARCH_STEPS = 160;
+layout(constant_id = 1) const int SHADOW_STEPS = 48;
+
+float sdRoundBox(vec3 p, vec3 b, float r)
+{
+    vec3 q = abs(p) - b;
+    return length(max(q, 0.0)) + min(max(q.x, max(q.y, q.z)), 0.0) - r;
+}
+
+float sdTorus(vec3 p, vec2 t)
+{
+    vec2 q = vec2(length(p.xz) - t.x, p.y);
+    return length(q) - t.y;
+}
+
+float smin(float a, float b, float k)
+{
+    float h = clamp(0.5 + 0.5 * (b - a) / k, 0.0, 1.0);
+    return mix(b, a, h) - k * h * (1.0 - h);
+}
+
+float map(vec3 p)
+{
+    vec3 q = p;
+    q.xz = mod(q.xz + 2.0, 4.0) - 2.0;
+
+    float d = sdRoundBox(q, vec3(0.5), 0.1);
+    d = smin(d, length(q - vec3(0.0, 0.8 + 0.3 * sin(iTime), 0.0)) - 0.5, 0.3);
+    d = min(d, sdTorus(q - vec3(0.0, -0.6, 0.0), vec2(1.1, 0.12)));
+
+    return min(d, p.y + 1.0);
+}
+
+vec3 calcNormal(vec3 p)
+{
+    const vec2 e = vec2(1e-3, 0.0);
+    return normalize(vec3(map(p + e.xyy) - map(p - e.xyy),
+                          map(p + e.yxy) - map(p - e.yxy),
+                          map(p + e.yyx) - map(p - e.yyx)));
+}
+
+float softShadow(vec3 ro, vec3 rd)
+{
+    float res = 1.0;
+    float t = 0.02;
+    for (int i = 0; i < SHADOW_STEPS; i++)
+    {
+        float h = map(ro + rd * t);
+        res = min(res, 8.0 * h / t);
+        t += clamp(h, 0.02, 0.5);
+        if (res < 1e-3 || t > 20.0)
+            break;
+    }
+    return clamp(res, 0.0, 1.0);
+}
+
+float ambientOcclusion(vec3 p, vec3 n)
+{
+    float occ = 0.0;
+    float w = 1.0;
+    for (int i = 1; i <= 5; i++)
+    {
+        float h = 0.04 * float(i);
+        occ += (h - map(p + n * h)) * w;
+        w *= 0.8;
+    }
+    return clamp(1.0 - 3.0 * occ, 0.0, 1.0);
+}
+
+void mainImage( out vec4 fragColor, in vec2 fragCoord )
+{
+    vec2 uv = (2.*fragCoord - iResolution.xy) / iResolution.y;
+
+    float a = 0.2 * iTime;
+    vec3 ro = vec3(6.0 * cos(a), 2.5, 6.0 * sin(a));
+    vec3 ww = normalize(-ro);
+    vec3 uu = normalize(cross(ww, vec3(0.0, 1.0, 0.0)));
+    vec3 vv = cross(uu, ww);
+    vec3 rd = normalize(uv.x * uu + uv.y * vv + 1.8 * ww);
+
+    vec3 sky = vec3(0.6, 0.75, 0.9);
+    vec3 col = sky - 0.4 * rd.y;
+
+    float t = 0.0;
+    for (int i = 0; i < MARCH_STEPS; i++)
+    {
+        float h = map(ro + rd * t);
+        if (h < 1e-3 * t || t > 40.0)
+            break;
+        t += h;
+    }
+
+    if (t < 40.0)
+    {
+        vec3 p = ro + rd * t;
+        vec3 n = calcNormal(p);
+        vec3 l = normalize(vec3(0.6, 0.7, -0.4));
+
+        float dif = clamp(dot(n, l), 0.0, 1.0) * softShadow(p + n * 1e-3, l);
+        float occ = ambientOcclusion(p, n);
+
+        vec2 cell = floor(p.xz * 0.25 + 0.5);
+        vec3 albedo = p.y < -0.99 ? vec3(0.4 + 0.2 * mod(floor(p.x) + floor(p.z), 2.0))
+                                  : 0.5 + 0.5 * cos(vec3(0.0, 2.0, 4.0) + cell.x + 2.0 * cell.y);
+
+        col = albedo * (dif * vec3(1.3, 1.1, 0.9) + occ * vec3(0.2, 0.25, 0.35));
+        col = mix(col, sky, 1.0 - exp(-0.002 * t * t));
+    }
+
+    fragColor = vec4(pow(col, vec3(0.4545)), 1.0);
+}
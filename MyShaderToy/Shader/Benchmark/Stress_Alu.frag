@@ -0,0 +1,14 @@
+// Benchmark variant : ALU bound, a long dependent chain of transcendental and FMA work without any memory access
+
+void mainImage( out vec4 fragColor, in vec2 fragCoord )
+{
+    vec3 v = vec3(fragCoord / iResolution.y, fract(0.1 * iTime));
+
+    for (int i = 0; i < 256; i++)
+    {
+        v = sin(1.7 * v.zxy + vec3(1.3, 2.1, 0.7)) * cos(2.3 * v.yzx - 0.4) + 0.5 * exp2(-abs(v));
+        v = 0.9 * v + 0.1 * sqrt(abs(v.yzx));
+    }
+
+    fragColor = vec4(0.5 + 0.5 * v, 1.0);
+}
@@ -0,0 +1,29 @@
+// Benchmark variant : divergence, each pixel picks one of four paths and its loop count from a hash and exits the
+// loop on its own data, the invocations of a subgroup disagree on nearly every branch
+
+#include "../Include/Hash.glsl"
+
+void mainImage( out vec4 fragColor, in vec2 fragCoord )
+{
+    float h = hash12(fragCoord + floor(iTime));
+    int path = int(4.0 * h);
+    int count = 16 + int(240.0 * hash12(1.37 * fragCoord.yx));
+
+    vec3 v = vec3(fragCoord / iResolution.xy, h);
+    for (int i = 0; i < count; i++)
+    {
+        if (path == 0)
+            v = sin(3.1 * v + v.yzx);
+        else if (path == 1)
+            v = fract(7.3 * v * v.zxy + 0.13);
+        else if (path == 2)
+            v = abs(v) / (dot(v, v) + 1e-3) - 0.7;
+        else
+            v = cos(2.7 * v.yzx) * exp(-v);
+
+        if (dot(v, v) > 4.0 + h)
+            break;
+    }
+
+    fragColor = vec4(0.5 + 0.5 * sin(v + vec3(0.0, 2.0, 4.0)), 1.0);
+}
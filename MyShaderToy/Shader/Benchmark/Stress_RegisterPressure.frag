@@ -0,0 +1,28 @@
+// Benchmark variant : register pressure, 24 vec4 accumulators stay live across the whole loop and each one feeds
+// the next, which lowers the occupancy or spills on most GPUs
+
+void mainImage( out vec4 fragColor, in vec2 fragCoord )
+{
+    vec2 uv = fragCoord / iResolution.xy;
+
+    vec4 r[24];
+    for (int k = 0; k < 24; k++)
+        r[k] = vec4(uv, 0.1 * float(k), 1.0) * (1.0 + 0.05 * float(k));
+
+    for (int i = 0; i < 48; i++)
+    {
+        vec4 carry = r[23];
+        for (int k = 0; k < 24; k++)
+        {
+            vec4 next = 0.97 * r[k] + 0.03 * sin(carry + 0.01 * float(i) + iTime);
+            carry = r[k];
+            r[k] = next;
+        }
+    }
+
+    vec4 sum = vec4(0.0);
+    for (int k = 0; k < 24; k++)
+        sum += r[k] * (k % 2 == 0 ? 1.0 : -1.0);
+
+    fragColor = vec4(0.5 + 0.5 * sin(sum.xyz * 4.0), 1.0);
+}
@@ -0,0 +1,25 @@
+// Benchmark variant : texture bandwidth bound, 64 fetches per pixel at hashed coordinates spread over the whole
+// simulation state and 16 over Cube A, neighbouring pixels share almost no cache lines
+
+#include "../Include/Hash.glsl"
+
+void mainImage( out vec4 fragColor, in vec2 fragCoord )
+{
+    vec4 sum = vec4(0.0);
+    for (int i = 0; i < 64; i++)
+        sum += textureLod(iChannel1, hash22(fragCoord + vec2(17.31 * float(i), float(iFrame % 64u))), 0.0);
+
+    vec3 env = vec3(0.0);
+    for (int i = 0; i < 16; i++)
+    {
+        vec2 h = hash22(fragCoord.yx + vec2(float(i), 3.7));
+        float z = 2.0 * h.x - 1.0;
+        float a = 6.2831853 * h.y;
+        float r = sqrt(1.0 - z * z);
+        env += textureLod(iChannel0, vec3(r * cos(a), r * sin(a), z), 0.0).rgb;
+    }
+
+    vec3 col = mix(vec3(sum.y / 64.0, sum.x / 128.0, sum.y / 64.0), env / 16.0, 0.5);
+
+    fragColor = vec4(col, 1.0);
+}
@@ -0,0 +1,40 @@
+// Benchmark : texture heavy filtering, a 15x15 Gaussian of the simulation state and a 64 tap glossy reflection of Cube A
+
+void mainImage( out vec4 fragColor, in vec2 fragCoord )
+{
+    vec2 uv = fragCoord / iResolution.xy;
+    vec2 texel = 1.5 / vec2(textureSize(iChannel1, 0));
+
+    vec4 sum = vec4(0.0);
+    float total = 0.0;
+    for (int y = -7; y <= 7; y++)
+    {
+        for (int x = -7; x <= 7; x++)
+        {
+            float w = exp(-float(x * x + y * y) / 18.0);
+            sum += w * texture(iChannel1, uv + vec2(x, y) * texel);
+            total += w;
+        }
+    }
+    vec4 blurred = sum / total;
+
+    // Glossy reflection : golden angle spiral of directions around the mirror direction
+    vec2 p = (2.*fragCoord - iResolution.xy) / iResolution.y;
+    vec3 n = normalize(vec3(p, 1.2));
+    vec3 r = reflect(vec3(0.0, 0.0, -1.0), n);
+    vec3 t1 = normalize(cross(r, vec3(0.0, 1.0, 0.001)));
+    vec3 t2 = cross(r, t1);
+
+    vec3 env = vec3(0.0);
+    for (int i = 0; i < 64; i++)
+    {
+        float a = 2.39996 * float(i);
+        float radius = 0.15 * sqrt(float(i) / 64.0);
+        env += texture(iChannel0, normalize(r + radius * (cos(a) * t1 + sin(a) * t2))).rgb;
+    }
+    env /= 64.0;
+
+    vec3 col = mix(env, vec3(2.0 * blurred.y, 0.5 * blurred.x, blurred.y), 0.5);
+
+    fragColor = vec4(col, 1.0);
+}
@@ -0,0 +1,65 @@
+#version 450
+#extension GL_EXT_multiview : require
+
+layout(location = 0) out vec4 outColor;
+
+layout(push_constant) uniform PushConstants {
+    vec3 iResolution;
+    float padding0;
+    uvec4 iChannels;
+    vec2 iFragCoordOffset;
+    vec2 padding1;
+};
+
+layout(std140, set = 1, binding = 0) uniform ShaderInputs {
+    float iTime;
+    float iTimeDelta;
+    float iFrameRate;
+    uint iFrame;
+    vec4 iMouse;
+    vec4 iDate;
+    float iChannelTime[4];
+    vec3 iChannelResolution[4];
+    float iSampleRate;
+    vec4 iUserParams[8];
+};
+
+void mainCubemap( out vec4 fragColor, in vec2 fragCoord, in vec3 rayOri, in vec3 rayDir )
+{
+    vec3 sunDir = normalize(vec3(cos(iTime * 0.2), 0.4, sin(iTime * 0.2)));
+
+    // Sky gradient with a horizon band and a moving sun
+    float h = rayDir.y;
+    vec3 col = mix(vec3(0.35, 0.30, 0.25), vec3(0.80, 0.85, 0.90), smoothstep(-0.2, 0.05, h));
+    col = mix(col, vec3(0.20, 0.40, 0.80), smoothstep(0.05, 0.8, h));
+
+    float sun = max(dot(rayDir, sunDir), 0.0);
+    col += vec3(1.0, 0.8, 0.5) * (pow(sun, 512.0) * 8.0 + pow(sun, 16.0) * 0.3);
+
+    fragColor = vec4(col, 1.0);
+}
+
+// Face order of a Vulkan cube map : +X, -X, +Y, -Y, +Z, -Z
+vec3 cubeFaceDirection(uint face, vec2 uv)
+{
+    if (face == 0u) return vec3( 1.0, -uv.y, -uv.x);
+    if (face == 1u) return vec3(-1.0, -uv.y,  uv.x);
+    if (face == 2u) return vec3( uv.x,  1.0,  uv.y);
+    if (face == 3u) return vec3( uv.x, -1.0, -uv.y);
+    if (face == 4u) return vec3( uv.x, -uv.y,  1.0);
+    return vec3(-uv.x, -uv.y, -1.0);
+}
+
+void main() {
+    vec2 fragCoord = gl_FragCoord.xy;
+
+    vec2 uv = 2.0 * fragCoord / iResolution.xy - 1.0;
+
+    vec3 rayDir = normalize(cubeFaceDirection(uint(gl_ViewIndex), uv));
+
+    vec4 fragColor = vec4(0.);
+
+    mainCubemap(fragColor, fragCoord, vec3(0.), rayDir);
+
+    outColor = fragColor;
+}
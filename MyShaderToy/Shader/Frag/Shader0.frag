@@ -1,18 +1,3 @@
-#version 450
-
-layout(location = 0) out vec4 outColor;
-
-layout(push_constant) uniform PushConstants {
-    vec3 iResolution;
-    float iTime;
-    float iTimeDelta;
-    float iFrameRate;
-    uint iFrame;
-    float padding0;       // alignement pour vec4
-    vec4 iMouse;
-    vec4 iDate;
-};
-
 float inv_smoothstep( float x )
 {
   float a = pow(    x,1.0/3.0);
@@ -69,13 +54,3 @@ void mainImage( out vec4 fragColor, in vec2 fragCoord )
     // Output to screen
     fragColor = vec4(col,1.0);
 }
-
-void main() {
-    vec2 fragCoord = vec2(gl_FragCoord.x, iResolution.y-gl_FragCoord.y);
-
-    vec4 fragColor = vec4(0.);
-
-    mainImage(fragColor, fragCoord);
-
-    outColor = fragColor;
-}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#version 450
+
+// Fragment implementation of Shader/Compute/Sim0.comp, kept identical for benchmarking
+
+layout(location = 0) out vec4 outColor;
+
+layout(push_constant) uniform SimPushConstants {
+    vec3 iResolution;
+    float padding0;
+    uvec4 iChannels;
+    vec2 iFragCoordOffset;
+    vec2 padding1;
+    uvec2 iGridSize;
+    uint iStep;
+    uint padding2;
+};
+
+layout(std140, set = 1, binding = 0) uniform ShaderInputs {
+    float iTime;
+    float iTimeDelta;
+    float iFrameRate;
+    uint iFrame;
+    vec4 iMouse;
+    vec4 iDate;
+    float iChannelTime[4];
+    vec3 iChannelResolution[4];
+    float iSampleRate;
+    vec4 iUserParams[8];
+};
+
+layout(set = 0, binding = 0, rgba32f) uniform readonly image2D iPrevState;
+
+layout(set = 0, binding = 2, std430) buffer SimBuffer {
+    vec4 iSimData[];
+};
+
+const float Da = 1.0;
+const float Db = 0.5;
+const float feed = 0.055;
+const float kill = 0.062;
+
+float hash12(vec2 p)
+{
+    vec3 p3 = fract(vec3(p.xyx) * 0.1031);
+    p3 += dot(p3, p3.yzx + 33.33);
+    return fract((p3.x + p3.y) * p3.z);
+}
+
+vec2 fetch(ivec2 p)
+{
+    ivec2 size = ivec2(iGridSize);
+    return imageLoad(iPrevState, (p + size) % size).xy;
+}
+
+float sdSegment(vec2 p, vec2 a, vec2 b)
+{
+    vec2 pa = p - a, ba = b - a;
+    float h = clamp(dot(pa, ba) / max(dot(ba, ba), 1e-6), 0.0, 1.0);
+    return length(pa - ba * h);
+}
+
+vec4 initialState(ivec2 p)
+{
+    vec2 cell = floor(vec2(p) / 32.0);
+    vec2 center = (cell + 0.5) * 32.0;
+    float seeded = (hash12(cell) > 0.8 && length(vec2(p) - center) < 6.0) ? 1.0 : 0.0;
+    return vec4(1.0, seeded, 0.0, 1.0);
+}
+
+vec4 simulate(ivec2 p)
+{
+    vec2 c = fetch(p);
+
+    vec2 lap = -c;
+    lap += 0.2 * (fetch(p + ivec2(1, 0)) + fetch(p - ivec2(1, 0)) + fetch(p + ivec2(0, 1)) + fetch(p - ivec2(0, 1)));
+    lap += 0.05 * (fetch(p + ivec2(1, 1)) + fetch(p - ivec2(1, 1)) + fetch(p + ivec2(1, -1)) + fetch(p - ivec2(1, -1)));
+
+    float reaction = c.x * c.y * c.y;
+    float a = c.x + Da * lap.x - reaction + feed * (1.0 - c.x);
+    float b = c.y + Db * lap.y + reaction - (kill + feed) * c.y;
+
+    if (iStep == 0u && iMouse.z > 0.0)
+    {
+        vec2 scale = vec2(iGridSize) / iResolution.xy;
+        vec4 prevMouse = iSimData[iFrame & 1u];
+        vec2 current = iMouse.xy * scale;
+        vec2 previous = prevMouse.z > 0.0 ? prevMouse.xy : current;
+
+        if (sdSegment(vec2(p), previous, current) < 4.0)
+            b = 1.0;
+    }
+
+    return vec4(clamp(vec2(a, b), 0.0, 1.0), 0.0, 1.0);
+}
+
+void main()
+{
+    ivec2 p = ivec2(gl_FragCoord.xy);
+
+    if (iStep == 0u && p == ivec2(0))
+    {
+        vec2 scale = vec2(iGridSize) / iResolution.xy;
+        iSimData[(iFrame + 1u) & 1u] = vec4(iMouse.xy * scale, iMouse.z > 0.0 ? 1.0 : 0.0, 0.0);
+    }
+
+    outColor = (iFrame == 0u && iStep == 0u) ? initialState(p) : simulate(p);
+}
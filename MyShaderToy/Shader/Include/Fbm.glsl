@@ -0,0 +1,18 @@
+// 8 octaves of rotated value noise
+
+#include "ValueNoise.glsl"
+
+const mat2 octaveRotation = mat2(0.8, 0.6, -0.6, 0.8);
+
+float fbm(vec2 p)
+{
+    float v = 0.0;
+    float a = 0.5;
+    for (int i = 0; i < 8; i++)
+    {
+        v += a * valueNoise(p);
+        p = octaveRotation * p * 2.02;
+        a *= 0.5;
+    }
+    return v;
+}
@@ -0,0 +1,8 @@
+// #include "Missing.glsl"
+/* #include "Missing.glsl" */
+/*
+#include "Missing.glsl"
+*/
+    #include "Hash.glsl" // indented, with a trailing comment
+/* a block comment ending before */ #include "Noise.glsl"
+void main() {}
@@ -0,0 +1,2 @@
+#include "CycleB.glsl"
+float a() { return 1.0; }
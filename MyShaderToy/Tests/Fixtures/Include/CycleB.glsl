@@ -0,0 +1,2 @@
+#include "../Include/CycleA.glsl"
+float b() { return 2.0; }
@@ -0,0 +1,4 @@
+// Hash.glsl is reached directly and through Noise.glsl, through another relative path
+#include "../Include/Hash.glsl"
+#include "Noise.glsl"
+void main() {}
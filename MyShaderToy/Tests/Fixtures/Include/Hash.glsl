@@ -0,0 +1 @@
+float hash(float x) { return fract(sin(x) * 43758.5453); }
@@ -0,0 +1,2 @@
+#include "Hash.glsl"
+float noise(float x) { return mix(hash(floor(x)), hash(floor(x) + 1.0), fract(x)); }
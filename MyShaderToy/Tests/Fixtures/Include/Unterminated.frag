@@ -0,0 +1,3 @@
+#include <Hash.glsl>
+#include "Missing.glsl"
+void main() {}
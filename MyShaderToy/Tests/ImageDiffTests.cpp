@@ -0,0 +1,96 @@
+#include "Test.h"
+#include "ImageDiff.h"
+
+#include <vector>
+
+// 17x9 : 153 pixels, the last one goes through the scalar tail of the SSE2 loop
+static constexpr uint32_t WIDTH = 17;
+static constexpr uint32_t HEIGHT = 9;
+
+static std::vector<uint8_t> MakeGradient()
+{
+    std::vector<uint8_t> pixels(WIDTH * HEIGHT * 4);
+    for (uint32_t i = 0; i < WIDTH * HEIGHT; i++)
+    {
+        pixels[i * 4 + 0] = static_cast<uint8_t>(i);
+        pixels[i * 4 + 1] = static_cast<uint8_t>(255 - i);
+        pixels[i * 4 + 2] = static_cast<uint8_t>(i * 7);
+        pixels[i * 4 + 3] = 255;
+    }
+    return pixels;
+}
+
+TEST(DiffImages_IdenticalImages)
+{
+    std::vector<uint8_t> a = MakeGradient();
+
+    ImageDiffResult result = DiffImages(a.data(), a.data(), WIDTH, HEIGHT, 0);
+
+    CHECK(result.DifferentPixels == 0);
+    CHECK(result.MaxDifference == 0);
+    CHECK(result.MeanDifference == 0.);
+    CHECK(result.Ssim > 0.9999);
+    CHECK(result.Passed(ImageDiffTolerance(), WIDTH * HEIGHT));
+}
+
+TEST(DiffImages_CountsPixelsAboveThreshold)
+{
+    std::vector<uint8_t> a = MakeGradient();
+    std::vector<uint8_t> b = a;
+
+    // Above the threshold in the SSE2 loop and in the tail, then one at the threshold
+    b[5 * 4 + 1] -= 10;
+    b[152 * 4 + 2] -= 40;
+    b[60 * 4 + 0] ^= 2;
+
+    std::vector<uint8_t> heatMap(a.size());
+    ImageDiffResult result = DiffImages(a.data(), b.data(), WIDTH, HEIGHT, 2, heatMap.data());
+
+    CHECK(result.DifferentPixels == 2);
+    CHECK(result.MaxDifference == 40);
+    CHECK(result.MeanDifference > 0.);
+
+    // Red for the differing pixels, grey elsewhere, opaque everywhere
+    CHECK(heatMap[5 * 4 + 0] == 255 && heatMap[5 * 4 + 2] == 0);
+    CHECK(heatMap[152 * 4 + 0] == 255 && heatMap[152 * 4 + 2] == 0);
+    CHECK(heatMap[60 * 4 + 0] == heatMap[60 * 4 + 1] && heatMap[60 * 4 + 1] == heatMap[60 * 4 + 2]);
+    CHECK(heatMap[100 * 4 + 3] == 255);
+}
+
+TEST(DiffImages_Tolerance)
+{
+    std::vector<uint8_t> a(WIDTH * HEIGHT * 4, 128);
+    std::vector<uint8_t> b = a;
+    b[0] = 200;
+
+    ImageDiffResult result = DiffImages(a.data(), b.data(), WIDTH, HEIGHT, 2);
+
+    ImageDiffTolerance strict;
+    strict.MaxDifferentPixels = 0.f;
+    strict.MinSsim = 0.f;
+    CHECK(!result.Passed(strict, WIDTH * HEIGHT));
+
+    ImageDiffTolerance loose;
+    loose.MaxDifferentPixels = 0.01f;
+    loose.MinSsim = 0.f;
+    CHECK(result.Passed(loose, WIDTH * HEIGHT));
+
+    // One block of very different structure drops the SSIM
+    for (uint32_t y = 0; y < 8; y++)
+        for (uint32_t x = 0; x < 8; x++)
+            for (uint32_t c = 0; c < 3; c++)
+                b[(y * WIDTH + x) * 4 + c] = (x + y) % 2 ? 0 : 255;
+    result = DiffImages(a.data(), b.data(), WIDTH, HEIGHT, 2);
+    CHECK(result.Ssim < 0.98);
+}
+
+TEST(HashImage_ExactMatch)
+{
+    std::vector<uint8_t> a = MakeGradient();
+    std::vector<uint8_t> b = a;
+
+    CHECK(HashImage(a.data(), a.size()) == HashImage(b.data(), b.size()));
+
+    b[77] ^= 1;
+    CHECK(HashImage(a.data(), a.size()) != HashImage(b.data(), b.size()));
+}
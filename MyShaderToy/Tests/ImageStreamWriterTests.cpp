@@ -0,0 +1,24 @@
+#include "Test.h"
+#include "ImageStreamWriter.h"
+
+TEST(CountFrameConversions_Patterns)
+{
+    CHECK(CountFrameConversions("frame_%05d.png") == 1);
+    CHECK(CountFrameConversions("frame_%d.png") == 1);
+    CHECK(CountFrameConversions("frame_%5d.png") == 1);
+    CHECK(CountFrameConversions("poster.png") == 0);
+    CHECK(CountFrameConversions("100%%_%04d.png") == 1);
+    CHECK(CountFrameConversions("%d_%d.png") == 2);
+}
+
+// Anything printf would read an argument for, or a dangling %, can't be used as the format
+TEST(CountFrameConversions_RejectsOtherConversions)
+{
+    CHECK(CountFrameConversions("frame_%s.png") == -1);
+    CHECK(CountFrameConversions("frame_%x.png") == -1);
+    CHECK(CountFrameConversions("frame_%-5d.png") == -1);
+    CHECK(CountFrameConversions("frame_%ld.png") == -1);
+    CHECK(CountFrameConversions("frame_%n") == -1);
+    CHECK(CountFrameConversions("frame_%") == -1);
+    CHECK(CountFrameConversions("frame_%05") == -1);
+}
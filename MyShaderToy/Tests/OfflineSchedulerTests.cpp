@@ -0,0 +1,172 @@
+#include "Test.h"
+#include "OfflineScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+
+TEST(OfflineJobQueue_OwnDequeThenSteal)
+{
+    OfflineJobQueue queue(6, 2);
+    uint32_t job = 0;
+    bool stolen = true;
+
+    // Device 0 holds 0, 2, 4 and takes them front first
+    CHECK(queue.Pop(0, job, stolen) && job == 0 && !stolen);
+    CHECK(queue.Pop(0, job, stolen) && job == 2 && !stolen);
+    CHECK(queue.Pop(0, job, stolen) && job == 4 && !stolen);
+
+    // Then steals the back of device 1
+    CHECK(queue.Pop(0, job, stolen) && job == 5 && stolen);
+    CHECK(queue.Pop(1, job, stolen) && job == 1 && !stolen);
+    CHECK(queue.Pop(1, job, stolen) && job == 3 && !stolen);
+    CHECK(!queue.Pop(0, job, stolen));
+    CHECK(!queue.Pop(1, job, stolen));
+}
+
+TEST(OfflineJobQueue_WindowStealsTheEarliestJob)
+{
+    OfflineJobQueue queue(8, 2, 2);
+    uint32_t job = 0;
+    bool stolen = false;
+
+    CHECK(queue.Pop(0, job, stolen) && job == 0);
+    CHECK(queue.Pop(1, job, stolen) && job == 1);
+
+    // 2 is in the window, 3 isn't : device 1 takes the front of device 0 instead of its own 3
+    queue.SetWriteHead(1);
+    CHECK(queue.Pop(1, job, stolen) && job == 2 && stolen);
+}
+
+TEST(OfflineJobQueue_DrainThenWaitForTheWriteHead)
+{
+    OfflineJobQueue queue(4, 1, 1);
+    uint32_t job = 0;
+    bool stolen = false;
+
+    CHECK(queue.Pop(0, job, stolen) && job == 0);
+
+    // Job 1 is past the window until the output of job 0 is written by the drain
+    uint32_t drainCount = 0;
+    CHECK(queue.Pop(0, job, stolen, [&]() { drainCount++; queue.SetWriteHead(1); }) && job == 1);
+    CHECK(drainCount == 1);
+}
+
+TEST(OfflineJobQueue_AbortWakesTheWaitingDevices)
+{
+    OfflineJobQueue queue(4, 2, 1);
+    uint32_t job = 0;
+    bool stolen = false;
+    CHECK(queue.Pop(0, job, stolen) && job == 0);
+
+    bool popped = true;
+    std::thread waiting([&]()
+    {
+        uint32_t waitingJob = 0;
+        bool waitingStolen = false;
+        popped = queue.Pop(1, waitingJob, waitingStolen);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.Abort();
+    waiting.join();
+
+    CHECK(!popped);
+    CHECK(!queue.Pop(0, job, stolen));
+}
+
+TEST(OrderedOutput_WritesInIndexOrder)
+{
+    std::vector<uint32_t> written;
+    std::vector<uint32_t> values;
+    OrderedOutput output(10, [&](uint32_t index, const void* data)
+    {
+        written.push_back(index);
+        values.push_back(*static_cast<const uint32_t*>(data));
+        return true;
+    });
+
+    for (uint32_t index : { 12u, 11u, 10u, 13u })
+    {
+        // Early outputs are copied : the caller buffer is reused right away
+        uint32_t value = index * 100;
+        output.Push(index, &value, sizeof(value));
+        value = 0;
+    }
+
+    CHECK((written == std::vector<uint32_t>{ 10, 11, 12, 13 }));
+    CHECK((values == std::vector<uint32_t>{ 1000, 1100, 1200, 1300 }));
+    CHECK(output.GetMaxPending() == 2);
+    CHECK(output.Succeeded());
+}
+
+TEST(OrderedOutput_KeepsTheFirstFailure)
+{
+    OrderedOutput output(0, [](uint32_t index, const void*) { return index != 1; });
+
+    uint32_t value = 0;
+    for (uint32_t index = 0; index < 3; index++)
+        output.Push(index, &value, sizeof(value));
+
+    CHECK(!output.Succeeded());
+}
+
+// Devices of uneven speed hand their outputs to one writer : every output is written once, in order,
+// and no more than the window waits for an earlier one
+TEST(OfflineJobQueue_BoundedReorderUnderLoad)
+{
+    const uint32_t jobCount = 60;
+    const uint32_t deviceCount = 3;
+    const uint32_t window = deviceCount * 2;
+
+    for (uint32_t run = 0; run < 20; run++)
+    {
+        OfflineJobQueue queue(jobCount, deviceCount, window);
+
+        std::vector<uint32_t> written;
+        OrderedOutput output(0, [&](uint32_t index, const void*)
+        {
+            written.push_back(index);
+            queue.SetWriteHead(index + 1);
+            return true;
+        });
+
+        std::vector<std::thread> devices;
+        for (uint32_t device = 0; device < deviceCount; device++)
+        {
+            devices.emplace_back([&, device]()
+            {
+                std::mt19937 random(device + run * deviceCount);
+                std::vector<uint32_t> held;
+                auto drain = [&]()
+                {
+                    for (uint32_t job : held)
+                        output.Push(job, &job, sizeof(job));
+                    held.clear();
+                };
+
+                uint32_t job = 0;
+                bool stolen = false;
+                while (queue.Pop(device, job, stolen, drain))
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(random() % (device == 0 ? 2000 : 200)));
+                    held.push_back(job);
+                    if (random() % 2)
+                        drain();
+                }
+                drain();
+            });
+        }
+
+        for (std::thread& device : devices)
+            device.join();
+
+        bool ordered = written.size() == jobCount;
+        for (uint32_t i = 0; ordered && i < jobCount; i++)
+            ordered = written[i] == i;
+
+        CHECK(ordered);
+        CHECK(output.GetMaxPending() <= window);
+    }
+}
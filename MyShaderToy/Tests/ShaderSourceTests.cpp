@@ -0,0 +1,95 @@
+#include "Test.h"
+#include "ShaderSource.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+static size_t CountOccurrences(const std::string& text, const std::string& pattern)
+{
+    size_t count = 0;
+    for (size_t i = text.find(pattern); i != std::string::npos; i = text.find(pattern, i + 1))
+        count++;
+    return count;
+}
+
+static bool HasDependency(const std::vector<std::string>& dependencies, const std::filesystem::path& path)
+{
+    return std::find(dependencies.begin(), dependencies.end(), NormalizeShaderPath(path)) != dependencies.end();
+}
+
+TEST(ExpandIncludes_DiamondIsExpandedOnce)
+{
+    ShaderCompiler compiler;
+    std::string source, errors;
+    std::vector<std::string> dependencies;
+
+    CHECK(compiler.ExpandIncludes(FIXTURE_PATH("Include/Diamond.frag"), source, dependencies, errors));
+    CHECK(errors.empty());
+
+    CHECK(CountOccurrences(source, "float hash(") == 1);
+    CHECK(CountOccurrences(source, "float noise(") == 1);
+    CHECK(source.find("#include") == std::string::npos);
+
+    // The shader first, every file once
+    CHECK(dependencies.size() == 3);
+    CHECK(!dependencies.empty() && dependencies[0] == NormalizeShaderPath(FIXTURE_PATH("Include/Diamond.frag")));
+    CHECK(HasDependency(dependencies, FIXTURE_PATH("Include/Hash.glsl")));
+    CHECK(HasDependency(dependencies, FIXTURE_PATH("Include/Noise.glsl")));
+
+    // The lines after an include are named after the including file again
+    CHECK(source.find("#line 1 \"Hash.glsl\"") != std::string::npos);
+    CHECK(source.find("#line 3 \"Diamond.frag\"") != std::string::npos);
+}
+
+TEST(ExpandIncludes_CycleStops)
+{
+    ShaderCompiler compiler;
+    std::string source, errors;
+    std::vector<std::string> dependencies;
+
+    CHECK(compiler.ExpandIncludes(FIXTURE_PATH("Include/CycleA.glsl"), source, dependencies, errors));
+    CHECK(CountOccurrences(source, "float a(") == 1);
+    CHECK(CountOccurrences(source, "float b(") == 1);
+    CHECK(dependencies.size() == 2);
+}
+
+TEST(ExpandIncludes_SkipsCommentedIncludes)
+{
+    ShaderCompiler compiler;
+    std::string source, errors;
+    std::vector<std::string> dependencies;
+
+    CHECK(compiler.ExpandIncludes(FIXTURE_PATH("Include/Commented.frag"), source, dependencies, errors));
+    CHECK(errors.empty());
+    CHECK(!HasDependency(dependencies, FIXTURE_PATH("Include/Missing.glsl")));
+
+    // Indented, with a trailing comment, after a closed block comment
+    CHECK(CountOccurrences(source, "float hash(") == 1);
+    CHECK(CountOccurrences(source, "float noise(") == 1);
+    CHECK(CountOccurrences(source, "#include \"Missing.glsl\"") == 3);
+}
+
+TEST(ExpandIncludes_ReportsErrors)
+{
+    ShaderCompiler compiler;
+    std::string source, errors;
+    std::vector<std::string> dependencies;
+
+    CHECK(!compiler.ExpandIncludes(FIXTURE_PATH("Include/Unterminated.frag"), source, dependencies, errors));
+    CHECK(errors.find("Unterminated.frag:1: error") != std::string::npos);
+    CHECK(errors.find("Missing.glsl") != std::string::npos);
+}
+
+TEST(ShaderCompiler_HasChanged)
+{
+    ShaderCompiler compiler;
+    std::string source, errors;
+    std::vector<std::string> dependencies;
+
+    const std::string path = FIXTURE_PATH("Include/Noise.glsl").string();
+    CHECK(compiler.HasChanged(path));
+    CHECK(compiler.ExpandIncludes(path, source, dependencies, errors));
+    CHECK(!compiler.HasChanged(path));
+    CHECK(!compiler.HasChanged(FIXTURE_PATH("Include/Hash.glsl").string()));
+}
@@ -0,0 +1,83 @@
+#include "Test.h"
+#include "ShaderSource.h"
+
+#include <bit>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static std::string ToSpirv(const std::vector<uint32_t>& words)
+{
+    std::string spirv(words.size() * sizeof(uint32_t), '\0');
+    memcpy(spirv.data(), words.data(), spirv.size());
+    return spirv;
+}
+
+static uint32_t Instruction(uint32_t opcode, uint32_t length)
+{
+    return length << 16 | opcode;
+}
+
+// Header, names and decorations, types, then the constants : %5 int Steps = 8 (id 3),
+// %6 bool = true (id 1, no name), %7 float = 0.5 (id 2)
+static std::vector<uint32_t> MakeModule()
+{
+    uint32_t steps[2] = {};
+    memcpy(steps, "Steps", 6);
+
+    return {
+        0x07230203u, 0x00010000u, 0u, 8u, 0u,
+        Instruction(5, 4), 5, steps[0], steps[1],     // OpName
+        Instruction(71, 4), 5, 1, 3,                  // OpDecorate SpecId
+        Instruction(71, 4), 6, 1, 1,
+        Instruction(71, 4), 7, 1, 2,
+        Instruction(21, 4), 2, 32, 1,                 // OpTypeInt 32 signed
+        Instruction(22, 3), 3, 32,                    // OpTypeFloat 32
+        Instruction(20, 2), 4,                        // OpTypeBool
+        Instruction(50, 4), 2, 5, 8,                  // OpSpecConstant
+        Instruction(48, 3), 4, 6,                     // OpSpecConstantTrue
+        Instruction(50, 4), 3, 7, std::bit_cast<uint32_t>(0.5f),
+    };
+}
+
+TEST(ReflectSpecConstants_TypesDefaultsAndNames)
+{
+    std::vector<SpecConstant> constants = ReflectSpecConstants(ToSpirv(MakeModule()));
+
+    CHECK(constants.size() == 3);
+    if (constants.size() != 3)
+        return;
+
+    // Sorted by Id
+    CHECK(constants[0].Id == 1 && constants[0].Type == SpecConstantType::Bool && constants[0].Default == 1);
+    CHECK(constants[0].Name == "constant_id 1");
+
+    CHECK(constants[1].Id == 2 && constants[1].Type == SpecConstantType::Float);
+    CHECK(std::bit_cast<float>(constants[1].Default) == 0.5f);
+
+    CHECK(constants[2].Id == 3 && constants[2].Type == SpecConstantType::Int && constants[2].Default == 8);
+    CHECK(constants[2].Name == "Steps");
+
+    for (const SpecConstant& constant : constants)
+        CHECK(constant.Value == constant.Default);
+}
+
+TEST(ReflectSpecConstants_InvalidModules)
+{
+    std::vector<uint32_t> words = MakeModule();
+
+    // Not SPIR-V
+    std::vector<uint32_t> wrongMagic = words;
+    wrongMagic[0] = 0;
+    CHECK(ReflectSpecConstants(ToSpirv(wrongMagic)).empty());
+    CHECK(ReflectSpecConstants(std::string()).empty());
+
+    // Cut in the last instruction : the complete ones are still read
+    words.pop_back();
+    std::vector<SpecConstant> constants = ReflectSpecConstants(ToSpirv(words));
+    CHECK(constants.size() == 2);
+
+    // A zero length instruction ends the scan
+    words[5] = 0;
+    CHECK(ReflectSpecConstants(ToSpirv(words)).empty());
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+// Minimal test runner : TEST registers a function, a failed CHECK is reported and the test goes on
+struct TestCase
+{
+    const char* Name;
+    void (*Function)();
+};
+
+std::vector<TestCase>& GetTestCases();
+
+void ReportCheckFailure(const char* file, int line, const char* expression);
+
+struct TestRegistrar
+{
+    TestRegistrar(const char* name, void (*function)()) { GetTestCases().push_back({ name, function }); }
+};
+
+#define TEST(name) \
+    static void name(); \
+    static TestRegistrar name##Registrar(#name, name); \
+    static void name()
+
+#define CHECK(expression) ((expression) ? void() : ReportCheckFailure(__FILE__, __LINE__, #expression))
+
+// Tests/Fixtures/<name>, found from the test source so that the runner works from any directory
+#define FIXTURE_PATH(name) (std::filesystem::path(__FILE__).parent_path() / "Fixtures" / (name))
@@ -0,0 +1,47 @@
+#include "Test.h"
+
+#include <exception>
+#include <iostream>
+
+static int s_FailedChecks = 0;
+
+std::vector<TestCase>& GetTestCases()
+{
+    static std::vector<TestCase> testCases;
+    return testCases;
+}
+
+void ReportCheckFailure(const char* file, int line, const char* expression)
+{
+    std::cerr << file << "(" << line << ") : CHECK(" << expression << ") failed" << std::endl;
+    s_FailedChecks++;
+}
+
+// Exits with the number of failed tests, the post-build step fails the build on any
+int main()
+{
+    int failedTests = 0;
+
+    for (const TestCase& testCase : GetTestCases())
+    {
+        const int failedChecks = s_FailedChecks;
+
+        try
+        {
+            testCase.Function();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << testCase.Name << " : exception " << e.what() << std::endl;
+            s_FailedChecks++;
+        }
+
+        const bool passed = s_FailedChecks == failedChecks;
+        std::cout << (passed ? "[  OK  ] " : "[ FAIL ] ") << testCase.Name << std::endl;
+        failedTests += passed ? 0 : 1;
+    }
+
+    std::cout << GetTestCases().size() - failedTests << " / " << GetTestCases().size() << " tests passed" << std::endl;
+
+    return failedTests;
+}
@@ -0,0 +1,96 @@
+#include "Test.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+TEST(ThreadPool_ReturnsResultsAndExceptions)
+{
+    ThreadPool pool(4);
+    CHECK(pool.GetThreadCount() == 4);
+
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 100; i++)
+        results.push_back(pool.Submit([i]() { return i * i; }));
+
+    bool correct = true;
+    for (int i = 0; i < 100; i++)
+        correct &= results[i].get() == i * i;
+    CHECK(correct);
+
+    std::future<int> failure = pool.Submit([]() -> int { throw std::runtime_error("task"); });
+    bool thrown = false;
+    try
+    {
+        failure.get();
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+// One worker, held busy while the tasks are queued : they run in submission order
+TEST(ThreadPool_ExternalSubmissionsAreFifo)
+{
+    std::vector<int> order;
+    std::mutex mutex;
+    {
+        ThreadPool pool(1);
+
+        std::promise<void> gate;
+        std::shared_future<void> opened = gate.get_future().share();
+        pool.Submit([opened]() { opened.wait(); });
+
+        for (int i = 0; i < 8; i++)
+            pool.Submit([i, &order, &mutex]() { std::lock_guard<std::mutex> lock(mutex); order.push_back(i); });
+
+        gate.set_value();
+    }
+
+    CHECK((order == std::vector<int>{ 0, 1, 2, 3, 4, 5, 6, 7 }));
+}
+
+// A worker runs the tasks it submits newest first, before the older external ones
+TEST(ThreadPool_SpawnedTasksAreLifo)
+{
+    std::vector<int> order;
+    std::mutex mutex;
+    {
+        ThreadPool pool(1);
+
+        std::promise<void> gate;
+        std::shared_future<void> opened = gate.get_future().share();
+        pool.Submit([&, opened]()
+        {
+            opened.wait();
+            for (int i = 0; i < 3; i++)
+                pool.Submit([i, &order, &mutex]() { std::lock_guard<std::mutex> lock(mutex); order.push_back(i); });
+        });
+        pool.Submit([&]() { std::lock_guard<std::mutex> lock(mutex); order.push_back(100); });
+
+        gate.set_value();
+    }
+
+    CHECK((order == std::vector<int>{ 2, 1, 0, 100 }));
+}
+
+// The destructor runs the queued tasks : no future is left broken
+TEST(ThreadPool_DestructorRunsQueuedTasks)
+{
+    std::vector<std::future<int>> results;
+    {
+        ThreadPool pool(2);
+        for (int i = 0; i < 50; i++)
+            results.push_back(pool.Submit([i]() { return i; }));
+    }
+
+    bool ready = true;
+    for (std::future<int>& result : results)
+        ready &= result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    CHECK(ready);
+}
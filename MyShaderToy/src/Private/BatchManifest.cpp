@@ -0,0 +1,155 @@
+#include "BatchManifest.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+// Output file name of an entry : its path without extension, '_' between the directories, a counter makes it unique
+static std::string MakeEntryName(std::filesystem::path path, std::set<std::string>& usedNames)
+{
+    path = path.lexically_normal().relative_path().replace_extension();
+
+    std::string name;
+    for (const std::filesystem::path& part : path)
+        name += (name.empty() ? "" : "_") + part.string();
+
+    std::string unique = name;
+    for (uint32_t i = 2; !usedNames.insert(unique).second; i++)
+        unique = name + "_" + std::to_string(i);
+
+    return unique;
+}
+
+bool ListBatchShaders(const std::string& manifest, const std::string& directory, const std::vector<float>& timestamps, std::vector<BatchShaderEntry>& entries)
+{
+    std::error_code error;
+    std::set<std::string> usedNames;
+
+    if (!manifest.empty())
+    {
+        std::ifstream file(manifest);
+        if (!file)
+        {
+            debug_log("Batch : can't open " << manifest << " !");
+            return false;
+        }
+
+        const std::filesystem::path root = std::filesystem::path(manifest).parent_path();
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::istringstream fields(line.substr(0, line.find('#')));
+            std::string path, times, hashes;
+            if (!(fields >> path))
+                continue;
+
+            BatchShaderEntry shader;
+            shader.Path = (root / path).string();
+            shader.Name = MakeEntryName(path, usedNames);
+            shader.Timestamps = timestamps;
+
+            if (fields >> times)
+            {
+                shader.Timestamps.clear();
+
+                std::istringstream list(times);
+                std::string time;
+                while (std::getline(list, time, ','))
+                    shader.Timestamps.push_back(static_cast<float>(atof(time.c_str())));
+            }
+
+            if (fields >> hashes)
+            {
+                std::istringstream list(hashes);
+                std::string hash;
+                while (std::getline(list, hash, ','))
+                    shader.Hashes.push_back(strtoull(hash.c_str(), nullptr, 16));
+            }
+
+            if (!shader.Timestamps.empty())
+                entries.push_back(std::move(shader));
+        }
+    }
+    else
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".frag")
+            {
+                BatchShaderEntry shader;
+                shader.Path = entry.path().string();
+                shader.Name = MakeEntryName(entry.path().filename(), usedNames);
+                shader.Timestamps = timestamps;
+                entries.push_back(std::move(shader));
+            }
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const BatchShaderEntry& a, const BatchShaderEntry& b) { return a.Path < b.Path; });
+    }
+
+    if (entries.empty() || timestamps.empty())
+    {
+        debug_log("Batch : no shader in " << (manifest.empty() ? directory : manifest) << " !");
+        return false;
+    }
+
+    return true;
+}
+
+bool RecordBatchHashes(const std::string& manifest, const std::vector<BatchShaderEntry>& entries)
+{
+    std::ifstream file(manifest);
+    if (!file)
+        return false;
+
+    const std::filesystem::path root = std::filesystem::path(manifest).parent_path();
+
+    std::vector<std::string> lines;
+    size_t next = 0;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        const size_t comment = line.find('#');
+        std::istringstream fields(line.substr(0, comment));
+        std::string path;
+        if (!(fields >> path))
+        {
+            lines.push_back(line);
+            continue;
+        }
+
+        // Same order as ListBatchShaders, a manifest edited since the run is left untouched
+        if (next >= entries.size() || entries[next].Path != (root / path).string())
+            return false;
+
+        const BatchShaderEntry& shader = entries[next++];
+
+        std::string times, hashes;
+        for (size_t t = 0; t < shader.Timestamps.size(); t++)
+        {
+            const uint64_t hash = t < shader.Hashes.size() ? shader.Hashes[t] : 0;
+            times += std::format("{}{:g}", t ? "," : "", shader.Timestamps[t]);
+            hashes += std::string(t ? "," : "") + (hash ? std::format("{:016x}", hash) : std::string("-"));
+        }
+
+        if (comment != std::string::npos)
+            lines.push_back(std::format("{:<30} {:<7} {:<7} {}", path, times, hashes, line.substr(comment)));
+        else
+            lines.push_back(std::format("{:<30} {:<7} {}", path, times, hashes));
+    }
+
+    file.close();
+
+    std::ofstream output(manifest, std::ios::trunc);
+    for (const std::string& recorded : lines)
+        output << recorded << '\n';
+
+    return output.good();
+}
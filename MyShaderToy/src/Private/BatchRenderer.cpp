@@ -0,0 +1,451 @@
+﻿#include "VulkanCore.h"
+
+#include <filesystem>
+#include <format>
+
+#include <stb_image_write.h>
+
+VkPipeline VulkanCore::CreateBatchPipeline(const std::string& shaderPath, uint32_t recipe)
+{
+    std::vector<std::string> dependencies;
+    VkShaderModule fragmentShaderModule = CompileShaderModule(shaderPath, "frag", recipe, dependencies);
+    if (fragmentShaderModule == VK_NULL_HANDLE)
+        return VK_NULL_HANDLE;
+
+    VkPipeline pipeline = CreateFullscreenPipeline(m_BuiltinModules[BUILTIN_SHADER_FULLSCREEN_VERTEX], fragmentShaderModule, m_GraphicPipelineLayout, RT_IMAGE_FORMAT, 0);
+
+    m_Disp.destroyShaderModule(fragmentShaderModule, nullptr);
+
+    return pipeline;
+}
+
+bool VulkanCore::RenderBatch(const OfflineRenderSettings& settings)
+{
+    const BatchRenderSettings& batch = settings.Batch;
+
+    enum class BatchStatus { Pending, Rendered, Failed, TimedOut };
+
+    struct BatchShader
+    {
+        std::string Path;
+        std::string Name;
+        std::vector<float> Timestamps;
+        std::vector<uint64_t> ExpectedHashes;
+        std::future<VkPipeline> Pipeline;
+        VkPipeline Handle = VK_NULL_HANDLE;
+        BatchStatus Status = BatchStatus::Pending;
+        uint32_t NextTimestamp = 0;
+        uint32_t UnitsInFlight = 0;
+        std::vector<uint8_t> Pixels;    // one RGBA8 thumbnail per timestamp
+        std::vector<uint64_t> Hashes;
+        std::future<bool> Written;
+        // Golden comparisons, filled by the write task
+        uint32_t FailedComparisons = 0;
+        std::vector<std::string> Report;
+    };
+
+    const bool golden = !batch.ReferenceDirectory.empty();
+
+    std::vector<BatchShaderEntry> entries;
+    if (!ListBatchShaders(batch.Manifest, batch.Directory, batch.Timestamps, entries))
+        return false;
+
+    std::vector<BatchShader> shaders(entries.size());
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        shaders[i].Path = entries[i].Path;
+        shaders[i].Name = entries[i].Name;
+        shaders[i].Timestamps = entries[i].Timestamps;
+        shaders[i].ExpectedHashes = entries[i].Hashes;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(batch.OutputDirectory, error);
+
+    CreateColorConvertPipeline();
+
+    if (m_ConvertPipeline == VK_NULL_HANDLE)
+        return false;
+
+    SetupOfflineInputs(settings);
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Every shader is queued for compilation upfront, the GPU starts as soon as the first pipelines are ready
+    ThreadPool pool(batch.ThreadCount);
+    for (uint32_t i = 0; i < shaders.size(); i++)
+        shaders[i].Pipeline = pool.Submit([this, i, &shaders]() { return CreateBatchPipeline(shaders[i].Path, m_SpirvRecipe); });
+
+    uint32_t maxTimestampCount = 0;
+    for (const BatchShader& shader : shaders)
+        maxTimestampCount = std::max(maxTimestampCount, static_cast<uint32_t>(shader.Timestamps.size()));
+
+    const size_t thumbnailSize = static_cast<size_t>(settings.Width) * settings.Height * 4;
+    const auto timeout = std::chrono::duration<float>(batch.TimeoutSeconds);
+
+    // One thumbnail (shader, timestamp) per frame in flight, up to MAX_FRAMES_IN_FLIGHT shaders are rendered at once
+    std::array<BufferData, MAX_FRAMES_IN_FLIGHT> readbackBuffers;
+    std::array<uint8_t*, MAX_FRAMES_IN_FLIGHT> readbackData = {};
+    std::array<int64_t, MAX_FRAMES_IN_FLIGHT> pendingShaders;
+    std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> pendingTimestamps = {};
+    pendingShaders.fill(-1);
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        readbackData[i] = static_cast<uint8_t*>(CreateReadbackBuffer(thumbnailSize, readbackBuffers[i], VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
+        WriteColorConvertDescriptors(i, m_RTImages[i], readbackBuffers[i]);
+    }
+
+    std::vector<uint32_t> activeShaders;
+    uint32_t nextShader = 0;
+    uint32_t finishedCount = 0;
+    size_t roundRobin = 0;
+
+    auto finishShader = [&](uint32_t index)
+    {
+        BatchShader& shader = shaders[index];
+
+        if (shader.Handle != VK_NULL_HANDLE)
+        {
+            m_Disp.destroyPipeline(shader.Handle, nullptr);
+            shader.Handle = VK_NULL_HANDLE;
+        }
+
+        if (shader.Status == BatchStatus::Pending)
+        {
+            shader.Status = BatchStatus::Rendered;
+
+            // PNG encoding and golden comparisons stay off the render thread
+            shader.Written = pool.Submit([&shader, &batch, &settings, thumbnailSize, golden]()
+            {
+                const int width = static_cast<int>(settings.Width);
+                const int height = static_cast<int>(settings.Height);
+
+                bool written = true;
+                shader.Hashes.resize(shader.Timestamps.size());
+                for (uint32_t t = 0; t < shader.Timestamps.size(); t++)
+                {
+                    const uint8_t* pixels = shader.Pixels.data() + t * thumbnailSize;
+                    const std::string name = shader.Name + "_" + std::to_string(t);
+
+                    shader.Hashes[t] = HashImage(pixels, thumbnailSize);
+
+                    if (golden)
+                    {
+                        // An exact match of the manifest hash needs no reference
+                        if (t < shader.ExpectedHashes.size() && shader.ExpectedHashes[t] == shader.Hashes[t])
+                            continue;
+
+                        GoldenComparison comparison = CompareGolden(pixels, settings.Width, settings.Height, batch.ReferenceDirectory + "/" + name + ".png", batch.Tolerance,
+                            batch.OutputDirectory + "/" + name + "_diff.png");
+
+                        // Passing thumbnails aren't written, a failure keeps the render and its heat map,
+                        // a missing reference keeps the render so that it can be reviewed and copied as the reference
+                        if (comparison.Status == GoldenStatus::Passed)
+                            continue;
+
+                        shader.Report.push_back(name + " : " + comparison.Report);
+                        shader.FailedComparisons++;
+                        written &= comparison.Written;
+                    }
+
+                    std::string path = batch.OutputDirectory + "/" + name + ".png";
+                    written &= stbi_write_png(path.c_str(), width, height, 4, pixels, width * 4) != 0;
+                }
+                return written;
+            });
+        }
+        else
+        {
+            debug_log("Batch : " << shader.Path << (shader.Status == BatchStatus::TimedOut ? " timed out" : " failed to compile"));
+        }
+
+        activeShaders.erase(std::find(activeShaders.begin(), activeShaders.end(), index));
+        finishedCount++;
+    };
+
+    // The slot fence was waited on : copy the thumbnail and charge its GPU time to its shader
+    auto flushSlot = [&](uint32_t slot)
+    {
+        if (pendingShaders[slot] < 0)
+            return;
+
+        uint32_t index = static_cast<uint32_t>(pendingShaders[slot]);
+        BatchShader& shader = shaders[index];
+        pendingShaders[slot] = -1;
+        shader.UnitsInFlight--;
+
+        std::array<uint64_t, 2> timestamps{};
+        if (m_GraphicsTimestamps
+            && m_Disp.getQueryPoolResults(m_TimestampQueryPool, slot * TIMESTAMPS_PER_FRAME + 2, 2, sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS
+            && TimestampDeltaMs(timestamps[0], timestamps[1]) * 1e-3f > batch.TimeoutSeconds)
+        {
+            shader.Status = BatchStatus::TimedOut;
+        }
+
+        vmaInvalidateAllocation(m_Allocator, readbackBuffers[slot].BufferAllocation, 0, VK_WHOLE_SIZE);
+
+        if (shader.Status == BatchStatus::Pending)
+            memcpy(shader.Pixels.data() + pendingTimestamps[slot] * thumbnailSize, readbackData[slot], thumbnailSize);
+
+        if (shader.UnitsInFlight == 0 && (shader.Status != BatchStatus::Pending || shader.NextTimestamp == shader.Timestamps.size()))
+            finishShader(index);
+    };
+
+    // Work on the GPU can't be preempted : a thumbnail still running after the timeout blocks the queue, the batch stops there
+    auto waitSlot = [&](uint32_t slot)
+    {
+        const uint64_t timeoutNs = pendingShaders[slot] < 0 ? UINT64_MAX : static_cast<uint64_t>(batch.TimeoutSeconds * 1e9);
+        VkResult result = m_Disp.waitForFences(1, &m_InFlightFences[slot], VK_TRUE, timeoutNs);
+        if (result == VK_SUCCESS)
+            return;
+
+        if (pendingShaders[slot] < 0)
+            VK_CHECK(result);
+
+        shaders[pendingShaders[slot]].Status = BatchStatus::TimedOut;
+        throw std::runtime_error("Batch : " + shaders[pendingShaders[slot]].Path + " still runs on the GPU after "
+            + std::format("{:g}", batch.TimeoutSeconds) + " s, the batch is stopped !");
+    };
+
+    auto beginCommandBuffer = [&](uint32_t slot)
+    {
+        VkCommandBuffer commandBuffer = m_CommandBuffers[slot];
+
+        VK_CHECK(m_Disp.resetFences(1, &m_InFlightFences[slot]));
+        VK_CHECK(m_Disp.resetCommandBuffer(commandBuffer, 0));
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        VK_CHECK(m_Disp.beginCommandBuffer(commandBuffer, &beginInfo));
+
+        return commandBuffer;
+    };
+
+    auto submitCommandBuffer = [&](uint32_t slot, VkCommandBuffer commandBuffer)
+    {
+        VK_CHECK(m_Disp.endCommandBuffer(commandBuffer));
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+
+        VK_CHECK(m_Disp.queueSubmit(m_GraphicsQueue, 1, &submitInfo, m_InFlightFences[slot]));
+    };
+
+    // Cube A and the simulation are rendered once so that every channel can be sampled
+    {
+        m_CurrentFrame = 0;
+        m_Disp.waitForFences(1, &m_InFlightFences[0], VK_TRUE, UINT64_MAX);
+
+        SetOfflineFrame(settings, 0);
+        WriteShaderInputs();
+
+        VkCommandBuffer commandBuffer = beginCommandBuffer(0);
+
+        RecordCubemapPass(commandBuffer);
+
+        RecordSimulationPass(commandBuffer, false);
+        m_SimDisplayIndex = m_SimOutputIndex;
+
+        submitCommandBuffer(0, commandBuffer);
+    }
+
+    uint32_t submission = 1;
+
+    while (finishedCount < shaders.size())
+    {
+        // Pipeline creation counts against the timeout once the shader is next in line
+        while (activeShaders.size() < MAX_FRAMES_IN_FLIGHT && nextShader < shaders.size())
+        {
+            uint32_t index = nextShader++;
+            BatchShader& shader = shaders[index];
+            activeShaders.push_back(index);
+
+            if (shader.Pipeline.wait_for(timeout) != std::future_status::ready)
+                shader.Status = BatchStatus::TimedOut;
+            else if ((shader.Handle = shader.Pipeline.get()) == VK_NULL_HANDLE)
+                shader.Status = BatchStatus::Failed;
+
+            if (shader.Status != BatchStatus::Pending)
+                finishShader(index);
+            else
+                shader.Pixels.resize(thumbnailSize * shader.Timestamps.size());
+        }
+
+        m_CurrentFrame = submission % MAX_FRAMES_IN_FLIGHT;
+        submission++;
+
+        waitSlot(m_CurrentFrame);
+
+        flushSlot(m_CurrentFrame);
+
+        // Round robin over the active shaders so that the slots in flight hold different shaders
+        int64_t selected = -1;
+        for (size_t i = 0; i < activeShaders.size() && selected < 0; i++)
+        {
+            uint32_t index = activeShaders[(roundRobin + i) % activeShaders.size()];
+            if (shaders[index].Status == BatchStatus::Pending && shaders[index].NextTimestamp < shaders[index].Timestamps.size())
+                selected = index;
+        }
+        roundRobin++;
+
+        // Every active shader is waiting on its last thumbnails, the next slots hold them
+        if (selected < 0)
+            continue;
+
+        BatchShader& shader = shaders[selected];
+        uint32_t timestamp = shader.NextTimestamp++;
+        shader.UnitsInFlight++;
+
+        float time = shader.Timestamps[timestamp];
+        m_SimulationTime = time;
+        m_FrameCount = static_cast<uint32_t>(time * settings.Fps);
+        WriteShaderInputs();
+
+        VkCommandBuffer commandBuffer = beginCommandBuffer(m_CurrentFrame);
+
+        const uint32_t firstQuery = m_CurrentFrame * TIMESTAMPS_PER_FRAME + 2;
+        if (m_GraphicsTimestamps)
+        {
+            m_Disp.cmdResetQueryPool(commandBuffer, m_TimestampQueryPool, firstQuery, 2);
+            m_Disp.cmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_TimestampQueryPool, firstQuery);
+        }
+
+        RecordImagePass(commandBuffer, m_RTImages[m_CurrentFrame], { { 0, 0 }, { settings.Width, settings.Height } }, shader.Handle);
+
+        if (m_GraphicsTimestamps)
+            m_Disp.cmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_TimestampQueryPool, firstQuery + 1);
+
+        RecordColorConvert(commandBuffer, m_CurrentFrame, { settings.Width, settings.Height }, VideoFormat::Rgba8, settings.Capture, timestamp, readbackBuffers[m_CurrentFrame]);
+
+        submitCommandBuffer(m_CurrentFrame, commandBuffer);
+
+        pendingShaders[m_CurrentFrame] = selected;
+        pendingTimestamps[m_CurrentFrame] = timestamp;
+    }
+
+    m_Disp.deviceWaitIdle();
+
+    for (auto& readbackBuffer : readbackBuffers)
+        readbackBuffer.Clenup(m_Allocator);
+
+    // Contact sheet : one row per shader, one column per timestamp, streamed band by band.
+    // Golden runs skip it, every failure already has its render and heat map.
+    PngStreamWriter contactSheet;
+    bool success = true;
+
+    const size_t rowSize = static_cast<size_t>(settings.Width) * 4;
+    std::vector<uint8_t> band;
+    uint32_t renderedCount = 0;
+    uint32_t comparisonCount = 0;
+    uint32_t failedComparisons = 0;
+
+    if (!golden)
+    {
+        std::string contactSheetPath = batch.OutputDirectory + "/contact_sheet.png";
+        success = contactSheet.Open(contactSheetPath, settings.Width * maxTimestampCount, settings.Height * static_cast<uint32_t>(shaders.size()));
+        band.resize(thumbnailSize * maxTimestampCount);
+    }
+
+    for (BatchShader& shader : shaders)
+    {
+        const uint32_t timestampCount = static_cast<uint32_t>(shader.Timestamps.size());
+        const bool rendered = shader.Status == BatchStatus::Rendered;
+        comparisonCount += timestampCount;
+
+        if (rendered)
+        {
+            success &= shader.Written.get();
+            renderedCount++;
+
+            failedComparisons += shader.FailedComparisons;
+            for (const std::string& line : shader.Report)
+                std::cerr << "Golden : FAIL " << line << std::endl;
+
+            entries[&shader - shaders.data()].Hashes = shader.Hashes;
+        }
+        else
+        {
+            failedComparisons += timestampCount;
+        }
+
+        if (golden)
+            continue;
+
+        // Dark red cells for the shaders without thumbnails
+        if (!rendered || timestampCount < maxTimestampCount)
+        {
+            for (size_t i = 0; i < band.size(); i += 4)
+            {
+                band[i] = 64;
+                band[i + 1] = 0;
+                band[i + 2] = 0;
+                band[i + 3] = 255;
+            }
+        }
+
+        if (rendered)
+        {
+            for (uint32_t t = 0; t < timestampCount; t++)
+                for (uint32_t y = 0; y < settings.Height; y++)
+                    memcpy(band.data() + (static_cast<size_t>(y) * maxTimestampCount + t) * rowSize, shader.Pixels.data() + t * thumbnailSize + y * rowSize, rowSize);
+        }
+
+        success &= contactSheet.WriteRows(band.data(), settings.Height);
+        shader.Pixels = std::vector<uint8_t>();
+    }
+
+    if (!golden)
+        success &= contactSheet.Close();
+
+    // Compilations that timed out are still running, their pipelines are released once they finish
+    for (BatchShader& shader : shaders)
+    {
+        if (shader.Status == BatchStatus::TimedOut && shader.Pipeline.valid())
+        {
+            VkPipeline pipeline = shader.Pipeline.get();
+            if (pipeline != VK_NULL_HANDLE)
+                m_Disp.destroyPipeline(pipeline, nullptr);
+        }
+    }
+
+    float elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+    debug_log("Batch : " << renderedCount << " / " << shaders.size() << " shaders in " << elapsed << " s ("
+        << shaders.size() * 60.f / std::max(elapsed, 1e-6f) << " shaders per minute, " << pool.GetThreadCount() << " compilation threads)");
+
+    // The verdicts are the result of the run, they are printed in every build
+    if (!success)
+        std::cerr << "Batch : failed to write " << batch.OutputDirectory << " !" << std::endl;
+
+    // Shaders that didn't render are recorded without hashes
+    if (batch.RecordHashes)
+    {
+        for (size_t i = 0; i < shaders.size(); i++)
+        {
+            if (shaders[i].Status != BatchStatus::Rendered)
+                entries[i].Hashes.clear();
+        }
+
+        if (RecordBatchHashes(batch.Manifest, entries))
+        {
+            std::cout << "Batch : recorded the hashes of " << renderedCount << " / " << shaders.size() << " shaders in " << batch.Manifest << std::endl;
+        }
+        else
+        {
+            std::cerr << "Batch : failed to record the hashes in " << batch.Manifest << " !" << std::endl;
+            success = false;
+        }
+    }
+
+    if (golden)
+    {
+        std::cout << "Golden : " << comparisonCount - failedComparisons << " / " << comparisonCount << " comparisons passed against " << batch.ReferenceDirectory << std::endl;
+        return success && failedComparisons == 0;
+    }
+
+    return success;
+}
@@ -0,0 +1,279 @@
+﻿#include "VulkanCore.h"
+
+#include <cmath>
+#include <format>
+
+bool VulkanCore::RenderBenchmark(const OfflineRenderSettings& settings)
+{
+    const BenchmarkSettings& benchmark = settings.Benchmark;
+
+    if (!m_GraphicsTimestamps)
+    {
+        std::cerr << "Benchmark : the graphics queue of " << m_Device.physical_device.name << " has no timestamps !" << std::endl;
+        return false;
+    }
+
+    std::vector<BatchShaderEntry> entries;
+    if (!ListBatchShaders(settings.Batch.Manifest, settings.Batch.Directory, settings.Batch.Timestamps, entries))
+        return false;
+
+    SetupOfflineInputs(settings);
+
+    // A/B mode : one pipeline per recipe, interleaved per frame so that both see the same clocks and temperature
+    std::vector<uint32_t> recipes = { settings.SpirvRecipe };
+    if (benchmark.CompareRecipe >= 0)
+        recipes.push_back(static_cast<uint32_t>(benchmark.CompareRecipe));
+    const size_t variantCount = recipes.size();
+
+    // Everything is compiled before the first measurement, compilation threads would skew the CPU times.
+    // Compilation time isn't measured : every pipeline is waited for, a stuck glslc is terminated by CompileGlsl.
+    std::vector<VkPipeline> handles(entries.size() * variantCount, VK_NULL_HANDLE);
+    {
+        ThreadPool pool(settings.Batch.ThreadCount);
+        std::vector<std::future<VkPipeline>> pipelines;
+        for (size_t i = 0; i < handles.size(); i++)
+        {
+            const uint32_t recipe = recipes[i % variantCount];
+            pipelines.push_back(pool.Submit([this, i, recipe, variantCount, &entries]() { return CreateBatchPipeline(entries[i / variantCount].Path, recipe); }));
+        }
+
+        for (size_t i = 0; i < handles.size(); i++)
+            handles[i] = pipelines[i].get();
+    }
+
+    const uint64_t gpuTimeoutNs = static_cast<uint64_t>(settings.Batch.TimeoutSeconds * 1e9);
+
+    auto beginCommandBuffer = [&](uint32_t slot)
+    {
+        VkCommandBuffer commandBuffer = m_CommandBuffers[slot];
+
+        VK_CHECK(m_Disp.resetFences(1, &m_InFlightFences[slot]));
+        VK_CHECK(m_Disp.resetCommandBuffer(commandBuffer, 0));
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        VK_CHECK(m_Disp.beginCommandBuffer(commandBuffer, &beginInfo));
+
+        return commandBuffer;
+    };
+
+    auto submitCommandBuffer = [&](uint32_t slot, VkCommandBuffer commandBuffer)
+    {
+        VK_CHECK(m_Disp.endCommandBuffer(commandBuffer));
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+
+        VK_CHECK(m_Disp.queueSubmit(m_GraphicsQueue, 1, &submitInfo, m_InFlightFences[slot]));
+    };
+
+    // Cube A is rendered once and the simulation gets its first step so that every channel can be sampled
+    {
+        m_CurrentFrame = 0;
+        m_Disp.waitForFences(1, &m_InFlightFences[0], VK_TRUE, UINT64_MAX);
+
+        SetOfflineFrame(settings, settings.StartFrame);
+        WriteShaderInputs();
+
+        VkCommandBuffer commandBuffer = beginCommandBuffer(0);
+
+        RecordCubemapPass(commandBuffer);
+
+        RecordSimulationPass(commandBuffer, false);
+        m_SimDisplayIndex = m_SimOutputIndex;
+
+        submitCommandBuffer(0, commandBuffer);
+    }
+
+    const uint32_t frameCount = settings.EndFrame > settings.StartFrame ? settings.EndFrame - settings.StartFrame : 1;
+    const uint32_t totalFrames = benchmark.WarmupFrames + frameCount;
+
+    BenchmarkReport report;
+    bool allRendered = true;
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        BenchmarkResult result;
+        result.Name = entries[i].Name;
+        result.Path = entries[i].Path;
+        result.Recipe = SPIRV_RECIPES[recipes[0]].Name;
+
+        const VkPipeline* variants = &handles[i * variantCount];
+        if (std::find(variants, variants + variantCount, VK_NULL_HANDLE) != variants + variantCount)
+        {
+            std::cerr << "Benchmark : " << entries[i].Path << " failed to compile" << std::endl;
+            for (size_t v = 0; v < variantCount; v++)
+                if (variants[v] != VK_NULL_HANDLE)
+                    m_Disp.destroyPipeline(variants[v], nullptr);
+            report.Add(result);
+            allRendered = false;
+            continue;
+        }
+
+        // A/B mode : every frame is rendered once per variant so that both see the same inputs,
+        // the order of the variants alternates between frames (AB, BA, ...)
+        const uint32_t submissionCount = totalFrames * static_cast<uint32_t>(variantCount);
+
+        std::vector<std::vector<float>> gpuTimes(variantCount);
+        std::vector<std::vector<float>> cpuTimes(variantCount);
+        for (size_t v = 0; v < variantCount; v++)
+        {
+            gpuTimes[v].reserve(frameCount);
+            cpuTimes[v].reserve(frameCount);
+        }
+
+        std::array<int64_t, MAX_FRAMES_IN_FLIGHT> slotFrames;
+        std::array<size_t, MAX_FRAMES_IN_FLIGHT> slotVariants = {};
+        slotFrames.fill(-1);
+
+        // Work on the GPU can't be preempted : a frame still running after the timeout blocks the queue, the benchmark stops there
+        auto waitSlot = [&](uint32_t slot)
+        {
+            VkResult result = m_Disp.waitForFences(1, &m_InFlightFences[slot], VK_TRUE, slotFrames[slot] < 0 ? UINT64_MAX : gpuTimeoutNs);
+            if (result == VK_TIMEOUT)
+                throw std::runtime_error("Benchmark : " + entries[i].Path + " still runs on the GPU after "
+                    + std::format("{:g}", settings.Batch.TimeoutSeconds) + " s, the benchmark is stopped !");
+            VK_CHECK(result);
+        };
+
+        // The slot fence was waited on
+        auto collect = [&](uint32_t slot)
+        {
+            if (slotFrames[slot] >= static_cast<int64_t>(benchmark.WarmupFrames))
+            {
+                std::array<uint64_t, 2> timestamps{};
+                if (m_Disp.getQueryPoolResults(m_TimestampQueryPool, slot * TIMESTAMPS_PER_FRAME + 2, 2, sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+                    gpuTimes[slotVariants[slot]].push_back(TimestampDeltaMs(timestamps[0], timestamps[1]));
+            }
+
+            slotFrames[slot] = -1;
+        };
+
+        for (uint32_t submission = 0; submission < submissionCount; submission++)
+        {
+            const uint32_t frame = submission / static_cast<uint32_t>(variantCount);
+            const size_t variant = (submission + frame) % variantCount;
+            m_CurrentFrame = submission % MAX_FRAMES_IN_FLIGHT;
+
+            waitSlot(m_CurrentFrame);
+            collect(m_CurrentFrame);
+
+            // The CPU time of a frame : its inputs, recording and submission
+            auto cpuStart = std::chrono::steady_clock::now();
+
+            // Warm-up frames repeat StartFrame
+            SetOfflineFrame(settings, settings.StartFrame + (frame < benchmark.WarmupFrames ? 0 : frame - benchmark.WarmupFrames));
+            WriteShaderInputs();
+
+            VkCommandBuffer commandBuffer = beginCommandBuffer(m_CurrentFrame);
+
+            // The simulation steps once per frame, before its first variant, so that multipass shaders read a moving state.
+            // It isn't part of the measured frame : its recording is left out of the CPU time and
+            // the first timestamp waits for it at the bottom of the pipe.
+            std::chrono::steady_clock::duration simulationRecording{};
+            if (submission % variantCount == 0)
+            {
+                auto simulationStart = std::chrono::steady_clock::now();
+
+                RecordSimulationPass(commandBuffer, false);
+                m_SimDisplayIndex = m_SimOutputIndex;
+
+                simulationRecording = std::chrono::steady_clock::now() - simulationStart;
+            }
+
+            const uint32_t firstQuery = m_CurrentFrame * TIMESTAMPS_PER_FRAME + 2;
+            m_Disp.cmdResetQueryPool(commandBuffer, m_TimestampQueryPool, firstQuery, 2);
+            m_Disp.cmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_TimestampQueryPool, firstQuery);
+
+            RecordImagePass(commandBuffer, m_RTImages[m_CurrentFrame], { { 0, 0 }, { settings.Width, settings.Height } }, variants[variant]);
+
+            m_Disp.cmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_TimestampQueryPool, firstQuery + 1);
+
+            submitCommandBuffer(m_CurrentFrame, commandBuffer);
+
+            if (frame >= benchmark.WarmupFrames)
+                cpuTimes[variant].push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - cpuStart - simulationRecording).count());
+
+            slotFrames[m_CurrentFrame] = frame;
+            slotVariants[m_CurrentFrame] = variant;
+        }
+
+        // Remaining frames, oldest first
+        for (uint32_t k = 0; k < MAX_FRAMES_IN_FLIGHT; k++)
+        {
+            uint32_t slot = (submissionCount + k) % MAX_FRAMES_IN_FLIGHT;
+            waitSlot(slot);
+            collect(slot);
+        }
+
+        for (size_t v = 0; v < variantCount; v++)
+            m_Disp.destroyPipeline(variants[v], nullptr);
+
+        result.Success = true;
+        result.Gpu = FrameTimeStats::Compute(gpuTimes[0]);
+        result.Cpu = FrameTimeStats::Compute(cpuTimes[0]);
+
+        std::cout << "Benchmark : " << result.Name << " GPU median " << result.Gpu.Median << " ms, p99 " << result.Gpu.P99
+            << " ms, CPU median " << result.Cpu.Median << " ms" << std::endl;
+
+        if (variantCount > 1)
+        {
+            result.CompareRecipe = SPIRV_RECIPES[recipes[1]].Name;
+            result.CompareGpu = FrameTimeStats::Compute(gpuTimes[1]);
+            result.CompareCpu = FrameTimeStats::Compute(cpuTimes[1]);
+            result.DeltaMs = FrameTimeStats::MeanDifference(result.Gpu, result.CompareGpu, result.DeltaCi95Ms);
+
+            // The difference is significant when the confidence interval excludes 0
+            std::cout << "Benchmark : " << result.Name << " " << result.Recipe << " " << result.Gpu.Mean << " ms -> "
+                << result.CompareRecipe << " " << result.CompareGpu.Mean << " ms : " << result.DeltaMs << " ms +/- " << result.DeltaCi95Ms
+                << (std::abs(result.DeltaMs) > result.DeltaCi95Ms ? "" : " (not significant)") << ", CPU median "
+                << result.Cpu.Median << " ms -> " << result.CompareCpu.Median << " ms" << std::endl;
+        }
+
+        report.Add(result);
+    }
+
+    // The results are the output of the run, they are printed in every build
+    bool success = report.Write(benchmark.OutputPath, settings.Width, settings.Height, frameCount);
+    if (!success)
+        std::cerr << "Benchmark : failed to write " << benchmark.OutputPath << " !" << std::endl;
+
+    if (benchmark.BaselinePath.empty())
+        return success && allRendered;
+
+    std::map<std::string, double> baseline;
+    if (!BenchmarkReport::LoadBaseline(benchmark.BaselinePath, baseline))
+    {
+        std::cerr << "Benchmark : can't read the baseline " << benchmark.BaselinePath << " !" << std::endl;
+        return false;
+    }
+
+    uint32_t regressions = 0;
+    for (const BenchmarkResult& result : report.GetResults())
+    {
+        auto reference = baseline.find(result.Name);
+        if (reference == baseline.end())
+        {
+            std::cout << "Benchmark : " << result.Name << " has no baseline" << std::endl;
+            continue;
+        }
+
+        // A shader of the baseline that no longer renders is a regression too
+        const double ratio = result.Success && reference->second > 0. ? result.Gpu.Median / reference->second : 1.;
+        if (!result.Success || ratio > 1. + benchmark.RegressionThreshold)
+        {
+            std::cerr << "Benchmark : REGRESSION " << result.Name << " " << reference->second << " ms -> "
+                << (result.Success ? std::to_string(result.Gpu.Median) + " ms" : std::string("failed")) << std::endl;
+            regressions++;
+        }
+    }
+
+    std::cout << "Benchmark : " << regressions << " regression(s) against " << benchmark.BaselinePath
+        << " (threshold " << benchmark.RegressionThreshold * 100.f << " %)" << std::endl;
+
+    return success && allRendered && regressions == 0;
+}
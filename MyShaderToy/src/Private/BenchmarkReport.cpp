@@ -0,0 +1,135 @@
+#include "BenchmarkReport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+
+FrameTimeStats FrameTimeStats::Compute(std::vector<float> times)
+{
+    FrameTimeStats stats;
+    if (times.empty())
+        return stats;
+
+    std::sort(times.begin(), times.end());
+
+    // Nearest rank
+    auto percentile = [&times](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * times.size()));
+        return static_cast<double>(times[std::clamp<size_t>(rank, 1, times.size()) - 1]);
+    };
+
+    double sum = 0.;
+    for (float time : times)
+        sum += time;
+    stats.Mean = sum / times.size();
+
+    double squares = 0.;
+    for (float time : times)
+        squares += (time - stats.Mean) * (time - stats.Mean);
+    stats.StdDev = std::sqrt(squares / times.size());
+
+    size_t middle = times.size() / 2;
+    stats.Median = times.size() % 2 ? times[middle] : 0.5 * (times[middle - 1] + times[middle]);
+    stats.P95 = percentile(0.95);
+    stats.P99 = percentile(0.99);
+    stats.Count = times.size();
+
+    return stats;
+}
+
+double FrameTimeStats::MeanDifference(const FrameTimeStats& a, const FrameTimeStats& b, double& ci95)
+{
+    ci95 = 0.;
+    if (a.Count == 0 || b.Count == 0)
+        return 0.;
+
+    ci95 = 1.96 * std::sqrt(a.StdDev * a.StdDev / a.Count + b.StdDev * b.StdDev / b.Count);
+
+    return b.Mean - a.Mean;
+}
+
+static std::string EscapeJson(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+static std::string StatsToJson(const FrameTimeStats& stats)
+{
+    return std::format("{{ \"mean\": {:.4f}, \"median\": {:.4f}, \"p95\": {:.4f}, \"p99\": {:.4f}, \"stddev\": {:.4f} }}",
+        stats.Mean, stats.Median, stats.P95, stats.P99, stats.StdDev);
+}
+
+bool BenchmarkReport::Write(const std::string& path, uint32_t width, uint32_t height, uint32_t frames) const
+{
+    std::ofstream file(path);
+    if (!file)
+        return false;
+
+    file << "{\n";
+    file << std::format("  \"width\": {}, \"height\": {}, \"frames\": {},\n", width, height, frames);
+    file << "  \"shaders\": [\n";
+
+    for (size_t i = 0; i < m_Results.size(); i++)
+    {
+        const BenchmarkResult& result = m_Results[i];
+
+        file << "    { \"name\": \"" << EscapeJson(result.Name) << "\", \"path\": \"" << EscapeJson(result.Path) << "\", ";
+        if (result.Success)
+        {
+            file << "\"recipe\": \"" << EscapeJson(result.Recipe) << "\", ";
+            file << "\"gpu_ms\": " << StatsToJson(result.Gpu) << ", \"cpu_ms\": " << StatsToJson(result.Cpu);
+            // After gpu_ms : LoadBaseline reads the first median of the line
+            if (!result.CompareRecipe.empty())
+                file << std::format(", \"ab\": {{ \"recipe\": \"{}\", \"gpu_ms\": {}, \"cpu_ms\": {}, \"delta_ms\": {:.4f}, \"ci95_ms\": {:.4f} }}",
+                    EscapeJson(result.CompareRecipe), StatsToJson(result.CompareGpu), StatsToJson(result.CompareCpu), result.DeltaMs, result.DeltaCi95Ms);
+            file << " }";
+        }
+        else
+            file << "\"error\": true }";
+        file << (i + 1 < m_Results.size() ? ",\n" : "\n");
+    }
+
+    file << "  ]\n}\n";
+
+    return file.good();
+}
+
+bool BenchmarkReport::LoadBaseline(const std::string& path, std::map<std::string, double>& gpuMedians)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    const std::string nameKey = "\"name\": \"";
+    const std::string medianKey = "\"median\": ";
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        size_t name = line.find(nameKey);
+        size_t gpu = line.find("\"gpu_ms\"");
+        if (name == std::string::npos || gpu == std::string::npos)
+            continue;
+
+        // Names never hold quotes in practice, an escaped one only truncates the key
+        name += nameKey.size();
+        size_t nameEnd = line.find('"', name);
+
+        size_t median = line.find(medianKey, gpu);
+        if (nameEnd == std::string::npos || median == std::string::npos)
+            continue;
+
+        gpuMedians[line.substr(name, nameEnd - name)] = atof(line.c_str() + median + medianKey.size());
+    }
+
+    return true;
+}
@@ -0,0 +1,29 @@
+#include "BuiltinShaders.h"
+
+// glslc -mfmt=c writes each module as a braced list of words into $(IntDir)Shaders
+static constexpr uint32_t FullscreenVertexCode[] =
+#include "Shader0.vert.inc"
+;
+
+static constexpr uint32_t ColorConvertCode[] =
+#include "ColorConvert.comp.inc"
+;
+
+static constexpr uint32_t AccumulateCode[] =
+#include "Accumulate.comp.inc"
+;
+
+std::span<const uint32_t> GetBuiltinShaderCode(BuiltinShader shader)
+{
+    switch (shader)
+    {
+    case BUILTIN_SHADER_FULLSCREEN_VERTEX:
+        return FullscreenVertexCode;
+    case BUILTIN_SHADER_COLOR_CONVERT:
+        return ColorConvertCode;
+    case BUILTIN_SHADER_ACCUMULATE:
+        return AccumulateCode;
+    default:
+        return {};
+    }
+}
@@ -0,0 +1,148 @@
+#include "FileWatcher.h"
+
+#include "log.h"
+#include <algorithm>
+#include <windows.h>
+
+FileWatcher::~FileWatcher()
+{
+    Stop();
+}
+
+void FileWatcher::Start(const std::vector<std::string>& paths, float debounceSeconds, float pollSeconds)
+{
+    Stop();
+
+    m_Debounce = std::chrono::duration<float>(debounceSeconds);
+    m_PollInterval = std::chrono::duration<float>(pollSeconds);
+
+    m_Files.clear();
+    m_Directories.clear();
+
+    std::error_code error;
+    for (const std::string& path : paths)
+    {
+        // Missing files are watched too, their creation counts as a change
+        WatchedFile file;
+        file.Path = path;
+        file.WriteTime = std::filesystem::last_write_time(path, error);
+        if (error)
+            file.WriteTime = std::filesystem::file_time_type::min();
+        m_Files.push_back(file);
+
+        std::string directory = std::filesystem::absolute(path, error).parent_path().string();
+        if (std::find(m_Directories.begin(), m_Directories.end(), directory) == m_Directories.end())
+            m_Directories.push_back(directory);
+    }
+
+    m_StopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (m_StopEvent == nullptr)
+        return;
+
+    m_Thread = std::thread(&FileWatcher::Run, this);
+}
+
+void FileWatcher::Stop()
+{
+    if (m_Thread.joinable())
+    {
+        SetEvent(m_StopEvent);
+        m_Thread.join();
+    }
+
+    if (m_StopEvent)
+    {
+        CloseHandle(m_StopEvent);
+        m_StopEvent = nullptr;
+    }
+}
+
+std::vector<std::string> FileWatcher::PollChanges()
+{
+    std::vector<std::string> changes;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    changes.swap(m_Changes);
+
+    return changes;
+}
+
+bool FileWatcher::ScanFiles()
+{
+    const auto now = std::chrono::steady_clock::now();
+    bool pending = false;
+
+    std::error_code error;
+    for (WatchedFile& file : m_Files)
+    {
+        // Editors may remove or lock the file while saving, the next scan catches up
+        auto writeTime = std::filesystem::last_write_time(file.Path, error);
+        if (!error && writeTime != file.WriteTime)
+        {
+            file.WriteTime = writeTime;
+            file.LastChange = now;
+            file.Pending = true;
+        }
+
+        if (file.Pending && now - file.LastChange >= m_Debounce)
+        {
+            file.Pending = false;
+
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (std::find(m_Changes.begin(), m_Changes.end(), file.Path) == m_Changes.end())
+                m_Changes.push_back(file.Path);
+        }
+
+        pending |= file.Pending;
+    }
+
+    return pending;
+}
+
+void FileWatcher::Run()
+{
+    // One notification per directory, the stop event last
+    std::vector<HANDLE> handles;
+    for (const std::string& directory : m_Directories)
+    {
+        std::wstring wideDirectory(directory.begin(), directory.end());
+        HANDLE notification = FindFirstChangeNotificationW(wideDirectory.c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+        if (notification == INVALID_HANDLE_VALUE)
+            break;
+        handles.push_back(notification);
+    }
+
+    const bool notified = handles.size() == m_Directories.size();
+    if (!notified)
+    {
+        debug_log("File watcher : can't watch the shader directories, polling every " << m_PollInterval.count() << " s");
+        for (HANDLE notification : handles)
+            FindCloseChangeNotification(notification);
+        handles.clear();
+    }
+
+    handles.push_back(m_StopEvent);
+    const DWORD stopIndex = static_cast<DWORD>(handles.size() - 1);
+
+    const DWORD pollMs = static_cast<DWORD>(m_PollInterval.count() * 1000.f);
+    const DWORD debounceMs = std::max(static_cast<DWORD>(m_Debounce.count() * 250.f), 10ul);
+
+    bool pending = false;
+    while (true)
+    {
+        // Woken up by the notifications, short timeouts only while a change waits for its debounce window
+        DWORD timeout = pending ? debounceMs : (notified ? INFINITE : pollMs);
+
+        DWORD result = WaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(), FALSE, timeout);
+        if (result == WAIT_OBJECT_0 + stopIndex || result == WAIT_FAILED)
+            break;
+
+        if (result < WAIT_OBJECT_0 + stopIndex)
+            FindNextChangeNotification(handles[result - WAIT_OBJECT_0]);
+
+        pending = ScanFiles();
+    }
+
+    for (DWORD i = 0; i < stopIndex; i++)
+        FindCloseChangeNotification(handles[i]);
+}
@@ -0,0 +1,43 @@
+#include "GoldenImage.h"
+
+#include <format>
+#include <vector>
+
+#include <stb_image.h>
+#include <stb_image_write.h>
+
+GoldenComparison CompareGolden(const uint8_t* render, uint32_t width, uint32_t height, const std::string& referencePath, const ImageDiffTolerance& tolerance,
+    const std::string& heatMapPath)
+{
+    GoldenComparison comparison;
+
+    int referenceWidth = 0, referenceHeight = 0, channels = 0;
+    stbi_uc* reference = stbi_load(referencePath.c_str(), &referenceWidth, &referenceHeight, &channels, 4);
+
+    if (reference == nullptr || referenceWidth != static_cast<int>(width) || referenceHeight != static_cast<int>(height))
+    {
+        comparison.Status = GoldenStatus::MissingReference;
+        comparison.Report = "no " + std::to_string(width) + "x" + std::to_string(height) + " reference " + referencePath;
+        stbi_image_free(reference);
+        return comparison;
+    }
+
+    ImageDiffResult diff = DiffImages(render, reference, width, height, tolerance.PixelThreshold);
+
+    if (diff.Passed(tolerance, width * height))
+    {
+        stbi_image_free(reference);
+        return comparison;
+    }
+
+    std::vector<uint8_t> heatMap(static_cast<size_t>(width) * height * 4);
+    DiffImages(render, reference, width, height, tolerance.PixelThreshold, heatMap.data());
+    stbi_image_free(reference);
+
+    comparison.Written = stbi_write_png(heatMapPath.c_str(), static_cast<int>(width), static_cast<int>(height), 4, heatMap.data(), static_cast<int>(width) * 4) != 0;
+
+    comparison.Status = GoldenStatus::Failed;
+    comparison.Report = std::format("{} pixels differ (max {}, mean {:.3f}), SSIM {:.4f}", diff.DifferentPixels, diff.MaxDifference, diff.MeanDifference, diff.Ssim);
+
+    return comparison;
+}
@@ -0,0 +1,170 @@
+#include "ImageDiff.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define IMAGE_DIFF_SSE2
+#endif
+
+bool ImageDiffResult::Passed(const ImageDiffTolerance& tolerance, uint32_t pixelCount) const
+{
+    return DifferentPixels <= tolerance.MaxDifferentPixels * pixelCount && Ssim >= tolerance.MinSsim;
+}
+
+static void WriteHeatPixel(uint8_t* out, const uint8_t* reference, uint32_t difference, uint8_t threshold)
+{
+    if (difference > threshold)
+    {
+        out[0] = 255;
+        out[1] = static_cast<uint8_t>(255 - std::min(difference * 4u, 255u));
+        out[2] = 0;
+    }
+    else
+    {
+        uint8_t grey = static_cast<uint8_t>((reference[0] * 77u + reference[1] * 150u + reference[2] * 29u) >> 10);
+        out[0] = grey;
+        out[1] = grey;
+        out[2] = grey;
+    }
+    out[3] = 255;
+}
+
+// Mean SSIM of the non overlapping 8x8 blocks of the luma
+static double LumaSsim(const uint8_t* a, const uint8_t* b, uint32_t width, uint32_t height)
+{
+    const double c1 = (0.01 * 255.) * (0.01 * 255.);
+    const double c2 = (0.03 * 255.) * (0.03 * 255.);
+
+    double ssimSum = 0.;
+    uint32_t blockCount = 0;
+
+    for (uint32_t by = 0; by + 8 <= height; by += 8)
+    {
+        for (uint32_t bx = 0; bx + 8 <= width; bx += 8)
+        {
+            float sumA = 0.f, sumB = 0.f, sumAA = 0.f, sumBB = 0.f, sumAB = 0.f;
+
+            for (uint32_t y = by; y < by + 8; y++)
+            {
+                const size_t row = (static_cast<size_t>(y) * width + bx) * 4;
+                for (uint32_t x = 0; x < 8; x++)
+                {
+                    const uint8_t* pa = a + row + x * 4;
+                    const uint8_t* pb = b + row + x * 4;
+                    float la = 0.299f * pa[0] + 0.587f * pa[1] + 0.114f * pa[2];
+                    float lb = 0.299f * pb[0] + 0.587f * pb[1] + 0.114f * pb[2];
+                    sumA += la;
+                    sumB += lb;
+                    sumAA += la * la;
+                    sumBB += lb * lb;
+                    sumAB += la * lb;
+                }
+            }
+
+            const double meanA = sumA / 64.;
+            const double meanB = sumB / 64.;
+            const double varA = sumAA / 64. - meanA * meanA;
+            const double varB = sumBB / 64. - meanB * meanB;
+            const double covariance = sumAB / 64. - meanA * meanB;
+
+            ssimSum += ((2. * meanA * meanB + c1) * (2. * covariance + c2)) / ((meanA * meanA + meanB * meanB + c1) * (varA + varB + c2));
+            blockCount++;
+        }
+    }
+
+    return blockCount > 0 ? ssimSum / blockCount : 1.;
+}
+
+ImageDiffResult DiffImages(const uint8_t* a, const uint8_t* b, uint32_t width, uint32_t height, uint8_t threshold, uint8_t* heatMap)
+{
+    ImageDiffResult result;
+
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    uint64_t differenceSum = 0;
+    uint32_t maxDifference = 0;
+    size_t i = 0;
+
+#ifdef IMAGE_DIFF_SSE2
+    // 4 pixels per iteration : |a - b| per channel, SAD for the sum, per pixel max against the threshold
+    static const uint8_t bitCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lowByte = _mm_set1_epi32(0xFF);
+    const __m128i thresholdVector = _mm_set1_epi32(threshold);
+    __m128i sumVector = _mm_setzero_si128();
+    __m128i maxVector = _mm_setzero_si128();
+    alignas(16) uint32_t pixelMax[4];
+
+    for (; i + 4 <= pixelCount; i += 4)
+    {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i * 4));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i * 4));
+        __m128i difference = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+
+        sumVector = _mm_add_epi64(sumVector, _mm_sad_epu8(difference, zero));
+        maxVector = _mm_max_epu8(maxVector, difference);
+
+        __m128i m = _mm_max_epu8(difference, _mm_srli_epi32(difference, 8));
+        m = _mm_and_si128(_mm_max_epu8(m, _mm_srli_epi32(m, 16)), lowByte);
+
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(m, thresholdVector)));
+        result.DifferentPixels += bitCount[mask];
+
+        if (heatMap)
+        {
+            _mm_store_si128(reinterpret_cast<__m128i*>(pixelMax), m);
+            for (size_t k = 0; k < 4; k++)
+                WriteHeatPixel(heatMap + (i + k) * 4, b + (i + k) * 4, pixelMax[k], threshold);
+        }
+    }
+
+    alignas(16) uint64_t sums[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(sums), sumVector);
+    differenceSum = sums[0] + sums[1];
+
+    alignas(16) uint8_t maxBytes[16];
+    _mm_store_si128(reinterpret_cast<__m128i*>(maxBytes), maxVector);
+    for (uint8_t value : maxBytes)
+        maxDifference = std::max<uint32_t>(maxDifference, value);
+#endif
+
+    // Remaining pixels, or every pixel without SSE2
+    for (; i < pixelCount; i++)
+    {
+        uint32_t pixelDifference = 0;
+        for (size_t c = 0; c < 4; c++)
+        {
+            uint32_t d = static_cast<uint32_t>(std::abs(a[i * 4 + c] - b[i * 4 + c]));
+            differenceSum += d;
+            pixelDifference = std::max(pixelDifference, d);
+        }
+
+        maxDifference = std::max(maxDifference, pixelDifference);
+        result.DifferentPixels += pixelDifference > threshold ? 1 : 0;
+
+        if (heatMap)
+            WriteHeatPixel(heatMap + i * 4, b + i * 4, pixelDifference, threshold);
+    }
+
+    result.MaxDifference = static_cast<uint8_t>(maxDifference);
+    result.MeanDifference = pixelCount > 0 ? static_cast<double>(differenceSum) / (pixelCount * 4) : 0.;
+
+    // Identical images need no structural comparison
+    result.Ssim = differenceSum == 0 ? 1. : LumaSsim(a, b, width, height);
+
+    return result;
+}
+
+uint64_t HashImage(const uint8_t* pixels, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= pixels[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
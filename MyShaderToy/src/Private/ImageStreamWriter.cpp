@@ -0,0 +1,477 @@
+#include "ImageStreamWriter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    void WriteBE32(uint8_t* dst, uint32_t value)
+    {
+        dst[0] = static_cast<uint8_t>(value >> 24);
+        dst[1] = static_cast<uint8_t>(value >> 16);
+        dst[2] = static_cast<uint8_t>(value >> 8);
+        dst[3] = static_cast<uint8_t>(value);
+    }
+
+    uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size)
+    {
+        static const std::array<uint32_t, 256> table = [] {
+            std::array<uint32_t, 256> t{};
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[i] = c;
+            }
+            return t;
+        }();
+
+        crc = ~crc;
+        for (size_t i = 0; i < size; i++)
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t size)
+    {
+        uint32_t a = adler & 0xFFFF;
+        uint32_t b = adler >> 16;
+
+        // 5552 is the largest run before b can overflow 32 bits
+        while (size > 0)
+        {
+            size_t run = std::min<size_t>(size, 5552);
+            for (size_t i = 0; i < run; i++)
+            {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            data += run;
+            size -= run;
+        }
+
+        return (b << 16) | a;
+    }
+
+    // PNG filter of one RGBA8 row, previous : the raw row above (zeros for the first row)
+    void FilterRow(uint8_t filter, const uint8_t* row, const uint8_t* previous, size_t size, uint8_t* out)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            const int left = i >= 4 ? row[i - 4] : 0;
+            const int up = previous[i];
+            const int upLeft = i >= 4 ? previous[i - 4] : 0;
+
+            int predictor = 0;
+            switch (filter)
+            {
+            case 1: predictor = left; break;
+            case 2: predictor = up; break;
+            case 3: predictor = (left + up) / 2; break;
+            case 4:
+            {
+                const int p = left + up - upLeft;
+                const int pa = abs(p - left), pb = abs(p - up), pc = abs(p - upLeft);
+                predictor = pa <= pb && pa <= pc ? left : pb <= pc ? up : upLeft;
+                break;
+            }
+            }
+            out[i] = static_cast<uint8_t>(row[i] - predictor);
+        }
+    }
+
+    // Deflate bit stream, fixed Huffman codes (RFC 1951 3.2.6), the bits are packed from the LSB
+    struct DeflateBits
+    {
+        std::vector<uint8_t>& Out;
+        uint32_t& Buffer;
+        uint32_t& Count;
+
+        void Put(uint32_t value, uint32_t bitCount)
+        {
+            Buffer |= value << Count;
+            Count += bitCount;
+            while (Count >= 8)
+            {
+                Out.push_back(static_cast<uint8_t>(Buffer));
+                Buffer >>= 8;
+                Count -= 8;
+            }
+        }
+
+        // Huffman codes are stored from their MSB
+        void PutCode(uint32_t code, uint32_t length)
+        {
+            uint32_t reversed = 0;
+            for (uint32_t i = 0; i < length; i++)
+                reversed |= ((code >> i) & 1u) << (length - 1 - i);
+            Put(reversed, length);
+        }
+
+        void PutSymbol(uint32_t symbol)
+        {
+            if (symbol <= 143)
+                PutCode(0x30 + symbol, 8);
+            else if (symbol <= 255)
+                PutCode(0x190 + symbol - 144, 9);
+            else if (symbol <= 279)
+                PutCode(symbol - 256, 7);
+            else
+                PutCode(0xC0 + symbol - 280, 8);
+        }
+
+        void PutMatch(uint32_t length, uint32_t distance)
+        {
+            static const uint16_t lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+            static const uint8_t lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+            static const uint16_t distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+                4097, 6145, 8193, 12289, 16385, 24577 };
+            static const uint8_t distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+            uint32_t l = 28;
+            while (lengthBase[l] > length)
+                l--;
+            PutSymbol(257 + l);
+            Put(length - lengthBase[l], lengthExtra[l]);
+
+            uint32_t d = 29;
+            while (distanceBase[d] > distance)
+                d--;
+            PutCode(d, 5);
+            Put(distance - distanceBase[d], distanceExtra[d]);
+        }
+    };
+
+    template<typename T>
+    void WriteLE(std::ofstream& file, T value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void WriteAttribute(std::ofstream& file, const char* name, const char* type, const void* data, int32_t size)
+    {
+        file.write(name, strlen(name) + 1);
+        file.write(type, strlen(type) + 1);
+        WriteLE(file, size);
+        file.write(static_cast<const char*>(data), size);
+    }
+}
+
+std::unique_ptr<ImageStreamWriter> ImageStreamWriter::Create(const std::string& path)
+{
+    std::string extension = path.substr(path.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+
+    if (extension == "png")
+        return std::make_unique<PngStreamWriter>();
+    if (extension == "exr")
+        return std::make_unique<ExrStreamWriter>();
+
+    return nullptr;
+}
+
+bool PngStreamWriter::Open(const std::string& path, uint32_t width, uint32_t height)
+{
+    m_File.open(path, std::ios::binary);
+    if (!m_File)
+        return false;
+
+    m_Width = width;
+    m_Height = height;
+    m_RowsWritten = 0;
+    m_Adler = 1;
+    m_BitBuffer = 0;
+    m_BitCount = 0;
+    m_PreviousRow.assign(static_cast<size_t>(width) * 4, 0);
+    m_Window.clear();
+
+    const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    m_File.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    uint8_t header[13];
+    WriteBE32(header, width);
+    WriteBE32(header + 4, height);
+    header[8] = 8;  // bit depth
+    header[9] = 6;  // RGBA
+    header[10] = 0; // deflate
+    header[11] = 0; // adaptive filtering
+    header[12] = 0; // no interlace
+    WriteChunk("IHDR", header, sizeof(header));
+
+    // zlib header : deflate with a 32K window, fast level hint
+    const uint8_t zlibHeader[2] = { 0x78, 0x5E };
+    WriteChunk("IDAT", zlibHeader, sizeof(zlibHeader));
+
+    return m_File.good();
+}
+
+bool PngStreamWriter::WriteRows(const uint8_t* rows, uint32_t rowCount)
+{
+    const size_t pixelBytes = static_cast<size_t>(m_Width) * 4;
+    const size_t windowSize = 32768;
+    const uint32_t maxChain = 16;
+
+    std::vector<uint8_t> filtered(pixelBytes);
+    std::vector<uint8_t> best(pixelBytes);
+
+    for (uint32_t r = 0; r < rowCount && m_RowsWritten < m_Height; r++, m_RowsWritten++)
+    {
+        const uint8_t* pixels = rows + r * pixelBytes;
+
+        // Adaptive filtering : the filter with the smallest sum of absolute signed bytes
+        uint8_t filter = 0;
+        uint64_t bestSum = ~0ull;
+        for (uint8_t candidate = 0; candidate < 5; candidate++)
+        {
+            FilterRow(candidate, pixels, m_PreviousRow.data(), pixelBytes, filtered.data());
+
+            uint64_t sum = 0;
+            for (uint8_t value : filtered)
+                sum += value < 128 ? value : 256 - value;
+
+            if (sum < bestSum)
+            {
+                bestSum = sum;
+                filter = candidate;
+                best.swap(filtered);
+            }
+        }
+        memcpy(m_PreviousRow.data(), pixels, pixelBytes);
+
+        // The window keeps the last 32K of the filtered stream, matches may reach into the previous rows
+        const size_t start = m_Window.size();
+        m_Window.push_back(filter);
+        m_Window.insert(m_Window.end(), best.begin(), best.end());
+
+        m_Adler = Adler32(m_Adler, m_Window.data() + start, m_Window.size() - start);
+
+        // One fixed Huffman block per row, LZ77 through hash chains of 3 bytes
+        std::vector<int32_t> head(1u << 15, -1);
+        std::vector<int32_t> previous(m_Window.size(), -1);
+        auto hash = [this](size_t i) { return ((m_Window[i] << 10) ^ (m_Window[i + 1] << 5) ^ m_Window[i + 2]) & 0x7FFFu; };
+        auto insert = [&](size_t i) {
+            if (i + 2 < m_Window.size())
+            {
+                uint32_t h = hash(i);
+                previous[i] = head[h];
+                head[h] = static_cast<int32_t>(i);
+            }
+        };
+
+        for (size_t i = 0; i < start; i++)
+            insert(i);
+
+        m_Chunk.clear();
+        DeflateBits bits{ m_Chunk, m_BitBuffer, m_BitCount };
+        bits.Put(0, 1);     // BFINAL = 0
+        bits.Put(1, 2);     // BTYPE = fixed Huffman
+
+        for (size_t i = start; i < m_Window.size();)
+        {
+            uint32_t matchLength = 0, matchDistance = 0;
+
+            if (i + 2 < m_Window.size())
+            {
+                const size_t maxLength = std::min<size_t>(258, m_Window.size() - i);
+                int32_t candidate = head[hash(i)];
+                for (uint32_t chain = 0; candidate >= 0 && i - candidate <= windowSize && chain < maxChain; chain++, candidate = previous[candidate])
+                {
+                    size_t length = 0;
+                    while (length < maxLength && m_Window[candidate + length] == m_Window[i + length])
+                        length++;
+
+                    if (length > matchLength)
+                    {
+                        matchLength = static_cast<uint32_t>(length);
+                        matchDistance = static_cast<uint32_t>(i - candidate);
+                        if (length == maxLength)
+                            break;
+                    }
+                }
+            }
+
+            if (matchLength >= 3)
+            {
+                bits.PutMatch(matchLength, matchDistance);
+                for (size_t k = 0; k < matchLength; k++)
+                    insert(i + k);
+                i += matchLength;
+            }
+            else
+            {
+                bits.PutSymbol(m_Window[i]);
+                insert(i);
+                i++;
+            }
+        }
+
+        bits.PutSymbol(256);
+
+        WriteChunk("IDAT", m_Chunk.data(), m_Chunk.size());
+
+        if (m_Window.size() > windowSize)
+            m_Window.erase(m_Window.begin(), m_Window.end() - windowSize);
+    }
+
+    return m_File.good();
+}
+
+bool PngStreamWriter::Close()
+{
+    if (m_RowsWritten != m_Height)
+        return false;
+
+    // Empty final block, byte alignment then the adler32 of the raw data
+    m_Chunk.clear();
+    DeflateBits bits{ m_Chunk, m_BitBuffer, m_BitCount };
+    bits.Put(1, 1);     // BFINAL = 1
+    bits.Put(1, 2);     // BTYPE = fixed Huffman
+    bits.PutSymbol(256);
+    if (m_BitCount > 0)
+        bits.Put(0, 8 - m_BitCount);
+
+    m_Chunk.resize(m_Chunk.size() + 4);
+    WriteBE32(m_Chunk.data() + m_Chunk.size() - 4, m_Adler);
+    WriteChunk("IDAT", m_Chunk.data(), m_Chunk.size());
+    WriteChunk("IEND", nullptr, 0);
+
+    m_File.close();
+
+    return !m_File.fail();
+}
+
+void PngStreamWriter::WriteChunk(const char type[4], const uint8_t* data, size_t size)
+{
+    uint8_t length[4];
+    WriteBE32(length, static_cast<uint32_t>(size));
+    m_File.write(reinterpret_cast<const char*>(length), 4);
+    m_File.write(type, 4);
+    if (size > 0)
+        m_File.write(reinterpret_cast<const char*>(data), size);
+
+    uint32_t crc = Crc32(0, reinterpret_cast<const uint8_t*>(type), 4);
+    crc = Crc32(crc, data, size);
+
+    uint8_t crcBytes[4];
+    WriteBE32(crcBytes, crc);
+    m_File.write(reinterpret_cast<const char*>(crcBytes), 4);
+}
+
+bool ExrStreamWriter::Open(const std::string& path, uint32_t width, uint32_t height)
+{
+    m_File.open(path, std::ios::binary);
+    if (!m_File)
+        return false;
+
+    m_Width = width;
+    m_Height = height;
+    m_RowsWritten = 0;
+    m_Scanline.resize(static_cast<size_t>(width) * 4);
+
+    // Magic number, version 2, single part scanline file
+    WriteLE<uint32_t>(m_File, 20000630u);
+    WriteLE<uint32_t>(m_File, 2u);
+
+    // Channels are stored in alphabetical order
+    std::vector<char> channels;
+    for (char name : { 'A', 'B', 'G', 'R' })
+    {
+        const int32_t pixelType = 2; // FLOAT
+        const int32_t sampling = 1;
+        channels.push_back(name);
+        channels.push_back('\0');
+        channels.insert(channels.end(), reinterpret_cast<const char*>(&pixelType), reinterpret_cast<const char*>(&pixelType) + 4);
+        channels.insert(channels.end(), 4, '\0'); // pLinear + reserved
+        channels.insert(channels.end(), reinterpret_cast<const char*>(&sampling), reinterpret_cast<const char*>(&sampling) + 4);
+        channels.insert(channels.end(), reinterpret_cast<const char*>(&sampling), reinterpret_cast<const char*>(&sampling) + 4);
+    }
+    channels.push_back('\0');
+
+    const uint8_t compression = 0; // NO_COMPRESSION
+    const int32_t window[4] = { 0, 0, static_cast<int32_t>(width) - 1, static_cast<int32_t>(height) - 1 };
+    const uint8_t lineOrder = 0;   // INCREASING_Y
+    const float pixelAspectRatio = 1.f;
+    const float screenWindowCenter[2] = { 0.f, 0.f };
+    const float screenWindowWidth = 1.f;
+
+    WriteAttribute(m_File, "channels", "chlist", channels.data(), static_cast<int32_t>(channels.size()));
+    WriteAttribute(m_File, "compression", "compression", &compression, sizeof(compression));
+    WriteAttribute(m_File, "dataWindow", "box2i", window, sizeof(window));
+    WriteAttribute(m_File, "displayWindow", "box2i", window, sizeof(window));
+    WriteAttribute(m_File, "lineOrder", "lineOrder", &lineOrder, sizeof(lineOrder));
+    WriteAttribute(m_File, "pixelAspectRatio", "float", &pixelAspectRatio, sizeof(pixelAspectRatio));
+    WriteAttribute(m_File, "screenWindowCenter", "v2f", screenWindowCenter, sizeof(screenWindowCenter));
+    WriteAttribute(m_File, "screenWindowWidth", "float", &screenWindowWidth, sizeof(screenWindowWidth));
+    m_File.put('\0');
+
+    // Scanline offset table : y, data size then the four channel rows
+    const uint64_t scanlineSize = 2 * sizeof(int32_t) + static_cast<uint64_t>(width) * 4 * sizeof(float);
+    const uint64_t firstScanline = static_cast<uint64_t>(m_File.tellp()) + static_cast<uint64_t>(height) * sizeof(uint64_t);
+
+    for (uint32_t y = 0; y < height; y++)
+        WriteLE<uint64_t>(m_File, firstScanline + y * scanlineSize);
+
+    return m_File.good();
+}
+
+bool ExrStreamWriter::WriteRows(const uint8_t* rows, uint32_t rowCount)
+{
+    const int32_t dataSize = static_cast<int32_t>(m_Width * 4 * sizeof(float));
+
+    for (uint32_t r = 0; r < rowCount && m_RowsWritten < m_Height; r++, m_RowsWritten++)
+    {
+        const float* pixels = reinterpret_cast<const float*>(rows) + static_cast<size_t>(r) * m_Width * 4;
+
+        // RGBA interleaved to A, B, G, R planes
+        for (uint32_t x = 0; x < m_Width; x++)
+        {
+            m_Scanline[x] = pixels[x * 4 + 3];
+            m_Scanline[m_Width + x] = pixels[x * 4 + 2];
+            m_Scanline[2 * m_Width + x] = pixels[x * 4 + 1];
+            m_Scanline[3 * m_Width + x] = pixels[x * 4 + 0];
+        }
+
+        WriteLE<int32_t>(m_File, static_cast<int32_t>(m_RowsWritten));
+        WriteLE<int32_t>(m_File, dataSize);
+        m_File.write(reinterpret_cast<const char*>(m_Scanline.data()), dataSize);
+    }
+
+    return m_File.good();
+}
+
+bool ExrStreamWriter::Close()
+{
+    if (m_RowsWritten != m_Height)
+        return false;
+
+    m_File.close();
+
+    return !m_File.fail();
+}
+
+int CountFrameConversions(const std::string& pattern)
+{
+    int count = 0;
+    for (size_t i = 0; i < pattern.size(); i++)
+    {
+        if (pattern[i] != '%')
+            continue;
+
+        if (++i < pattern.size() && pattern[i] == '%')
+            continue;
+
+        while (i < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[i])))
+            i++;
+
+        if (i >= pattern.size() || pattern[i] != 'd')
+            return -1;
+
+        count++;
+    }
+    return count;
+}
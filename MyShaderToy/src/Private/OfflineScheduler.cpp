@@ -0,0 +1,118 @@
+#include "OfflineScheduler.h"
+
+#include <algorithm>
+
+OfflineJobQueue::OfflineJobQueue(uint32_t jobCount, uint32_t deviceCount, uint32_t window)
+    : m_Deques(deviceCount), m_Window(window)
+{
+    // Interleaved so that every device works near the write head of the ordered output
+    for (uint32_t job = 0; job < jobCount; job++)
+        m_Deques[job % deviceCount].push_back(job);
+}
+
+bool OfflineJobQueue::Pop(uint32_t device, uint32_t& job, bool& stolen, const std::function<void()>& drain)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    bool drained = false;
+
+    while (!m_Aborted)
+    {
+        const uint64_t limit = m_Window > 0 ? static_cast<uint64_t>(m_WriteHead) + m_Window : UINT64_MAX;
+
+        std::deque<uint32_t>& own = m_Deques[device];
+        if (!own.empty() && own.front() < limit)
+        {
+            job = own.front();
+            own.pop_front();
+            stolen = false;
+            return true;
+        }
+
+        std::deque<uint32_t>* victim = nullptr;
+        std::deque<uint32_t>* earliest = nullptr;
+        for (std::deque<uint32_t>& deque : m_Deques)
+        {
+            if (deque.empty())
+                continue;
+            if (!victim || deque.size() > victim->size())
+                victim = &deque;
+            if (!earliest || deque.front() < earliest->front())
+                earliest = &deque;
+        }
+
+        if (!victim)
+            return false;
+
+        if (victim->back() < limit)
+        {
+            job = victim->back();
+            victim->pop_back();
+            stolen = true;
+            return true;
+        }
+
+        if (earliest->front() < limit)
+        {
+            job = earliest->front();
+            earliest->pop_front();
+            stolen = true;
+            return true;
+        }
+
+        // Every job left is past the window, the outputs this device still holds may be the write head
+        if (!drained && drain)
+        {
+            lock.unlock();
+            drain();
+            lock.lock();
+            drained = true;
+            continue;
+        }
+
+        m_Condition.wait(lock);
+    }
+
+    return false;
+}
+
+void OfflineJobQueue::SetWriteHead(uint32_t job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_WriteHead = std::max(m_WriteHead, job);
+    }
+    m_Condition.notify_all();
+}
+
+void OfflineJobQueue::Abort()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Aborted = true;
+    }
+    m_Condition.notify_all();
+}
+
+OrderedOutput::OrderedOutput(uint32_t firstIndex, WriteFunction write)
+    : m_Write(std::move(write)), m_NextIndex(firstIndex)
+{
+}
+
+void OrderedOutput::Push(uint32_t index, const void* data, size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    if (index != m_NextIndex)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        m_Pending.emplace(index, std::vector<uint8_t>(bytes, bytes + size));
+        m_MaxPending = std::max(m_MaxPending, m_Pending.size());
+        return;
+    }
+
+    m_Success &= m_Write(m_NextIndex++, data);
+
+    for (auto it = m_Pending.begin(); it != m_Pending.end() && it->first == m_NextIndex; it = m_Pending.erase(it))
+        m_Success &= m_Write(m_NextIndex++, it->second.data());
+}
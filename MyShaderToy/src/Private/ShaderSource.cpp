@@ -0,0 +1,490 @@
+#include "ShaderSource.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <vector>
+#include <windows.h>
+
+// Generated once, shared by every composed source
+static const std::string& GetFragmentPreamble()
+{
+    static const std::string preamble = R"(#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+#extension GL_GOOGLE_cpp_style_line_directive : require
+
+layout(location = 0) out vec4 outColor;
+
+layout(push_constant) uniform PushConstants {
+    vec3 iResolution;
+    float padding0;
+    uvec4 iChannels;
+    vec2 iFragCoordOffset;
+    vec2 padding1;
+};
+
+layout(std140, set = 1, binding = 0) uniform ShaderInputs {
+    float iTime;
+    float iTimeDelta;
+    float iFrameRate;
+    uint iFrame;
+    vec4 iMouse;
+    vec4 iDate;
+    float iChannelTime[4];
+    vec3 iChannelResolution[4];
+    float iSampleRate;
+    vec4 iUserParams[8];
+};
+
+// Bindless channel table, iChannels holds the slot of each channel
+layout(set = 0, binding = 0) uniform texture2D iTextures2D[];
+layout(set = 0, binding = 1) uniform textureCube iTexturesCube[];
+layout(set = 0, binding = 2) uniform sampler iSamplers[];
+
+// Cube A, rendered by the cubemap pass
+#define iChannel0 samplerCube(iTexturesCube[iChannels.x], iSamplers[0])
+// Latest simulation state (Shader/Compute/Sim0.comp or Shader/Frag/Sim0.frag)
+#define iChannel1 sampler2D(iTextures2D[iChannels.y], iSamplers[0])
+
+void mainImage(out vec4 fragColor, in vec2 fragCoord);
+
+void main() {
+    // iFragCoordOffset places the tile inside the full image in poster mode
+    vec2 pixel = gl_FragCoord.xy + iFragCoordOffset;
+    vec2 fragCoord = vec2(pixel.x, iResolution.y-pixel.y);
+
+    vec4 fragColor = vec4(0.);
+
+    mainImage(fragColor, fragCoord);
+
+    outColor = fragColor;
+}
+)";
+
+    return preamble;
+}
+
+bool IsCompleteShaderSource(const std::string& source)
+{
+    return source.find("#version") != std::string::npos;
+}
+
+std::string ComposeFragmentSource(const std::string& source, const std::string& name)
+{
+    if (IsCompleteShaderSource(source))
+        return source;
+
+    std::string composed;
+    composed.reserve(GetFragmentPreamble().size() + name.size() + source.size() + 16);
+    composed += GetFragmentPreamble();
+    composed += "#line 1 \"" + name + "\"\n";
+    composed += source;
+    composed += '\n';
+
+    return composed;
+}
+
+static std::string ReadPipe(HANDLE pipe)
+{
+    std::string data;
+    char buffer[4096];
+    DWORD read = 0;
+    while (ReadFile(pipe, buffer, sizeof(buffer), &read, nullptr) && read > 0)
+        data.append(buffer, read);
+    return data;
+}
+
+// glslc or spirv-opt stuck on a source is killed after this delay
+static constexpr DWORD PIPED_PROCESS_TIMEOUT_MS = 30000;
+
+// command : the executable reads input on stdin and writes output on stdout
+static bool RunPipedProcess(std::wstring command, const std::string& input, std::string& output, std::string& errors)
+{
+    SECURITY_ATTRIBUTES security = { sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+
+    // [0] : child end, [1] : our end
+    HANDLE in[2] = {}, out[2] = {}, error[2] = {};
+    if (!CreatePipe(&in[0], &in[1], &security, 0)
+        || !CreatePipe(&out[1], &out[0], &security, 0)
+        || !CreatePipe(&error[1], &error[0], &security, 0))
+    {
+        for (HANDLE handle : { in[0], in[1], out[0], out[1], error[0], error[1] })
+            if (handle)
+                CloseHandle(handle);
+        return false;
+    }
+
+    SetHandleInformation(in[1], HANDLE_FLAG_INHERIT, 0);
+    SetHandleInformation(out[1], HANDLE_FLAG_INHERIT, 0);
+    SetHandleInformation(error[1], HANDLE_FLAG_INHERIT, 0);
+
+    // Only the child ends are inherited : batch compilations run on several threads,
+    // a pipe leaked into another child would stay open until that one exits
+    HANDLE inherited[3] = { in[0], out[0], error[0] };
+
+    SIZE_T attributeSize = 0;
+    InitializeProcThreadAttributeList(nullptr, 1, 0, &attributeSize);
+    std::vector<char> attributes(attributeSize);
+
+    STARTUPINFOEXW startupInfo = {};
+    startupInfo.StartupInfo.cb = sizeof(STARTUPINFOEXW);
+    startupInfo.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
+    startupInfo.StartupInfo.hStdInput = in[0];
+    startupInfo.StartupInfo.hStdOutput = out[0];
+    startupInfo.StartupInfo.hStdError = error[0];
+    startupInfo.lpAttributeList = reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(attributes.data());
+
+    BOOL created = InitializeProcThreadAttributeList(startupInfo.lpAttributeList, 1, 0, &attributeSize)
+        && UpdateProcThreadAttribute(startupInfo.lpAttributeList, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST, inherited, sizeof(inherited), nullptr, nullptr);
+
+    PROCESS_INFORMATION pi = {};
+    if (created)
+    {
+        created = CreateProcessW(nullptr, &command[0], nullptr, nullptr, TRUE, CREATE_NO_WINDOW | EXTENDED_STARTUPINFO_PRESENT,
+            nullptr, nullptr, &startupInfo.StartupInfo, &pi);
+        DeleteProcThreadAttributeList(startupInfo.lpAttributeList);
+    }
+
+    CloseHandle(in[0]);
+    CloseHandle(out[0]);
+    CloseHandle(error[0]);
+
+    if (!created)
+    {
+        CloseHandle(in[1]);
+        CloseHandle(out[1]);
+        CloseHandle(error[1]);
+        errors = "Can't start " + std::string(command.begin(), command.begin() + command.find(L' ')) + " !";
+        return false;
+    }
+
+    // Every pipe is served on its own thread, a full stderr pipe would block the child before it closes stdout,
+    // and only the process wait has a timeout : the pipes of a terminated child are closed, which ends the reads
+    std::future<std::string> diagnostics = std::async(std::launch::async, ReadPipe, error[1]);
+    std::future<std::string> result = std::async(std::launch::async, ReadPipe, out[1]);
+    std::future<void> feed = std::async(std::launch::async, [&input, pipe = in[1]]() {
+        DWORD written = 0;
+        WriteFile(pipe, input.data(), static_cast<DWORD>(input.size()), &written, nullptr);
+        CloseHandle(pipe);
+    });
+
+    const bool timedOut = WaitForSingleObject(pi.hProcess, PIPED_PROCESS_TIMEOUT_MS) == WAIT_TIMEOUT;
+    if (timedOut)
+    {
+        TerminateProcess(pi.hProcess, 1);
+        WaitForSingleObject(pi.hProcess, INFINITE);
+    }
+
+    feed.get();
+    output = result.get();
+    CloseHandle(out[1]);
+    errors = diagnostics.get();
+    CloseHandle(error[1]);
+
+    if (timedOut)
+        errors += std::string(command.begin(), command.begin() + command.find(L' ')) + " timed out !";
+
+    DWORD exitCode = 1;
+    GetExitCodeProcess(pi.hProcess, &exitCode);
+
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+
+    return exitCode == 0;
+}
+
+bool CompileGlsl(const std::string& source, const std::string& stage, const std::string& flags, std::string& spirv, std::string& errors)
+{
+    std::wstring command = L".\\glslc.exe -fshader-stage=" + std::wstring(stage.begin(), stage.end())
+        + L" " + std::wstring(flags.begin(), flags.end()) + L" - -o -";
+
+    return RunPipedProcess(command, source, spirv, errors) && !spirv.empty() && spirv.size() % 4 == 0;
+}
+
+bool OptimizeSpirv(std::string& spirv, const std::string& passes, std::string& errors)
+{
+    std::wstring command = L".\\spirv-opt.exe " + std::wstring(passes.begin(), passes.end()) + L" - -o -";
+
+    std::string optimized;
+    if (!RunPipedProcess(command, spirv, optimized, errors) || optimized.empty() || optimized.size() % 4 != 0)
+        return false;
+
+    spirv = std::move(optimized);
+    return true;
+}
+
+int32_t FindSpirvRecipe(const std::string& name)
+{
+    for (uint32_t i = 0; i < SPIRV_RECIPE_COUNT; i++)
+        if (name == SPIRV_RECIPES[i].Name)
+            return static_cast<int32_t>(i);
+    return -1;
+}
+
+std::vector<SpecConstant> ReflectSpecConstants(const std::string& spirv)
+{
+    std::vector<SpecConstant> constants;
+
+    const uint32_t* words = reinterpret_cast<const uint32_t*>(spirv.data());
+    const size_t wordCount = spirv.size() / sizeof(uint32_t);
+    if (wordCount < 5 || words[0] != 0x07230203u)
+        return constants;
+
+    // Names and decorations come before the types, the types before the constants
+    std::map<uint32_t, std::string> names;
+    std::map<uint32_t, uint32_t> specIds;
+    std::map<uint32_t, SpecConstantType> types;
+
+    for (size_t i = 5; i < wordCount;)
+    {
+        const uint32_t opcode = words[i] & 0xFFFFu;
+        const uint32_t length = words[i] >> 16;
+        if (length == 0 || i + length > wordCount)
+            break;
+
+        const uint32_t* operands = words + i + 1;
+
+        switch (opcode)
+        {
+        case 5:     // OpName
+            if (length >= 3)
+            {
+                const char* name = reinterpret_cast<const char*>(operands + 1);
+                names[operands[0]] = std::string(name, strnlen(name, (length - 2) * sizeof(uint32_t)));
+            }
+            break;
+        case 71:    // OpDecorate, SpecId
+            if (length >= 4 && operands[1] == 1)
+                specIds[operands[0]] = operands[2];
+            break;
+        case 20:    // OpTypeBool
+            types[operands[0]] = SpecConstantType::Bool;
+            break;
+        case 21:    // OpTypeInt
+            if (length >= 4 && operands[1] == 32)
+                types[operands[0]] = operands[2] ? SpecConstantType::Int : SpecConstantType::UInt;
+            break;
+        case 22:    // OpTypeFloat
+            if (length >= 3 && operands[1] == 32)
+                types[operands[0]] = SpecConstantType::Float;
+            break;
+        case 48:    // OpSpecConstantTrue
+        case 49:    // OpSpecConstantFalse
+        case 50:    // OpSpecConstant
+        {
+            auto type = types.find(operands[0]);
+            auto specId = specIds.find(operands[1]);
+            if (length < 3 || type == types.end() || specId == specIds.end())
+                break;
+
+            SpecConstant constant;
+            constant.Id = specId->second;
+            constant.Type = type->second;
+            constant.Default = opcode == 48 ? 1u : opcode == 50 && length >= 4 ? operands[2] : 0u;
+            constant.Value = constant.Default;
+
+            auto name = names.find(operands[1]);
+            constant.Name = name != names.end() && !name->second.empty() ? name->second : "constant_id " + std::to_string(constant.Id);
+
+            constants.push_back(constant);
+            break;
+        }
+        default:
+            break;
+        }
+
+        i += length;
+    }
+
+    std::sort(constants.begin(), constants.end(), [](const SpecConstant& a, const SpecConstant& b) { return a.Id < b.Id; });
+
+    return constants;
+}
+
+// FNV-1a 64
+static uint64_t HashText(const std::string& text)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : text)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static bool ReadText(const std::filesystem::path& path, std::string& text)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    std::stringstream stream;
+    stream << file.rdbuf();
+    text = stream.str();
+
+    return true;
+}
+
+// Position of the first code character of line, npos for a blank or comment line, blockComment carries /* */ to the next line
+static size_t FindCode(const std::string& line, bool& blockComment)
+{
+    size_t code = std::string::npos;
+    for (size_t i = 0; i < line.size(); i++)
+    {
+        if (blockComment)
+        {
+            if (line.compare(i, 2, "*/") == 0)
+            {
+                blockComment = false;
+                i++;
+            }
+        }
+        else if (line.compare(i, 2, "/*") == 0)
+        {
+            blockComment = true;
+            i++;
+        }
+        else if (line.compare(i, 2, "//") == 0)
+        {
+            break;
+        }
+        else if (code == std::string::npos && line[i] != ' ' && line[i] != '\t')
+        {
+            code = i;
+        }
+    }
+    return code;
+}
+
+std::string NormalizeShaderPath(const std::filesystem::path& path)
+{
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::absolute(path, error);
+    return (error ? path : absolute).lexically_normal().string();
+}
+
+bool ShaderCompiler::ExpandIncludes(const std::filesystem::path& path, std::string& source, std::vector<std::string>& dependencies, std::string& errors)
+{
+    std::string text;
+    if (!ReadText(path, text))
+    {
+        errors += "Can't open " + path.string() + " !\n";
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_FileHashes[NormalizeShaderPath(path)] = HashText(text);
+    }
+
+    dependencies.push_back(NormalizeShaderPath(path));
+
+    const std::string name = path.filename().string();
+
+    std::istringstream lines(text);
+    std::string line;
+    uint32_t lineNumber = 0;
+    bool blockComment = false;
+    bool success = true;
+
+    while (std::getline(lines, line))
+    {
+        lineNumber++;
+
+        // A commented out #include stays a comment
+        size_t directive = FindCode(line, blockComment);
+        if (directive == std::string::npos || line.compare(directive, 8, "#include") != 0)
+        {
+            source += line;
+            source += '\n';
+            continue;
+        }
+
+        size_t open = line.find('"', directive);
+        size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+        if (close == std::string::npos)
+        {
+            errors += name + ":" + std::to_string(lineNumber) + ": error: #include expects \"file\"\n";
+            success = false;
+            source += '\n';
+            continue;
+        }
+
+        std::filesystem::path include = path.parent_path() / line.substr(open + 1, close - open - 1);
+
+        // Each file once, whatever the relative path reaching it : shared libraries included by several files, include cycles
+        if (std::find(dependencies.begin(), dependencies.end(), NormalizeShaderPath(include)) == dependencies.end())
+        {
+            source += "#line 1 \"" + include.filename().string() + "\"\n";
+            success &= ExpandIncludes(include, source, dependencies, errors);
+        }
+
+        source += "#line " + std::to_string(lineNumber + 1) + " \"" + name + "\"\n";
+    }
+
+    return success;
+}
+
+bool ShaderCompiler::Compile(const std::string& path, const std::string& stage, uint32_t recipe, std::string& spirv, std::vector<std::string>& dependencies, std::string& errors)
+{
+    const SpirvRecipe& spirvRecipe = SPIRV_RECIPES[std::min(recipe, SPIRV_RECIPE_COUNT - 1)];
+
+    std::string source;
+    if (!ExpandIncludes(path, source, dependencies, errors))
+        return false;
+
+    const std::string name = std::filesystem::path(path).filename().string();
+
+    if (stage == "frag")
+        source = ComposeFragmentSource(source, name);
+
+    // Named #line directives of an included file need the extension right after #version
+    size_t version = source.find("#version");
+    if (dependencies.size() > 1 && version != std::string::npos && source.find("GL_GOOGLE_cpp_style_line_directive") == std::string::npos)
+    {
+        size_t lineEnd = source.find('\n', version);
+        if (lineEnd != std::string::npos)
+        {
+            uint32_t nextLine = static_cast<uint32_t>(std::count(source.begin(), source.begin() + lineEnd, '\n')) + 2;
+            source.insert(lineEnd + 1, "#extension GL_GOOGLE_cpp_style_line_directive : require\n#line " + std::to_string(nextLine) + " \"" + name + "\"\n");
+        }
+    }
+
+    const std::string key = NormalizeShaderPath(path) + '\n' + stage + '\n' + spirvRecipe.Name;
+    const uint64_t sourceHash = HashText(source);
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto cached = m_Spirv.find(key);
+        if (cached != m_Spirv.end() && cached->second.SourceHash == sourceHash)
+        {
+            spirv = cached->second.Spirv;
+            return true;
+        }
+    }
+
+    if (!CompileGlsl(source, stage, spirvRecipe.GlslcFlags, spirv, errors))
+        return false;
+
+    if (spirvRecipe.OptimizerPasses && !OptimizeSpirv(spirv, spirvRecipe.OptimizerPasses, errors))
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Spirv[key] = { sourceHash, spirv };
+
+    return true;
+}
+
+bool ShaderCompiler::HasChanged(const std::string& path)
+{
+    std::string text;
+    if (!ReadText(path, text))
+        return true;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto hash = m_FileHashes.find(NormalizeShaderPath(path));
+    return hash == m_FileHashes.end() || hash->second != HashText(text);
+}
@@ -0,0 +1,116 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+// Worker of the pool running on this thread, Push keeps its tasks local
+static thread_local const ThreadPool* t_WorkerPool = nullptr;
+static thread_local uint32_t t_WorkerIndex = 0;
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    m_Queues.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++)
+        m_Queues.push_back(std::make_unique<WorkerQueue>());
+
+    m_Threads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++)
+        m_Threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_Condition.notify_all();
+
+    // Queued tasks are still run, their futures are never left broken
+    for (std::thread& thread : m_Threads)
+        thread.join();
+}
+
+void ThreadPool::Push(std::function<void()> task)
+{
+    const uint32_t queueCount = static_cast<uint32_t>(m_Queues.size());
+    const bool spawned = t_WorkerPool == this;
+    uint32_t index = spawned ? t_WorkerIndex : m_NextQueue++ % queueCount;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Queues[index]->Mutex);
+        (spawned ? m_Queues[index]->Spawned : m_Queues[index]->Submitted).push_back(std::move(task));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_PendingCount++;
+    }
+    m_Condition.notify_one();
+}
+
+std::function<void()> ThreadPool::TakeTask(uint32_t worker)
+{
+    const uint32_t queueCount = static_cast<uint32_t>(m_Queues.size());
+    for (uint32_t i = 0; i < queueCount; i++)
+    {
+        WorkerQueue& queue = *m_Queues[(worker + i) % queueCount];
+
+        std::lock_guard<std::mutex> lock(queue.Mutex);
+
+        std::function<void()> task;
+        if (i == 0 && !queue.Spawned.empty())
+        {
+            task = std::move(queue.Spawned.back());
+            queue.Spawned.pop_back();
+        }
+        else if (!queue.Submitted.empty())
+        {
+            task = std::move(queue.Submitted.front());
+            queue.Submitted.pop_front();
+        }
+        else if (!queue.Spawned.empty())
+        {
+            task = std::move(queue.Spawned.front());
+            queue.Spawned.pop_front();
+        }
+        else
+        {
+            continue;
+        }
+        return task;
+    }
+
+    return {};
+}
+
+void ThreadPool::WorkerLoop(uint32_t worker)
+{
+    t_WorkerPool = this;
+    t_WorkerIndex = worker;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Condition.wait(lock, [this]() { return m_Stopping || m_PendingCount > 0; });
+
+            if (m_PendingCount == 0)
+                return;
+
+            m_PendingCount--;
+        }
+
+        // Every claim matches one queued task, the scan only misses it while another worker is stealing
+        std::function<void()> task = TakeTask(worker);
+        while (!task)
+        {
+            std::this_thread::yield();
+            task = TakeTask(worker);
+        }
+
+        task();
+    }
+}
@@ -0,0 +1,148 @@
+#include "VideoStreamWriter.h"
+
+#include <cmath>
+#include <fcntl.h>
+#include <io.h>
+
+FILE* VideoStreamWriter::s_ReservedStdout = nullptr;
+
+VideoStreamWriter::~VideoStreamWriter()
+{
+    Close();
+}
+
+void VideoStreamWriter::ReserveStdout()
+{
+    if (s_ReservedStdout)
+        return;
+
+    fflush(stdout);
+
+    int videoFd = _dup(_fileno(stdout));
+    _dup2(_fileno(stderr), _fileno(stdout));
+
+    _setmode(videoFd, _O_BINARY);
+    s_ReservedStdout = _fdopen(videoFd, "wb");
+}
+
+bool VideoStreamWriter::Open(const std::string& target, VideoFormat format, uint32_t width, uint32_t height, double fps)
+{
+    if (target == "-")
+    {
+        ReserveStdout();
+        m_File = s_ReservedStdout;
+        m_OwnsFile = false;
+    }
+    else
+    {
+        // Named pipes (\\.\pipe\name) are opened like files, the encoder must already be listening
+        if (fopen_s(&m_File, target.c_str(), "wb") != 0)
+            m_File = nullptr;
+        m_OwnsFile = true;
+    }
+
+    if (!m_File)
+        return false;
+
+    // Frames are large, let fwrite go straight to the OS
+    setvbuf(m_File, nullptr, _IONBF, 0);
+
+    m_Format = format;
+    m_FrameSize = GetFrameSize(format, width, height);
+    m_FrameCount = 0;
+
+    if (format == VideoFormat::Yuv420 || format == VideoFormat::Yuv444)
+    {
+        // Frame rate as a fraction, exact for integer and 1/1000 rates
+        uint32_t numerator = static_cast<uint32_t>(std::lround(fps * 1000.));
+        uint32_t denominator = 1000;
+        if (numerator % 1000 == 0)
+        {
+            numerator /= 1000;
+            denominator = 1;
+        }
+
+        fprintf(m_File, "YUV4MPEG2 W%u H%u F%u:%u Ip A1:1 %s XCOLORRANGE=FULL\n", width, height, numerator, denominator,
+            format == VideoFormat::Yuv420 ? "C420jpeg" : "C444");
+    }
+
+    return ferror(m_File) == 0;
+}
+
+bool VideoStreamWriter::WriteFrame(const void* data)
+{
+    if (!m_File)
+        return false;
+
+    if (m_FrameCount == 0)
+        m_FirstFrameTime = std::chrono::steady_clock::now();
+
+    if (m_Format == VideoFormat::Yuv420 || m_Format == VideoFormat::Yuv444)
+        fputs("FRAME\n", m_File);
+
+    bool written = fwrite(data, 1, m_FrameSize, m_File) == m_FrameSize;
+    m_FrameCount++;
+
+    return written;
+}
+
+void VideoStreamWriter::Close()
+{
+    if (!m_File)
+        return;
+
+    fflush(m_File);
+
+    if (m_OwnsFile)
+        fclose(m_File);
+
+    m_File = nullptr;
+}
+
+float VideoStreamWriter::GetFramesPerSecond() const
+{
+    if (m_FrameCount < 2)
+        return 0.f;
+
+    float elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - m_FirstFrameTime).count();
+
+    return elapsed > 0.f ? (m_FrameCount - 1) / elapsed : 0.f;
+}
+
+size_t VideoStreamWriter::GetFrameSize(VideoFormat format, uint32_t width, uint32_t height)
+{
+    const size_t pixels = static_cast<size_t>(width) * height;
+
+    switch (format)
+    {
+    case VideoFormat::Rgba8:
+        return pixels * 4;
+    case VideoFormat::Rgba16:
+        return pixels * 8;
+    case VideoFormat::Yuv420:
+    case VideoFormat::Nv12:
+        return pixels + 2 * static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+    case VideoFormat::Yuv444:
+        return pixels * 3;
+    }
+
+    return 0;
+}
+
+bool VideoStreamWriter::ParseFormat(const std::string& name, VideoFormat& format)
+{
+    if (name == "rgba8")
+        format = VideoFormat::Rgba8;
+    else if (name == "rgba16")
+        format = VideoFormat::Rgba16;
+    else if (name == "yuv420")
+        format = VideoFormat::Yuv420;
+    else if (name == "yuv444")
+        format = VideoFormat::Yuv444;
+    else if (name == "nv12")
+        format = VideoFormat::Nv12;
+    else
+        return false;
+
+    return true;
+}
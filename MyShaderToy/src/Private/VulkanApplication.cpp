@@ -14,34 +14,128 @@ VulkanApplication::VulkanApplication(const std::string& ApplicationName, uint32_
 
     m_VulkanCore.GetQueues();
 
-    m_VulkanCore.CreateGraphicPipeline();
+    CreateResources(m_VulkanCore, width, height);
+}
+
+VulkanApplication::VulkanApplication(const std::string& ApplicationName, uint32_t ApplicationVersion,
+    const std::string& EngineName, uint32_t EngineVersion, const OfflineRenderSettings& settings)
+    : m_OfflineSettings(settings)
+{
+    // The batch mode runs on a single device
+    bool multiDevice = settings.DeviceCount != 1 && !settings.Batch.IsEnabled();
+
+    if (multiDevice)
+        m_VulkanCore.SetPhysicalDeviceIndex(0);
+
+    if (!m_VulkanCore.CreateDevice(ApplicationName, ApplicationVersion, EngineName, EngineVersion))
+        throw std::runtime_error("No eligible Vulkan device !");
+
+    // A poster can be larger than maxImageDimension2D, its render targets only hold one tile
+    bool poster = settings.TileSize.x > 0 && settings.TileSize.y > 0;
+    int width = static_cast<int>(poster ? std::min(settings.TileSize.x, settings.Width) : settings.Width);
+    int height = static_cast<int>(poster ? std::min(settings.TileSize.y, settings.Height) : settings.Height);
+
+    m_VulkanCore.GetQueues();
+    m_VulkanCore.SetImageShaderPath(settings.ShaderPath);
+    m_VulkanCore.SetSpirvRecipe(settings.SpirvRecipe);
+    CreateResources(m_VulkanCore, width, height);
+
+    if (!multiDevice)
+        return;
+
+    // Device 0 knows how many devices are eligible
+    uint32_t deviceCount = m_VulkanCore.GetEligibleDeviceCount();
+    if (settings.DeviceCount > 0)
+        deviceCount = std::min(deviceCount, settings.DeviceCount);
+
+    for (uint32_t i = 1; i < deviceCount; i++)
+    {
+        auto device = std::make_unique<VulkanCore>();
+        device->SetPhysicalDeviceIndex(static_cast<int32_t>(i));
+
+        if (!device->CreateDevice(ApplicationName, ApplicationVersion, EngineName, EngineVersion))
+            throw std::runtime_error("Vulkan device creation failed !");
+
+        device->GetQueues();
+        device->SetImageShaderPath(settings.ShaderPath);
+        device->SetSpirvRecipe(settings.SpirvRecipe);
+        CreateResources(*device, width, height);
+
+        m_ExtraDevices.push_back(std::move(device));
+    }
+}
+
+void VulkanApplication::CreateResources(VulkanCore& core, int width, int height)
+{
+    core.CreateGraphicPipeline();
+
+    core.CreateCommandPool();
+
+    core.CreateCommandBuffer();
+
+    core.CreateSyncObject();
+
+    core.CreateVmaAllocator();
 
-    m_VulkanCore.CreateCommandPool();
+    if (!m_OfflineSettings)
+    {
+        core.InitImGui();
+        core.StartShaderWatch();
+    }
 
-    m_VulkanCore.CreateCommandBuffer();
+    core.CreateUniformRing(m_OfflineSettings ? m_OfflineSettings->SubFrames : 1);
 
-    m_VulkanCore.CreateSyncObject();
+    core.CreateRenderTarget(width, height);
 
-    m_VulkanCore.CreateVmaAllocator();
+    core.CreateCubemapTarget(CUBEMAP_SIZE);
 
-    m_VulkanCore.InitImGui();
+    core.CreateSimulation(SimulationSettings());
 
-    m_VulkanCore.CreateRenderTarget(width, height);
+    core.CreateBindlessTable();
+
+    core.CreateTimestampQueries();
 }
 
-void VulkanApplication::run()
+int VulkanApplication::run()
 {
+    if (m_OfflineSettings)
+    {
+        bool success = false;
+        if (m_ExtraDevices.empty())
+        {
+            success = m_VulkanCore.RenderOffline(*m_OfflineSettings);
+        }
+        else
+        {
+            std::vector<VulkanCore*> devices = { &m_VulkanCore };
+            for (auto& device : m_ExtraDevices)
+                devices.push_back(device.get());
+
+            success = VulkanCore::RenderOffline(*m_OfflineSettings, devices);
+        }
+
+        // No message box : offline runs are scripted, the failure is the exit code
+        if (!success)
+            std::cerr << "Offline render failed !" << std::endl;
+        return success ? 0 : 1;
+    }
+
     while (!m_GlfwWindow.ShouldClose())
     {
         glfwPollEvents();
 
         m_VulkanCore.Draw();
     }
+
+    return 0;
 }
 
 VulkanApplication::~VulkanApplication()
 {
-    m_GlfwWindow.destroyWindow();
+    m_ExtraDevices.clear();
+
+    if (!m_OfflineSettings)
+        m_GlfwWindow.destroyWindow();
     GlfwWindow::terminateGlfw();
 }
 
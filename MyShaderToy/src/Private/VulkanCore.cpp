@@ -1,23 +1,57 @@
 ﻿#include "VulkanCore.h"
 
 #include <array>
+#include <bit>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <thread>
+#include <utility>
+
 void VulkanCore::SetWindow(GlfwWindow* window)
 {
     m_Window = window;
 }
 
-void VulkanCore::CreateDevice(const std::string& ApplicationName, uint32_t ApplicationVersion, const std::string& EngineName, uint32_t EngineVersion)
+// Low discrepancy sequence in [0, 1), index > 0
+static float Halton(uint32_t index, uint32_t base)
 {
-    if (!m_Window)
+    float result = 0.f;
+    float fraction = 1.f;
+    while (index > 0)
     {
-        debug_log("Window is not valid, cannot create VulkanInstance !");
-        return;
+        fraction /= static_cast<float>(base);
+        result += fraction * static_cast<float>(index % base);
+        index /= base;
     }
+    return result;
+}
+
+// Deterministic value in [0, 1) for offline jitter
+static float HashToUnitFloat(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return static_cast<float>(x >> 8) / 16777216.f;
+}
+
+bool VulkanCore::CreateDevice(const std::string& ApplicationName, uint32_t ApplicationVersion, const std::string& EngineName, uint32_t EngineVersion)
+{
+    // Without window the device is created headless, for the offline renderer
+    m_Offline = m_Window == nullptr;
 
     vkb::InstanceBuilder instance_builder;
+    instance_builder.set_headless(m_Offline);
     instance_builder.use_default_debug_messenger().
         set_app_name(ApplicationName.c_str()).
         set_app_version(ApplicationVersion).
@@ -54,26 +88,94 @@ void VulkanCore::CreateDevice(const std::string& ApplicationName, uint32_t Appli
 
     m_Inst_disp = m_Instance.make_table();
 
-    VK_CHECK(m_Window->createSurface(m_Instance.instance, m_Surface));
+    if (!m_Offline)
+        VK_CHECK(m_Window->createSurface(m_Instance.instance, m_Surface));
+
+    //vulkan 1.2 features
+    VkPhysicalDeviceVulkan12Features features12{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+    features12.timelineSemaphore = true;
+    // Bindless channel table
+    features12.runtimeDescriptorArray = true;
+    features12.descriptorBindingPartiallyBound = true;
+    features12.descriptorBindingSampledImageUpdateAfterBind = true;
+    features12.descriptorBindingUpdateUnusedWhilePending = true;
 
     //vulkan 1.3 features
     VkPhysicalDeviceVulkan13Features features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES };
     features.dynamicRendering = true;
     features.synchronization2 = true;
 
+    //vulkan 1.0 features
+    VkPhysicalDeviceFeatures features10{};
+    features10.fragmentStoresAndAtomics = true; // SSBO writes from the fragment simulation backend
+
+    //vulkan 1.1 features
+    VkPhysicalDeviceVulkan11Features features11{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES };
+    features11.multiview = true;
+
     vkb::PhysicalDeviceSelector phys_device_selector(m_Instance);
-    auto phys_device_ret = phys_device_selector.set_surface(m_Surface)
-        .set_minimum_version(1, 3)
-        .set_required_features_13(features)
-        .add_required_extensions(deviceExtensions)
-        .require_dedicated_transfer_queue()
-        .select();
-    if (!phys_device_ret) {
-        debug_log(phys_device_ret.error().message());
+    phys_device_selector.set_minimum_version(1, 3)
+        .set_required_features(features10)
+        .set_required_features_11(features11)
+        .set_required_features_12(features12)
+        .set_required_features_13(features);
+
+    // Software ICDs usually expose a single queue family, offline transfers then share the graphics queue
+    if (m_Offline)
+        phys_device_selector.require_present(false);
+    else
+        phys_device_selector.set_surface(m_Surface).add_required_extensions(deviceExtensions).require_dedicated_transfer_queue();
+
+    vkb::PhysicalDevice physical_device;
+
+    if (m_PhysicalDeviceIndex >= 0)
+    {
+        // Every eligible device, in the selector preference order
+        auto devices_ret = phys_device_selector.select_devices();
+        if (!devices_ret || static_cast<size_t>(m_PhysicalDeviceIndex) >= devices_ret.value().size()) {
+            debug_log("No eligible physical device " << m_PhysicalDeviceIndex << " !");
+            return false;
+        }
+        m_EligibleDeviceCount = static_cast<uint32_t>(devices_ret.value().size());
+        physical_device = devices_ret.value()[m_PhysicalDeviceIndex];
+    }
+    else
+    {
+        auto phys_device_ret = phys_device_selector.select();
+        if (!phys_device_ret) {
+            debug_log(phys_device_ret.error().message());
+        }
+        physical_device = phys_device_ret.value();
     }
-    vkb::PhysicalDevice physical_device = phys_device_ret.value();
 
-    bool extensionRes = physical_device.enable_extensions_if_present(deviceExtensions);
+    if (!m_Offline)
+        physical_device.enable_extensions_if_present(deviceExtensions);
+
+    // Optional : fast linked image pipelines, monolithic creation otherwise
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibraryFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT };
+    pipelineLibraryFeatures.graphicsPipelineLibrary = VK_TRUE;
+
+    m_PipelineLibrary = physical_device.is_extension_present(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME)
+        && physical_device.is_extension_present(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)
+        && physical_device.enable_extension_features_if_present(pipelineLibraryFeatures);
+
+    if (m_PipelineLibrary)
+        physical_device.enable_extensions_if_present({ VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME });
+    else
+        debug_log("VK_EXT_graphics_pipeline_library unavailable, image pipelines are created whole");
+
+    // Optional : pipeline free image pass, selected by default when present
+    VkPhysicalDeviceShaderObjectFeaturesEXT shaderObjectFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT };
+    shaderObjectFeatures.shaderObject = VK_TRUE;
+
+    m_ShaderObjectSupported = physical_device.is_extension_present(VK_EXT_SHADER_OBJECT_EXTENSION_NAME)
+        && physical_device.enable_extension_features_if_present(shaderObjectFeatures);
+
+    if (m_ShaderObjectSupported)
+        physical_device.enable_extension_if_present(VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+
+    // Offline renders record the pipelines, the accumulation needs the blending one
+    m_UseShaderObjects = m_ShaderObjectSupported && !m_Offline;
 
     vkb::DeviceBuilder device_builder{ physical_device };
     auto device_ret = device_builder.build();
@@ -83,6 +185,13 @@ void VulkanCore::CreateDevice(const std::string& ApplicationName, uint32_t Appli
     m_Device = device_ret.value();
 
     m_Disp = m_Device.make_table();
+
+    return true;
+}
+
+void VulkanCore::SetPhysicalDeviceIndex(int32_t index)
+{
+    m_PhysicalDeviceIndex = index;
 }
 
 void VulkanCore::CreateSwapChain()
@@ -130,18 +239,37 @@ void VulkanCore::GetQueues()
     }
     m_GraphicsQueue = gq.value();
 
-    auto pq = m_Device.get_queue(vkb::QueueType::present);
-    if (!pq.has_value()) {
-        debug_log("failed to get present queue: " << pq.error().message());
+    if (!m_Offline)
+    {
+        auto pq = m_Device.get_queue(vkb::QueueType::present);
+        if (!pq.has_value()) {
+            debug_log("failed to get present queue: " << pq.error().message());
+        }
+        m_PresentQueue = pq.value();
     }
-    m_PresentQueue = pq.value();
 
     auto tq = m_Device.get_dedicated_queue(vkb::QueueType::transfer);
-    if (!tq.has_value()) {
-        debug_log("Failed to get dedicated transfer queue: " << pq.error().message());
+    if (tq.has_value()) {
+        m_TranferQueue = tq.value();
+        m_TransferQueueFamily = m_Device.get_dedicated_queue_index(vkb::QueueType::transfer).value();
+    }
+    else if (m_Offline) {
+        m_TranferQueue = m_GraphicsQueue;
+        m_TransferQueueFamily = m_Device.get_queue_index(vkb::QueueType::graphics).value();
+    }
+    else {
+        debug_log("Failed to get dedicated transfer queue: " << tq.error().message());
+    }
 
+    // A compute family without graphics lets the simulation overlap with the graphics queue
+    auto cq = m_Device.get_queue(vkb::QueueType::compute);
+    if (cq.has_value()) {
+        m_ComputeQueue = cq.value();
+        m_ComputeQueueFamily = m_Device.get_queue_index(vkb::QueueType::compute).value();
+    }
+    else {
+        debug_log("No separate compute queue, async compute disabled: " << cq.error().message());
     }
-    m_TranferQueue = tq.value();
 }
 
 void VulkanCore::CreateCommandPool()
@@ -153,10 +281,18 @@ void VulkanCore::CreateCommandPool()
 
     VK_CHECK(m_Disp.createCommandPool(&poolInfo, nullptr, &m_GraphicPool));
 
-    poolInfo.queueFamilyIndex = m_Device.get_dedicated_queue_index(vkb::QueueType::transfer).value();;
+    poolInfo.queueFamilyIndex = m_TransferQueueFamily;
     poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 
     VK_CHECK(m_Disp.createCommandPool(&poolInfo, nullptr, &m_TransferPool));
+
+    if (m_ComputeQueue != VK_NULL_HANDLE)
+    {
+        poolInfo.queueFamilyIndex = m_ComputeQueueFamily;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+        VK_CHECK(m_Disp.createCommandPool(&poolInfo, nullptr, &m_ComputePool));
+    }
 }
 
 void VulkanCore::CreateVmaAllocator()
@@ -171,60 +307,668 @@ void VulkanCore::CreateVmaAllocator()
     VK_CHECK(vmaCreateAllocator(&allocatorCreateInfo, &m_Allocator)); 
 }
 
-void VulkanCore::CompileShader(const std::string& spv_path)
+VkShaderModule VulkanCore::createModuleFromCode(std::span<const uint32_t> code)
+{
+    VkShaderModuleCreateInfo create_info = {};
+    create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    create_info.codeSize = code.size_bytes();
+    create_info.pCode = code.data();
+
+    VkShaderModule shaderModule;
+    VK_CHECK(m_Disp.createShaderModule(&create_info, nullptr, &shaderModule));
+
+    return shaderModule;
+}
+
+VkShaderModule VulkanCore::createModuleFromCode(const std::string& spirv)
+{
+    return createModuleFromCode(std::span(reinterpret_cast<const uint32_t*>(spirv.data()), spirv.size() / sizeof(uint32_t)));
+}
+
+void VulkanCore::CreateBuiltinModules()
+{
+    for (uint32_t i = 0; i < BUILTIN_SHADER_COUNT; i++)
+        m_BuiltinModules[i] = createModuleFromCode(GetBuiltinShaderCode(static_cast<BuiltinShader>(i)));
+}
+
+VkShaderModule VulkanCore::CompileShaderModule(const std::string& path, const std::string& stage, uint32_t recipe, std::vector<std::string>& dependencies,
+    std::vector<SpecConstant>* specConstants, std::string* spirvCode)
+{
+    std::string spirv, errors;
+    bool compiled = m_ShaderCompiler.Compile(path, stage, recipe, spirv, dependencies, errors);
+
+    if (!errors.empty())
+        debug_log(errors);
+
+    if (compiled && specConstants)
+        *specConstants = ReflectSpecConstants(spirv);
+
+    if (compiled && spirvCode)
+        *spirvCode = spirv;
+
+    return compiled ? createModuleFromCode(spirv) : VK_NULL_HANDLE;
+}
+
+void VulkanCore::CreateGraphicPipeline()
 {
-    std::string shaderName = spv_path.substr(spv_path.find_last_of("\\"));
+    // Shared by every pipeline, rebuilding a specialization variant then skips most of the driver compilation
+    if (m_PipelineCache == VK_NULL_HANDLE)
+    {
+        VkPipelineCacheCreateInfo pipelineCacheCreateInfo{};
+        pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+        VK_CHECK(m_Disp.createPipelineCache(&pipelineCacheCreateInfo, nullptr, &m_PipelineCache));
+    }
 
-    std::string command = ".\\glslc.exe " + spv_path + " -o " + ".\\Shader\\Compiled_SPV\\" + shaderName + ".spv";
-    std::wstring wide_command(command.begin(), command.end());
+    if (m_BuiltinModules[BUILTIN_SHADER_FULLSCREEN_VERTEX] == VK_NULL_HANDLE)
+        CreateBuiltinModules();
 
-    CompileShaderCommand(command);
+    if (!m_CompilePool)
+        m_CompilePool = std::make_unique<ThreadPool>();
+
+    if (m_GraphicPipelineLayout == VK_NULL_HANDLE)
+    {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(PushConstants);
+
+        // set 1 : ShaderInputs uniform ring, shared with the simulation layout
+        VkDescriptorSetLayoutBinding inputsBinding{};
+        inputsBinding.binding = 0;
+        inputsBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        inputsBinding.descriptorCount = 1;
+        inputsBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkDescriptorSetLayoutCreateInfo inputsLayoutCreateInfo{};
+        inputsLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        inputsLayoutCreateInfo.bindingCount = 1;
+        inputsLayoutCreateInfo.pBindings = &inputsBinding;
+
+        VK_CHECK(m_Disp.createDescriptorSetLayout(&inputsLayoutCreateInfo, nullptr, &m_FrameSetLayout));
+
+        // set 0 : bindless channel table (binding 0 = 2D images, 1 = cube images, 2 = samplers, 3 = simulation buffer)
+        std::array<VkDescriptorSetLayoutBinding, 4> channelBindings{};
+        channelBindings[0].binding = 0;
+        channelBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        channelBindings[0].descriptorCount = BINDLESS_IMAGE_COUNT;
+        channelBindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        channelBindings[1].binding = 1;
+        channelBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        channelBindings[1].descriptorCount = BINDLESS_IMAGE_COUNT;
+        channelBindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        channelBindings[2].binding = 2;
+        channelBindings[2].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+        channelBindings[2].descriptorCount = BINDLESS_SAMPLER_COUNT;
+        channelBindings[2].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        channelBindings[3].binding = 3;
+        channelBindings[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        channelBindings[3].descriptorCount = 1;
+        channelBindings[3].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        // Unused slots may stay empty and slots not used by pending frames can be rewritten at any time
+        const VkDescriptorBindingFlags bindlessFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+            | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+            | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+        std::array<VkDescriptorBindingFlags, 4> bindingFlags = { bindlessFlags, bindlessFlags, bindlessFlags, 0 };
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo{};
+        bindingFlagsCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        bindingFlagsCreateInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+        bindingFlagsCreateInfo.pBindingFlags = bindingFlags.data();
+
+        VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo{};
+        setLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        setLayoutCreateInfo.pNext = &bindingFlagsCreateInfo;
+        setLayoutCreateInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        setLayoutCreateInfo.bindingCount = static_cast<uint32_t>(channelBindings.size());
+        setLayoutCreateInfo.pBindings = channelBindings.data();
+
+        VK_CHECK(m_Disp.createDescriptorSetLayout(&setLayoutCreateInfo, nullptr, &m_BindlessSetLayout));
+
+        std::array<VkDescriptorSetLayout, 2> setLayouts = { m_BindlessSetLayout, m_FrameSetLayout };
+
+        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo;
+        pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutCreateInfo.pNext = NULL;
+        pipelineLayoutCreateInfo.flags = 0;
+        pipelineLayoutCreateInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+        pipelineLayoutCreateInfo.pSetLayouts = setLayouts.data();
+        pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+        pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+
+        VK_CHECK(m_Disp.createPipelineLayout(&pipelineLayoutCreateInfo, NULL, &m_GraphicPipelineLayout));
+    }
+
+    // The image pass parts that only depend on the vertex shader
+    if (m_PipelineLibrary && m_ImageLibraries[IMAGE_LIBRARY_VERTEX_INPUT] == VK_NULL_HANDLE)
+        CreateImageLibraries();
+
+    if (m_ShaderObjectSupported && m_ImageVertexShader == VK_NULL_HANDLE)
+        m_ImageVertexShader = CreateImageShader(VK_SHADER_STAGE_VERTEX_BIT, GetBuiltinShaderCode(BUILTIN_SHADER_FULLSCREEN_VERTEX), nullptr);
+
+    CreatePassPipelines(CompileShaderPasses(SHADER_PASS_IMAGE | SHADER_PASS_CUBEMAP, m_SpirvRecipe, m_SimSettings.WorkgroupSize));
 }
 
-VkShaderModule VulkanCore::createModule(const std::string& spv_path)
+ShaderPassModules VulkanCore::CompileShaderPasses(uint32_t passes, uint32_t recipe, glm::uvec2 workgroupSize)
 {
-    std::ifstream file(spv_path, std::ios::binary);
+    auto startTime = std::chrono::steady_clock::now();
+
+    ShaderPassModules modules;
+    modules.Passes = passes;
+    modules.WorkgroupSize = workgroupSize;
 
-    std::string fileString = "";
+    // image, cubemap, simulation compute, simulation fragment, the vertex shader is built-in
+    const std::array<uint32_t, 4> modulePasses = { SHADER_PASS_IMAGE, SHADER_PASS_CUBEMAP, SHADER_PASS_SIMULATION, SHADER_PASS_SIMULATION };
+    std::array<std::vector<std::string>, 4> dependencies;
+    std::array<VkShaderModule, 4> shaderModules = {};
+    std::array<VkPipeline, 4> pipelines = {};
+    std::array<std::future<void>, 4> tasks;
 
-    if (file)
+    const VkShaderModule vertexShaderModule = m_BuiltinModules[BUILTIN_SHADER_FULLSCREEN_VERTEX];
+
+    // Each task compiles one stage, unchanged ones come from the SPIR-V cache, then creates its pipeline through the shared m_PipelineCache.
+    // Tasks only write their own slot, so the join below doesn't depend on the completion order.
+    auto submit = [&](size_t index, const std::string& path, const char* stage, std::function<VkPipeline(VkShaderModule)> createPipeline)
     {
-        std::stringstream strStream;
-        strStream << file.rdbuf();
+        // The image pass constants become UI controls, its code is kept for the shader objects
+        std::vector<SpecConstant>* specConstants = index == 0 ? &modules.ImageConstants : nullptr;
+        std::string* spirv = index == 0 ? &modules.ImageSpirv : nullptr;
+        tasks[index] = m_CompilePool->Submit([this, recipe, index, path, stage, createPipeline, specConstants, spirv, &dependencies, &shaderModules, &pipelines]() {
+            shaderModules[index] = CompileShaderModule(path, stage, recipe, dependencies[index], specConstants, spirv);
+            if (shaderModules[index] != VK_NULL_HANDLE && createPipeline)
+                pipelines[index] = createPipeline(shaderModules[index]);
+        });
+    };
 
-        fileString = strStream.str();
+    if (passes & SHADER_PASS_IMAGE)
+        submit(0, m_ImageShaderPath, "frag", nullptr);
 
-        file.close();
+    // Optional "Cube A" pass, its six faces are rendered from one draw through multiview
+    if ((passes & SHADER_PASS_CUBEMAP) && std::filesystem::exists(CUBEMAP_SHADER_PATH))
+        submit(1, CUBEMAP_SHADER_PATH, "frag", [this, vertexShaderModule](VkShaderModule fragmentShaderModule) {
+            return CreateFullscreenPipeline(vertexShaderModule, fragmentShaderModule, m_GraphicPipelineLayout, RT_IMAGE_FORMAT, CUBEMAP_VIEW_MASK); });
 
+    if ((passes & SHADER_PASS_SIMULATION) && std::filesystem::exists(SIM_COMPUTE_SHADER_PATH))
+        submit(2, SIM_COMPUTE_SHADER_PATH, "comp", [this, workgroupSize](VkShaderModule computeShaderModule) {
+            return CreateSimComputePipeline(computeShaderModule, workgroupSize); });
 
-        VkShaderModuleCreateInfo create_info = {};
-        create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        create_info.codeSize = fileString.size();
-        create_info.pCode = reinterpret_cast<const uint32_t*>(fileString.data());
+    if ((passes & SHADER_PASS_SIMULATION) && std::filesystem::exists(SIM_FRAGMENT_SHADER_PATH))
+        submit(3, SIM_FRAGMENT_SHADER_PATH, "frag", [this, vertexShaderModule](VkShaderModule fragmentShaderModule) {
+            return CreateFullscreenPipeline(vertexShaderModule, fragmentShaderModule, m_SimPipelineLayout, SIM_IMAGE_FORMAT, 0); });
 
-        VkShaderModule shaderModule;
-        VK_CHECK(m_Disp.createShaderModule(&create_info, nullptr, &shaderModule));
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+        if (!tasks[i].valid())
+            continue;
 
-        return shaderModule;
+        tasks[i].get();
+        modules.StageCount++;
+        for (const std::string& file : dependencies[i])
+            modules.Files[file] |= modulePasses[i];
     }
 
-    return VK_NULL_HANDLE;
+    modules.Image = shaderModules[0];
+    modules.Cubemap = shaderModules[1];
+    modules.SimCompute = shaderModules[2];
+    modules.SimFragment = shaderModules[3];
+    modules.CubemapPipeline = pipelines[1];
+    modules.SimComputePipeline = pipelines[2];
+    modules.SimFragmentPipeline = pipelines[3];
+    modules.BuildMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+    return modules;
 }
 
-void VulkanCore::CreateGraphicPipeline()
+void VulkanCore::CreatePassPipelines(ShaderPassModules modules)
+{
+    // Passes without a shader file count as created, a missing optional pass reads nothing
+    uint32_t created = 0;
+    if (!std::filesystem::exists(CUBEMAP_SHADER_PATH))
+        created |= modules.Passes & SHADER_PASS_CUBEMAP;
+    if (!std::filesystem::exists(SIM_COMPUTE_SHADER_PATH) && !std::filesystem::exists(SIM_FRAGMENT_SHADER_PATH))
+        created |= modules.Passes & SHADER_PASS_SIMULATION;
+    bool simulationFailed = false;
+
+    if (modules.Passes & SHADER_PASS_IMAGE)
+    {
+        if (modules.Image != VK_NULL_HANDLE)
+        {
+            created |= SHADER_PASS_IMAGE;
+
+            ClearImageVariants();
+            m_Disp.destroyShaderModule(m_ImageFragmentModule, nullptr);
+            m_ImageFragmentModule = modules.Image;
+
+            if (m_ShaderObjectSupported)
+                m_ImageFragmentSpirv = std::move(modules.ImageSpirv);
+
+            // Values set in the UI survive a reload while the constant keeps its id, name and type
+            for (SpecConstant& constant : modules.ImageConstants)
+            {
+                for (const SpecConstant& previous : m_ImageSpecConstants)
+                    if (previous.Id == constant.Id && previous.Name == constant.Name && previous.Type == constant.Type)
+                        constant.Value = previous.Value;
+            }
+            m_ImageSpecConstants = modules.ImageConstants;
+
+            SelectImageVariant();
+            debug_log("Image pass : variant created in " << m_ImageVariantMs << " ms (" << m_ImageVariantBackend << ")");
+        }
+        else
+        {
+            debug_log("Failed to create shaderModule !");
+        }
+    }
+
+    if ((modules.Passes & SHADER_PASS_CUBEMAP) && std::filesystem::exists(CUBEMAP_SHADER_PATH))
+    {
+        if (modules.CubemapPipeline != VK_NULL_HANDLE)
+        {
+            m_Disp.destroyPipeline(m_CubemapPipeline, nullptr);
+            m_CubemapPipeline = std::exchange(modules.CubemapPipeline, VK_NULL_HANDLE);
+            created |= SHADER_PASS_CUBEMAP;
+        }
+        else
+        {
+            debug_log("Failed to create cubemap shaderModule !");
+        }
+    }
+
+    if ((modules.Passes & SHADER_PASS_SIMULATION) && std::filesystem::exists(SIM_COMPUTE_SHADER_PATH))
+    {
+        // The workgroup size changed while the reload was compiling
+        if (modules.SimComputePipeline != VK_NULL_HANDLE && modules.WorkgroupSize != m_SimSettings.WorkgroupSize)
+        {
+            m_Disp.destroyPipeline(modules.SimComputePipeline, nullptr);
+            modules.SimComputePipeline = CreateSimComputePipeline(modules.SimCompute, m_SimSettings.WorkgroupSize);
+        }
+
+        if (modules.SimComputePipeline != VK_NULL_HANDLE)
+        {
+            m_Disp.destroyPipeline(m_SimComputePipeline, nullptr);
+            m_SimComputePipeline = std::exchange(modules.SimComputePipeline, VK_NULL_HANDLE);
+        }
+        else
+        {
+            debug_log("Failed to create simulation compute shaderModule !");
+            simulationFailed = true;
+        }
+    }
+
+    if ((modules.Passes & SHADER_PASS_SIMULATION) && std::filesystem::exists(SIM_FRAGMENT_SHADER_PATH))
+    {
+        if (modules.SimFragmentPipeline != VK_NULL_HANDLE)
+        {
+            m_Disp.destroyPipeline(m_SimFragmentPipeline, nullptr);
+            m_SimFragmentPipeline = std::exchange(modules.SimFragmentPipeline, VK_NULL_HANDLE);
+        }
+        else
+        {
+            debug_log("Failed to create simulation fragment shaderModule !");
+            simulationFailed = true;
+        }
+    }
+
+    if (!simulationFailed)
+        created |= modules.Passes & SHADER_PASS_SIMULATION;
+
+    m_ShaderBuildStages = modules.StageCount;
+    m_ShaderBuildMs = modules.BuildMs;
+    debug_log("Shader build : " << modules.StageCount << " stages in " << modules.BuildMs << " ms on " << m_CompilePool->GetThreadCount() << " threads");
+
+    UpdateShaderDependencies(modules, created);
+
+    // Now owned by the image pass
+    if (created & modules.Passes & SHADER_PASS_IMAGE)
+        modules.Image = VK_NULL_HANDLE;
+
+    DestroyShaderModules(modules);
+}
+
+// Every constant is a 32 bits word of data, info is nullptr without constants
+static const VkSpecializationInfo* BuildSpecializationInfo(const std::vector<SpecConstant>& constants, std::vector<VkSpecializationMapEntry>& mapEntries,
+    std::vector<uint32_t>& data, VkSpecializationInfo& info)
+{
+    for (const SpecConstant& constant : constants)
+    {
+        mapEntries.push_back({ constant.Id, static_cast<uint32_t>(data.size() * sizeof(uint32_t)), sizeof(uint32_t) });
+        data.push_back(constant.Value);
+    }
+
+    info.mapEntryCount = static_cast<uint32_t>(mapEntries.size());
+    info.pMapEntries = mapEntries.data();
+    info.dataSize = data.size() * sizeof(uint32_t);
+    info.pData = data.data();
+
+    return constants.empty() ? nullptr : &info;
+}
+
+void VulkanCore::SelectImageVariant()
 {
-    CompileShader(".\\Shader\\Vertex\\Shader0.vert");
-    CompileShader(".\\Shader\\Frag\\Shader0.frag");
+    if (m_ImageFragmentModule == VK_NULL_HANDLE)
+        return;
 
-    VkShaderModule vertexShaderModule = createModule(".\\Shader\\Compiled_SPV\\Shader0.vert.spv");
-    VkShaderModule fragmentShaderModule = createModule(".\\Shader\\Compiled_SPV\\Shader0.frag.spv");
+    // FNV-1a over the id / value pairs
+    uint64_t key = 14695981039346656037ull;
+    for (const SpecConstant& constant : m_ImageSpecConstants)
+    {
+        for (uint32_t word : { constant.Id, constant.Value })
+        {
+            key ^= word;
+            key *= 1099511628211ull;
+        }
+    }
 
-    if (vertexShaderModule == VK_NULL_HANDLE || fragmentShaderModule == VK_NULL_HANDLE)
+    auto found = m_ImageVariantIndex.find(key);
+    if (found != m_ImageVariantIndex.end())
+    {
+        m_ImageVariants.splice(m_ImageVariants.begin(), m_ImageVariants, found->second);
+    }
+    else
     {
-        debug_log("Failed to create shaderModule !");
+        std::vector<VkSpecializationMapEntry> mapEntries;
+        std::vector<uint32_t> data;
+        VkSpecializationInfo specializationInfo{};
+        const VkSpecializationInfo* specialization = BuildSpecializationInfo(m_ImageSpecConstants, mapEntries, data, specializationInfo);
+
+        ImageVariant variant;
+        variant.Key = key;
+
+        auto start = std::chrono::steady_clock::now();
+
+        if (m_UseShaderObjects)
+        {
+            // A single shader object, no pipeline state to compile
+            variant.FragmentShader = CreateImageShader(VK_SHADER_STAGE_FRAGMENT_BIT,
+                std::span(reinterpret_cast<const uint32_t*>(m_ImageFragmentSpirv.data()), m_ImageFragmentSpirv.size() / sizeof(uint32_t)), specialization);
+            m_ImageVariantBackend = "shader object";
+        }
+        else if (m_PipelineLibrary)
+        {
+            // Only the fragment shader is compiled, the fast link is usable right away.
+            // Offline renders have no frame to wait for the optimized link, they link it directly.
+            variant.FragmentLibrary = CreateFullscreenPipeline(VK_NULL_HANDLE, m_ImageFragmentModule, m_GraphicPipelineLayout, RT_IMAGE_FORMAT, 0, false,
+                specialization, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT);
+
+            variant.Pipeline = LinkImagePipeline(variant.FragmentLibrary, false, m_Offline);
+
+            if (!m_Offline)
+            {
+                variant.Optimized = std::async(std::launch::async, [this, fragmentLibrary = variant.FragmentLibrary]() {
+                    return LinkImagePipeline(fragmentLibrary, false, true);
+                });
+            }
+
+            m_ImageVariantBackend = "pipeline library";
+        }
+        else
+        {
+            variant.Pipeline = CreateFullscreenPipeline(m_BuiltinModules[BUILTIN_SHADER_FULLSCREEN_VERTEX], m_ImageFragmentModule, m_GraphicPipelineLayout, RT_IMAGE_FORMAT, 0, false, specialization);
+
+            m_ImageVariantBackend = "pipeline";
+        }
+
+        m_ImageVariantMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        m_ImageVariants.push_front(std::move(variant));
+        m_ImageVariantIndex[key] = m_ImageVariants.begin();
+
+        if (m_ImageVariants.size() > IMAGE_VARIANT_CACHE_SIZE)
+        {
+            // The least recently used variant may still be recorded in a frame in flight
+            m_Disp.deviceWaitIdle();
+
+            ImageVariant& evicted = m_ImageVariants.back();
+            m_ImageVariantIndex.erase(evicted.Key);
+            DestroyImageVariant(evicted);
+            m_ImageVariants.pop_back();
+        }
+    }
+
+    m_GraphicPipeline = m_ImageVariants.front().Pipeline;
+    m_AccumulatePipeline = m_ImageVariants.front().Accumulate;
+}
+
+void VulkanCore::CreateAccumulatePipeline()
+{
+    if (m_ImageVariants.empty() || m_ImageVariants.front().Accumulate != VK_NULL_HANDLE)
         return;
+
+    ImageVariant& variant = m_ImageVariants.front();
+
+    if (variant.FragmentLibrary != VK_NULL_HANDLE)
+    {
+        if (m_ImageLibraries[IMAGE_LIBRARY_ACCUMULATE_OUTPUT] != VK_NULL_HANDLE)
+            variant.Accumulate = LinkImagePipeline(variant.FragmentLibrary, true, m_Offline);
+    }
+    else if (variant.FragmentShader == VK_NULL_HANDLE)
+    {
+        // Blending 32 bits float attachments is optional
+        VkFormatProperties formatProperties{};
+        m_Inst_disp.getPhysicalDeviceFormatProperties(m_Device.physical_device, RT_IMAGE_FORMAT, &formatProperties);
+
+        if (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BLEND_BIT)
+        {
+            // The front variant was selected for the current constant values
+            std::vector<VkSpecializationMapEntry> mapEntries;
+            std::vector<uint32_t> data;
+            VkSpecializationInfo specializationInfo{};
+            const VkSpecializationInfo* specialization = BuildSpecializationInfo(m_ImageSpecConstants, mapEntries, data, specializationInfo);
+
+            variant.Accumulate = CreateFullscreenPipeline(m_BuiltinModules[BUILTIN_SHADER_FULLSCREEN_VERTEX], m_ImageFragmentModule, m_GraphicPipelineLayout, RT_IMAGE_FORMAT, 0, true, specialization);
+        }
+    }
+
+    m_AccumulatePipeline = variant.Accumulate;
+}
+
+void VulkanCore::ClearImageVariants()
+{
+    for (ImageVariant& variant : m_ImageVariants)
+        DestroyImageVariant(variant);
+
+    m_ImageVariants.clear();
+    m_ImageVariantIndex.clear();
+
+    m_GraphicPipeline = VK_NULL_HANDLE;
+    m_AccumulatePipeline = VK_NULL_HANDLE;
+}
+
+void VulkanCore::DestroyImageVariant(ImageVariant& variant)
+{
+    if (variant.Optimized.valid())
+        m_Disp.destroyPipeline(variant.Optimized.get(), nullptr);
+
+    m_Disp.destroyPipeline(variant.Pipeline, nullptr);
+    m_Disp.destroyPipeline(variant.Accumulate, nullptr);
+    m_Disp.destroyPipeline(variant.FragmentLibrary, nullptr);
+    m_Disp.destroyShaderEXT(variant.FragmentShader, nullptr);
+}
+
+VkShaderEXT VulkanCore::CreateImageShader(VkShaderStageFlagBits stage, std::span<const uint32_t> code, const VkSpecializationInfo* specialization)
+{
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    std::array<VkDescriptorSetLayout, 2> setLayouts = { m_BindlessSetLayout, m_FrameSetLayout };
+
+    VkShaderCreateInfoEXT shaderCreateInfo{ VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT };
+    shaderCreateInfo.stage = stage;
+    shaderCreateInfo.nextStage = stage == VK_SHADER_STAGE_VERTEX_BIT ? VK_SHADER_STAGE_FRAGMENT_BIT : 0;
+    shaderCreateInfo.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT;
+    shaderCreateInfo.codeSize = code.size_bytes();
+    shaderCreateInfo.pCode = code.data();
+    shaderCreateInfo.pName = "main";
+    shaderCreateInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    shaderCreateInfo.pSetLayouts = setLayouts.data();
+    shaderCreateInfo.pushConstantRangeCount = 1;
+    shaderCreateInfo.pPushConstantRanges = &pushConstantRange;
+    shaderCreateInfo.pSpecializationInfo = specialization;
+
+    VkShaderEXT shader = VK_NULL_HANDLE;
+    VK_CHECK(m_Disp.createShadersEXT(1, &shaderCreateInfo, nullptr, &shader));
+
+    return shader;
+}
+
+void VulkanCore::BindImageShaders(VkCommandBuffer commandBuffer, VkShaderEXT fragmentShader)
+{
+    const std::array<VkShaderStageFlagBits, 2> stages = { VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT };
+    const std::array<VkShaderEXT, 2> shaders = { m_ImageVertexShader, fragmentShader };
+    m_Disp.cmdBindShadersEXT(commandBuffer, static_cast<uint32_t>(stages.size()), stages.data(), shaders.data());
+
+    // The state of CreateFullscreenPipeline, viewport and scissor are set by the caller
+    m_Disp.cmdSetVertexInputEXT(commandBuffer, 0, nullptr, 0, nullptr);
+    m_Disp.cmdSetPrimitiveTopology(commandBuffer, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+    m_Disp.cmdSetPrimitiveRestartEnable(commandBuffer, VK_FALSE);
+    m_Disp.cmdSetRasterizerDiscardEnable(commandBuffer, VK_FALSE);
+    m_Disp.cmdSetPolygonModeEXT(commandBuffer, VK_POLYGON_MODE_FILL);
+    m_Disp.cmdSetCullMode(commandBuffer, VK_CULL_MODE_BACK_BIT);
+    m_Disp.cmdSetFrontFace(commandBuffer, VK_FRONT_FACE_COUNTER_CLOCKWISE);
+    m_Disp.cmdSetDepthBiasEnable(commandBuffer, VK_FALSE);
+    m_Disp.cmdSetRasterizationSamplesEXT(commandBuffer, VK_SAMPLE_COUNT_1_BIT);
+
+    const VkSampleMask sampleMask = ~0u;
+    m_Disp.cmdSetSampleMaskEXT(commandBuffer, VK_SAMPLE_COUNT_1_BIT, &sampleMask);
+    m_Disp.cmdSetAlphaToCoverageEnableEXT(commandBuffer, VK_FALSE);
+
+    m_Disp.cmdSetDepthTestEnable(commandBuffer, VK_FALSE);
+    m_Disp.cmdSetDepthWriteEnable(commandBuffer, VK_FALSE);
+    m_Disp.cmdSetStencilTestEnable(commandBuffer, VK_FALSE);
+
+    const VkBool32 blendEnable = VK_FALSE;
+    const VkColorComponentFlags colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    m_Disp.cmdSetColorBlendEnableEXT(commandBuffer, 0, 1, &blendEnable);
+    m_Disp.cmdSetColorWriteMaskEXT(commandBuffer, 0, 1, &colorWriteMask);
+}
+
+void VulkanCore::SetShaderObjects(bool enabled)
+{
+    m_UseShaderObjects = enabled && m_ShaderObjectSupported && !m_Offline;
+
+    // The frames in flight may hold the current variants
+    m_Disp.deviceWaitIdle();
+
+    ClearImageVariants();
+    SelectImageVariant();
+}
+
+void VulkanCore::UpdateImageVariants()
+{
+    // Called once per frame after its fence wait
+    for (auto retired = m_RetiredPipelines.begin(); retired != m_RetiredPipelines.end();)
+    {
+        if (--retired->second > 0)
+        {
+            ++retired;
+            continue;
+        }
+
+        m_Disp.destroyPipeline(retired->first, nullptr);
+        retired = m_RetiredPipelines.erase(retired);
+    }
+
+    for (ImageVariant& variant : m_ImageVariants)
+    {
+        if (!variant.Optimized.valid() || variant.Optimized.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            continue;
+
+        // The fast linked pipeline may be recorded in the frames in flight
+        m_RetiredPipelines.emplace_back(variant.Pipeline, MAX_FRAMES_IN_FLIGHT + 1);
+        variant.Pipeline = variant.Optimized.get();
+    }
+
+    if (!m_ImageVariants.empty())
+    {
+        m_GraphicPipeline = m_ImageVariants.front().Pipeline;
+        m_AccumulatePipeline = m_ImageVariants.front().Accumulate;
+    }
+}
+
+void VulkanCore::UpdateShaderDependencies(const ShaderPassModules& modules, uint32_t compiledPasses)
+{
+    std::vector<std::string> watchedFiles;
+    for (const auto& [file, passes] : m_ShaderFilePasses)
+        watchedFiles.push_back(file);
+
+    // A failed pass keeps its previous files, the fix may be in any of them
+    for (auto file = m_ShaderFilePasses.begin(); file != m_ShaderFilePasses.end();)
+    {
+        file->second &= ~compiledPasses;
+        file = file->second == 0 ? m_ShaderFilePasses.erase(file) : std::next(file);
     }
 
+    for (const auto& [file, passes] : modules.Files)
+        m_ShaderFilePasses[file] |= passes;
+
+    // The root of every pass stays watched, even before it exists
+    m_ShaderFilePasses[NormalizeShaderPath(m_ImageShaderPath)] |= SHADER_PASS_IMAGE;
+    m_ShaderFilePasses[NormalizeShaderPath(CUBEMAP_SHADER_PATH)] |= SHADER_PASS_CUBEMAP;
+    m_ShaderFilePasses[NormalizeShaderPath(SIM_COMPUTE_SHADER_PATH)] |= SHADER_PASS_SIMULATION;
+    m_ShaderFilePasses[NormalizeShaderPath(SIM_FRAGMENT_SHADER_PATH)] |= SHADER_PASS_SIMULATION;
+
+    std::vector<std::string> files;
+    for (const auto& [file, passes] : m_ShaderFilePasses)
+        files.push_back(file);
+
+    if (m_WatchShaders && files != watchedFiles)
+        m_ShaderWatcher.Start(files, SHADER_WATCH_DEBOUNCE_SECONDS);
+}
+
+void VulkanCore::DestroyShaderModules(const ShaderPassModules& modules)
+{
+    m_Disp.destroyShaderModule(modules.Image, nullptr);
+    m_Disp.destroyShaderModule(modules.Cubemap, nullptr);
+    m_Disp.destroyShaderModule(modules.SimCompute, nullptr);
+    m_Disp.destroyShaderModule(modules.SimFragment, nullptr);
+    m_Disp.destroyPipeline(modules.CubemapPipeline, nullptr);
+    m_Disp.destroyPipeline(modules.SimComputePipeline, nullptr);
+    m_Disp.destroyPipeline(modules.SimFragmentPipeline, nullptr);
+}
+
+// maxComputeWorkGroupInvocations is only guaranteed to be 128
+bool VulkanCore::IsWorkgroupSizeSupported(glm::uvec2 size) const
+{
+    const VkPhysicalDeviceLimits& limits = m_Device.physical_device.properties.limits;
+    return size.x * size.y <= limits.maxComputeWorkGroupInvocations && size.x <= limits.maxComputeWorkGroupSize[0] && size.y <= limits.maxComputeWorkGroupSize[1];
+}
+
+VkPipeline VulkanCore::CreateSimComputePipeline(VkShaderModule computeShaderModule, glm::uvec2 workgroupSize)
+{
+    // local_size_x_id = 0, local_size_y_id = 1
+    std::array<VkSpecializationMapEntry, 2> mapEntries = { {
+        { 0, 0, sizeof(uint32_t) },
+        { 1, sizeof(uint32_t), sizeof(uint32_t) },
+    } };
+
+    VkSpecializationInfo specializationInfo{};
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(mapEntries.size());
+    specializationInfo.pMapEntries = mapEntries.data();
+    specializationInfo.dataSize = sizeof(glm::uvec2);
+    specializationInfo.pData = &workgroupSize;
+
+    VkComputePipelineCreateInfo computePipelineCreateInfo{};
+    computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    computePipelineCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    computePipelineCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    computePipelineCreateInfo.stage.module = computeShaderModule;
+    computePipelineCreateInfo.stage.pName = "main";
+    computePipelineCreateInfo.stage.pSpecializationInfo = &specializationInfo;
+    computePipelineCreateInfo.layout = m_SimPipelineLayout;
+    computePipelineCreateInfo.basePipelineIndex = -1;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VK_CHECK(m_Disp.createComputePipelines(m_PipelineCache, 1, &computePipelineCreateInfo, nullptr, &pipeline));
+
+    return pipeline;
+}
+
+VkPipeline VulkanCore::CreateFullscreenPipeline(VkShaderModule vertexShaderModule, VkShaderModule fragmentShaderModule, VkPipelineLayout layout, VkFormat format, uint32_t viewMask, bool accumulate,
+    const VkSpecializationInfo* fragmentSpecialization, VkGraphicsPipelineLibraryFlagsEXT libraryParts)
+{
     VkPipelineShaderStageCreateInfo vertexShaderStageCreateInfo;
     vertexShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     vertexShaderStageCreateInfo.pNext = NULL;
@@ -241,9 +985,15 @@ void VulkanCore::CreateGraphicPipeline()
     fragmentShaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
     fragmentShaderStageCreateInfo.module = fragmentShaderModule;
     fragmentShaderStageCreateInfo.pName = "main";
-    fragmentShaderStageCreateInfo.pSpecializationInfo = NULL;
+    fragmentShaderStageCreateInfo.pSpecializationInfo = fragmentSpecialization;
 
-    std::array<VkPipelineShaderStageCreateInfo, 2> pipelineShaderStageCreateInfos = { vertexShaderStageCreateInfo, fragmentShaderStageCreateInfo };
+    // A library only holds the stages of its parts
+    uint32_t stageCount = 0;
+    std::array<VkPipelineShaderStageCreateInfo, 2> pipelineShaderStageCreateInfos;
+    if (libraryParts == 0 || (libraryParts & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT))
+        pipelineShaderStageCreateInfos[stageCount++] = vertexShaderStageCreateInfo;
+    if (libraryParts == 0 || (libraryParts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT))
+        pipelineShaderStageCreateInfos[stageCount++] = fragmentShaderStageCreateInfo;
 
     VkPipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo;
     pipelineVertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -340,6 +1090,15 @@ void VulkanCore::CreateGraphicPipeline()
     pPipelineColorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
     pPipelineColorBlendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
 
+    if (accumulate)
+    {
+        pPipelineColorBlendAttachmentState.blendEnable = VK_TRUE;
+        pPipelineColorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_CONSTANT_COLOR;
+        pPipelineColorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_CONSTANT_COLOR;
+        pPipelineColorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_CONSTANT_ALPHA;
+        pPipelineColorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_CONSTANT_ALPHA;
+    }
+
     VkPipelineColorBlendStateCreateInfo pipelineColorBlendStateCreateInfo;
     pipelineColorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
     pipelineColorBlendStateCreateInfo.pNext = NULL;
@@ -353,48 +1112,33 @@ void VulkanCore::CreateGraphicPipeline()
     pipelineColorBlendStateCreateInfo.blendConstants[2] = 0.0f;
     pipelineColorBlendStateCreateInfo.blendConstants[3] = 0.0f;
 
-    std::array<VkDynamicState, 2> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    std::array<VkDynamicState, 3> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_BLEND_CONSTANTS };
 
     VkPipelineDynamicStateCreateInfo pipelineDynamicStateCreateInfo;
     pipelineDynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
     pipelineDynamicStateCreateInfo.pNext = NULL;
     pipelineDynamicStateCreateInfo.flags = 0;
-    pipelineDynamicStateCreateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    pipelineDynamicStateCreateInfo.dynamicStateCount = accumulate ? 3u : 2u;
     pipelineDynamicStateCreateInfo.pDynamicStates = dynamicStates.data();
 
-    if (m_GraphicPipelineLayout == VK_NULL_HANDLE)
-    {
-        VkPushConstantRange pushConstantRange{};
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-        pushConstantRange.offset = 0;
-        pushConstantRange.size = sizeof(PushConstants);
-
-        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo;
-        pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutCreateInfo.pNext = NULL;
-        pipelineLayoutCreateInfo.flags = 0;
-        pipelineLayoutCreateInfo.setLayoutCount = 0;
-        pipelineLayoutCreateInfo.pSetLayouts = NULL;
-        pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
-        pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
-
-        VK_CHECK(m_Disp.createPipelineLayout(&pipelineLayoutCreateInfo, NULL, &m_GraphicPipelineLayout));
-    }
-
-    const auto format = RT_IMAGE_FORMAT;
-
     VkPipelineRenderingCreateInfoKHR pipeline_create{ VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR };
     pipeline_create.pNext = VK_NULL_HANDLE;
+    pipeline_create.viewMask = viewMask;
     pipeline_create.colorAttachmentCount = 1;
     pipeline_create.pColorAttachmentFormats = &format;
     pipeline_create.depthAttachmentFormat = VK_FORMAT_UNDEFINED;
     pipeline_create.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
 
+    // The state outside of libraryParts is ignored
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo{ VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT };
+    libraryCreateInfo.pNext = &pipeline_create;
+    libraryCreateInfo.flags = libraryParts;
+
     VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo;
     graphicsPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    graphicsPipelineCreateInfo.pNext = &pipeline_create;
-    graphicsPipelineCreateInfo.flags = 0;
-    graphicsPipelineCreateInfo.stageCount = static_cast<uint32_t>(pipelineShaderStageCreateInfos.size());
+    graphicsPipelineCreateInfo.pNext = libraryParts ? static_cast<const void*>(&libraryCreateInfo) : &pipeline_create;
+    graphicsPipelineCreateInfo.flags = libraryParts ? VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT : 0;
+    graphicsPipelineCreateInfo.stageCount = stageCount;
     graphicsPipelineCreateInfo.pStages = pipelineShaderStageCreateInfos.data();
     graphicsPipelineCreateInfo.pVertexInputState = &pipelineVertexInputStateCreateInfo;
     graphicsPipelineCreateInfo.pInputAssemblyState = &pipelineInputAssemblyStateCreateInfo;
@@ -405,16 +1149,60 @@ void VulkanCore::CreateGraphicPipeline()
     graphicsPipelineCreateInfo.pDepthStencilState = &pipelineDepthStencilStateCreateInfo;
     graphicsPipelineCreateInfo.pColorBlendState = &pipelineColorBlendStateCreateInfo;
     graphicsPipelineCreateInfo.pDynamicState = &pipelineDynamicStateCreateInfo;
-    graphicsPipelineCreateInfo.layout = m_GraphicPipelineLayout;
+    graphicsPipelineCreateInfo.layout = layout;
     graphicsPipelineCreateInfo.renderPass = VK_NULL_HANDLE;
     graphicsPipelineCreateInfo.subpass = 0;
     graphicsPipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
     graphicsPipelineCreateInfo.basePipelineIndex = -1;
 
-    VK_CHECK(m_Disp.createGraphicsPipelines(VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, NULL, &m_GraphicPipeline));
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VK_CHECK(m_Disp.createGraphicsPipelines(m_PipelineCache, 1, &graphicsPipelineCreateInfo, NULL, &pipeline));
+
+    return pipeline;
+}
+
+void VulkanCore::CreateImageLibraries()
+{
+    m_ImageLibraries[IMAGE_LIBRARY_VERTEX_INPUT] = CreateFullscreenPipeline(VK_NULL_HANDLE, VK_NULL_HANDLE, m_GraphicPipelineLayout, RT_IMAGE_FORMAT, 0, false,
+        nullptr, VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT);
+
+    m_ImageLibraries[IMAGE_LIBRARY_OUTPUT] = CreateFullscreenPipeline(VK_NULL_HANDLE, VK_NULL_HANDLE, m_GraphicPipelineLayout, RT_IMAGE_FORMAT, 0, false,
+        nullptr, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+
+    VkFormatProperties formatProperties{};
+    m_Inst_disp.getPhysicalDeviceFormatProperties(m_Device.physical_device, RT_IMAGE_FORMAT, &formatProperties);
+
+    if (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BLEND_BIT)
+        m_ImageLibraries[IMAGE_LIBRARY_ACCUMULATE_OUTPUT] = CreateFullscreenPipeline(VK_NULL_HANDLE, VK_NULL_HANDLE, m_GraphicPipelineLayout, RT_IMAGE_FORMAT, 0, true,
+            nullptr, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+
+    m_ImageLibraries[IMAGE_LIBRARY_PRE_RASTERIZATION] = CreateFullscreenPipeline(m_BuiltinModules[BUILTIN_SHADER_FULLSCREEN_VERTEX], VK_NULL_HANDLE, m_GraphicPipelineLayout, RT_IMAGE_FORMAT, 0, false,
+        nullptr, VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT);
+}
+
+VkPipeline VulkanCore::LinkImagePipeline(VkPipeline fragmentLibrary, bool accumulate, bool optimize)
+{
+    std::array<VkPipeline, 4> libraries = {
+        m_ImageLibraries[IMAGE_LIBRARY_VERTEX_INPUT],
+        m_ImageLibraries[IMAGE_LIBRARY_PRE_RASTERIZATION],
+        fragmentLibrary,
+        m_ImageLibraries[accumulate ? IMAGE_LIBRARY_ACCUMULATE_OUTPUT : IMAGE_LIBRARY_OUTPUT],
+    };
+
+    VkPipelineLibraryCreateInfoKHR libraryCreateInfo{ VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR };
+    libraryCreateInfo.libraryCount = static_cast<uint32_t>(libraries.size());
+    libraryCreateInfo.pLibraries = libraries.data();
+
+    VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo{ VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+    graphicsPipelineCreateInfo.pNext = &libraryCreateInfo;
+    graphicsPipelineCreateInfo.flags = optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+    graphicsPipelineCreateInfo.layout = m_GraphicPipelineLayout;
+    graphicsPipelineCreateInfo.basePipelineIndex = -1;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VK_CHECK(m_Disp.createGraphicsPipelines(m_PipelineCache, 1, &graphicsPipelineCreateInfo, nullptr, &pipeline));
 
-    m_Disp.destroyShaderModule(vertexShaderModule, nullptr);
-    m_Disp.destroyShaderModule(fragmentShaderModule, nullptr);
+    return pipeline;
 }
 
 void VulkanCore::CreateCommandBuffer()
@@ -429,6 +1217,16 @@ void VulkanCore::CreateCommandBuffer()
     commandBufferAllocateInfo.commandBufferCount = static_cast<uint32_t>(m_CommandBuffers.size());
 
     VK_CHECK(m_Disp.allocateCommandBuffers(&commandBufferAllocateInfo, m_CommandBuffers.data()));
+
+    if (m_ComputePool != VK_NULL_HANDLE)
+    {
+        m_ComputeCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+
+        commandBufferAllocateInfo.commandPool = m_ComputePool;
+        commandBufferAllocateInfo.commandBufferCount = static_cast<uint32_t>(m_ComputeCommandBuffers.size());
+
+        VK_CHECK(m_Disp.allocateCommandBuffers(&commandBufferAllocateInfo, m_ComputeCommandBuffers.data()));
+    }
 }
 
 void VulkanCore::CreateSyncObject()
@@ -449,6 +1247,48 @@ void VulkanCore::CreateSyncObject()
         VK_CHECK(m_Disp.createSemaphore(&semaphoreInfo, nullptr, &m_RenderFinishedSemaphores[i]));
         VK_CHECK(m_Disp.createFence(&fenceInfo, nullptr, &m_InFlightFences[i]));
     }
+
+    VkSemaphoreTypeCreateInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineInfo.initialValue = 0;
+
+    semaphoreInfo.pNext = &timelineInfo;
+
+    VK_CHECK(m_Disp.createSemaphore(&semaphoreInfo, nullptr, &m_SimTimeline));
+    VK_CHECK(m_Disp.createSemaphore(&semaphoreInfo, nullptr, &m_GraphicsTimeline));
+}
+
+void VulkanCore::ImmediateSubmit(const std::function<void(VkCommandBuffer)>& record)
+{
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+    commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferAllocateInfo.commandPool = m_GraphicPool;
+    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferAllocateInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer;
+    VK_CHECK(m_Disp.allocateCommandBuffers(&commandBufferAllocateInfo, &commandBuffer));
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VK_CHECK(m_Disp.beginCommandBuffer(commandBuffer, &beginInfo));
+
+    record(commandBuffer);
+
+    VK_CHECK(m_Disp.endCommandBuffer(commandBuffer));
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    VK_CHECK(m_Disp.queueSubmit(m_GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE));
+    VK_CHECK(m_Disp.queueWaitIdle(m_GraphicsQueue));
+
+    m_Disp.freeCommandBuffers(m_GraphicPool, 1, &commandBuffer);
 }
 
 void VulkanCore::CreateRenderTarget(uint32_t width, uint32_t height)
@@ -468,7 +1308,7 @@ void VulkanCore::CreateRenderTarget(uint32_t width, uint32_t height)
         imageCreateInfo.format = RT_IMAGE_FORMAT;
         imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
         imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        imageCreateInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        imageCreateInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
         imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
         imageCreateInfo.flags = 0;
         imageCreateInfo.queueFamilyIndexCount = 1;
@@ -498,10 +1338,14 @@ void VulkanCore::CreateRenderTarget(uint32_t width, uint32_t height)
 
         VK_CHECK(m_Disp.createImageView(&viewInfo, nullptr, &m_RTImages[i].ImageView));
 
-
-        m_ImGuiDescriptors[i] = ImGui_ImplVulkan_AddTexture(m_ImGuiSampler, m_RTImages[i].ImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        if (!m_Offline)
+            m_ImGuiDescriptors[i] = ImGui_ImplVulkan_AddTexture(m_ImGuiSampler, m_RTImages[i].ImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     }
 
+    // The RGBA32F average and its error buffers only exist while progressive mode is on
+    if (!m_Offline && m_Progressive.Enabled)
+        CreateProgressiveTarget(width, height);
+
     m_LastTime = std::chrono::high_resolution_clock::now();
 }
 
@@ -512,15 +1356,497 @@ void VulkanCore::RecreateRenderTarget(uint32_t width, uint32_t height)
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
         m_RTImages[i].Clenup(m_Allocator, m_Disp);
-        ImGui_ImplVulkan_RemoveTexture(m_ImGuiDescriptors[i]);
+        if (!m_Offline)
+            ImGui_ImplVulkan_RemoveTexture(m_ImGuiDescriptors[i]);
     }
 
     m_ImGuiDescriptors.clear();
     m_RTImages.clear();
 
+    DestroyProgressiveTarget();
+
     CreateRenderTarget(width, height);
 }
 
+void VulkanCore::CreateCubemapTarget(uint32_t size)
+{
+    if (m_CubemapImage.Image != VK_NULL_HANDLE)
+    {
+        m_Disp.destroyImageView(m_CubemapAttachmentView, nullptr);
+        m_CubemapImage.Clenup(m_Allocator, m_Disp);
+        m_CubemapImage = ImageData();
+        m_CubemapAttachmentView = VK_NULL_HANDLE;
+    }
+
+    m_CubemapSize = size;
+
+    VkImageCreateInfo imageCreateInfo{};
+    imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageCreateInfo.extent.width = size;
+    imageCreateInfo.extent.height = size;
+    imageCreateInfo.extent.depth = 1;
+    imageCreateInfo.mipLevels = 1;
+    imageCreateInfo.arrayLayers = 6;
+    imageCreateInfo.format = RT_IMAGE_FORMAT;
+    imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageCreateInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageCreateInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+    imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocCreateInfo = {};
+    allocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
+    allocCreateInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+    allocCreateInfo.priority = 1.0f;
+
+    if (vmaCreateImage(m_Allocator, &imageCreateInfo, &allocCreateInfo, &m_CubemapImage.Image, &m_CubemapImage.ImageAllocation, nullptr) != VK_SUCCESS) {
+        debug_log("Cubemap creation failed !");
+        return;
+    }
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = m_CubemapImage.Image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_CUBE;
+    viewInfo.format = RT_IMAGE_FORMAT;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 6;
+
+    VK_CHECK(m_Disp.createImageView(&viewInfo, nullptr, &m_CubemapImage.ImageView));
+
+    // Multiview writes view i into layer i of the attachment, so render through an array view
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+
+    VK_CHECK(m_Disp.createImageView(&viewInfo, nullptr, &m_CubemapAttachmentView));
+
+    m_CubemapInitialized = false;
+
+    WriteBindlessImage(BindlessImageType::TextureCube, m_CubemapSlot, m_CubemapImage.ImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void VulkanCore::CreateSimulation(const SimulationSettings& settings)
+{
+    m_SimSettings = settings;
+
+    // Only 8x8 fits the guaranteed 128 invocations
+    if (!IsWorkgroupSizeSupported(m_SimSettings.WorkgroupSize))
+        m_SimSettings.WorkgroupSize = glm::uvec2(8u, 8u);
+
+    // Shared between the graphics and the async compute family, no ownership transfers needed
+    std::array<uint32_t, 2> queueFamilyIndices = { m_Device.get_queue_index(vkb::QueueType::graphics).value(), m_ComputeQueueFamily };
+    const bool concurrent = m_ComputeQueue != VK_NULL_HANDLE;
+
+    for (auto& simImage : m_SimImages)
+    {
+        VkImageCreateInfo imageCreateInfo{};
+        imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageCreateInfo.extent.width = settings.GridSize.x;
+        imageCreateInfo.extent.height = settings.GridSize.y;
+        imageCreateInfo.extent.depth = 1;
+        imageCreateInfo.mipLevels = 1;
+        imageCreateInfo.arrayLayers = 1;
+        imageCreateInfo.format = SIM_IMAGE_FORMAT;
+        imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageCreateInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageCreateInfo.sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+        imageCreateInfo.queueFamilyIndexCount = concurrent ? 2 : 1;
+        imageCreateInfo.pQueueFamilyIndices = queueFamilyIndices.data();
+
+        VmaAllocationCreateInfo allocCreateInfo = {};
+        allocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
+        allocCreateInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+        allocCreateInfo.priority = 1.0f;
+
+        if (vmaCreateImage(m_Allocator, &imageCreateInfo, &allocCreateInfo, &simImage.Image, &simImage.ImageAllocation, nullptr) != VK_SUCCESS) {
+            debug_log("Simulation image creation failed !");
+            return;
+        }
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = simImage.Image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = SIM_IMAGE_FORMAT;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        VK_CHECK(m_Disp.createImageView(&viewInfo, nullptr, &simImage.ImageView));
+    }
+
+    VkBufferCreateInfo bufferCreateInfo{};
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.size = SIM_BUFFER_SIZE;
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferCreateInfo.sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+    bufferCreateInfo.queueFamilyIndexCount = concurrent ? 2 : 1;
+    bufferCreateInfo.pQueueFamilyIndices = queueFamilyIndices.data();
+
+    VmaAllocationCreateInfo bufferAllocCreateInfo = {};
+    bufferAllocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+    VK_CHECK(vmaCreateBuffer(m_Allocator, &bufferCreateInfo, &bufferAllocCreateInfo, &m_SimBuffer.Buffer, &m_SimBuffer.BufferAllocation, nullptr));
+
+    // set 0 : previous state (read), next state (compute write), persistent buffer
+    std::array<VkDescriptorSetLayoutBinding, 3> simBindings{};
+    simBindings[0].binding = 0;
+    simBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    simBindings[0].descriptorCount = 1;
+    simBindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    simBindings[1].binding = 1;
+    simBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    simBindings[1].descriptorCount = 1;
+    simBindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    simBindings[2].binding = 2;
+    simBindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    simBindings[2].descriptorCount = 1;
+    simBindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo{};
+    setLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutCreateInfo.bindingCount = static_cast<uint32_t>(simBindings.size());
+    setLayoutCreateInfo.pBindings = simBindings.data();
+
+    VK_CHECK(m_Disp.createDescriptorSetLayout(&setLayoutCreateInfo, nullptr, &m_SimSetLayout));
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(SimPushConstants);
+
+    std::array<VkDescriptorSetLayout, 2> pipelineSetLayouts = { m_SimSetLayout, m_FrameSetLayout };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+    pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutCreateInfo.setLayoutCount = static_cast<uint32_t>(pipelineSetLayouts.size());
+    pipelineLayoutCreateInfo.pSetLayouts = pipelineSetLayouts.data();
+    pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+
+    VK_CHECK(m_Disp.createPipelineLayout(&pipelineLayoutCreateInfo, nullptr, &m_SimPipelineLayout));
+
+    const uint32_t simSetCount = static_cast<uint32_t>(m_SimDescriptorSets.size());
+
+    std::array<VkDescriptorPoolSize, 2> pool_sizes = { {
+        { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2 * simSetCount },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, simSetCount },
+    } };
+
+    VkDescriptorPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.maxSets = simSetCount;
+    pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+    pool_info.pPoolSizes = pool_sizes.data();
+
+    VK_CHECK(m_Disp.createDescriptorPool(&pool_info, nullptr, &m_SimDescriptorPool));
+
+    std::vector<VkDescriptorSetLayout> setLayouts(simSetCount, m_SimSetLayout);
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_SimDescriptorPool;
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(setLayouts.size());
+    allocInfo.pSetLayouts = setLayouts.data();
+
+    VK_CHECK(m_Disp.allocateDescriptorSets(&allocInfo, m_SimDescriptorSets.data()));
+
+    for (uint32_t i = 0; i < simSetCount; i++)
+    {
+        VkDescriptorImageInfo srcInfo{ VK_NULL_HANDLE, m_SimImages[i / SIM_IMAGE_COUNT].ImageView, VK_IMAGE_LAYOUT_GENERAL };
+        VkDescriptorImageInfo dstInfo{ VK_NULL_HANDLE, m_SimImages[i % SIM_IMAGE_COUNT].ImageView, VK_IMAGE_LAYOUT_GENERAL };
+        VkDescriptorBufferInfo bufferInfo{ m_SimBuffer.Buffer, 0, VK_WHOLE_SIZE };
+
+        std::array<VkWriteDescriptorSet, 3> writes{};
+        for (uint32_t b = 0; b < writes.size(); b++)
+        {
+            writes[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[b].dstSet = m_SimDescriptorSets[i];
+            writes[b].dstBinding = b;
+            writes[b].descriptorCount = 1;
+        }
+        writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[0].pImageInfo = &srcInfo;
+        writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[1].pImageInfo = &dstInfo;
+        writes[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[2].pBufferInfo = &bufferInfo;
+
+        m_Disp.updateDescriptorSets(static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    ImmediateSubmit([&](VkCommandBuffer commandBuffer) {
+        std::array<VkImageMemoryBarrier, SIM_IMAGE_COUNT> imageBarriers{};
+        for (uint32_t i = 0; i < SIM_IMAGE_COUNT; i++)
+        {
+            imageBarriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            imageBarriers[i].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageBarriers[i].newLayout = VK_IMAGE_LAYOUT_GENERAL;
+            imageBarriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarriers[i].image = m_SimImages[i].Image;
+            imageBarriers[i].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+            imageBarriers[i].srcAccessMask = 0;
+            imageBarriers[i].dstAccessMask = 0;
+        }
+
+        m_Disp.cmdFillBuffer(commandBuffer, m_SimBuffer.Buffer, 0, VK_WHOLE_SIZE, 0);
+
+        VkMemoryBarrier fillBarrier{};
+        fillBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        fillBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        fillBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+            0,
+            1, &fillBarrier,
+            0, nullptr,
+            static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+    });
+
+    m_SimOutputIndex = 0;
+    m_SimDisplayIndex = 0;
+
+    CreateSimulationPipelines();
+}
+
+void VulkanCore::CreateSimulationPipelines()
+{
+    CreatePassPipelines(CompileShaderPasses(SHADER_PASS_SIMULATION, m_SpirvRecipe, m_SimSettings.WorkgroupSize));
+}
+
+void VulkanCore::CreateBindlessTable()
+{
+    VkSamplerCreateInfo sampler_info{};
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.magFilter = VK_FILTER_LINEAR;
+    sampler_info.minFilter = VK_FILTER_LINEAR;
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.minLod = 0;
+    sampler_info.maxLod = 1000;
+    sampler_info.maxAnisotropy = 1.0f;
+
+    VK_CHECK(m_Disp.createSampler(&sampler_info, nullptr, &m_ChannelSampler));
+
+    std::array<VkDescriptorPoolSize, 3> pool_sizes = { {
+        { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2 * BINDLESS_IMAGE_COUNT },
+        { VK_DESCRIPTOR_TYPE_SAMPLER, BINDLESS_SAMPLER_COUNT },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 },
+    } };
+
+    VkDescriptorPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    pool_info.maxSets = 1;
+    pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+    pool_info.pPoolSizes = pool_sizes.data();
+
+    VK_CHECK(m_Disp.createDescriptorPool(&pool_info, nullptr, &m_BindlessDescriptorPool));
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_BindlessDescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_BindlessSetLayout;
+
+    VK_CHECK(m_Disp.allocateDescriptorSets(&allocInfo, &m_BindlessDescriptorSet));
+
+    VkDescriptorImageInfo samplerInfo{ m_ChannelSampler, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED };
+    VkDescriptorBufferInfo bufferInfo{ m_SimBuffer.Buffer, 0, VK_WHOLE_SIZE };
+
+    std::array<VkWriteDescriptorSet, 2> writes{};
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = m_BindlessDescriptorSet;
+    writes[0].dstBinding = 2;
+    writes[0].dstArrayElement = 0;
+    writes[0].descriptorCount = 1;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+    writes[0].pImageInfo = &samplerInfo;
+    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[1].dstSet = m_BindlessDescriptorSet;
+    writes[1].dstBinding = 3;
+    writes[1].descriptorCount = 1;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[1].pBufferInfo = &bufferInfo;
+
+    m_Disp.updateDescriptorSets(static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+    m_CubemapSlot = RegisterBindlessImage(BindlessImageType::TextureCube, m_CubemapImage.ImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    for (uint32_t i = 0; i < SIM_OUTPUT_IMAGE_COUNT; i++)
+        m_SimChannelSlots[i] = RegisterBindlessImage(BindlessImageType::Texture2D, m_SimImages[i].ImageView, VK_IMAGE_LAYOUT_GENERAL);
+}
+
+uint32_t VulkanCore::RegisterBindlessImage(BindlessImageType type, VkImageView view, VkImageLayout layout)
+{
+    uint32_t& count = m_BindlessImageCount[static_cast<size_t>(type)];
+
+    if (count >= BINDLESS_IMAGE_COUNT)
+    {
+        debug_log("Bindless channel table is full !");
+        return BINDLESS_INVALID_SLOT;
+    }
+
+    uint32_t slot = count++;
+    WriteBindlessImage(type, slot, view, layout);
+
+    return slot;
+}
+
+void VulkanCore::WriteBindlessImage(BindlessImageType type, uint32_t slot, VkImageView view, VkImageLayout layout)
+{
+    if (slot == BINDLESS_INVALID_SLOT)
+        return;
+
+    VkDescriptorImageInfo imageInfo{ VK_NULL_HANDLE, view, layout };
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = m_BindlessDescriptorSet;
+    write.dstBinding = type == BindlessImageType::Texture2D ? 0 : 1;
+    write.dstArrayElement = slot;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    write.pImageInfo = &imageInfo;
+
+    m_Disp.updateDescriptorSets(1, &write, 0, nullptr);
+
+    m_DescriptorWriteCount++;
+}
+
+glm::uvec4 VulkanCore::GetChannelSlots() const
+{
+    // iChannel0 = Cube A, iChannel1 = simulation state shown this frame
+    return glm::uvec4(m_CubemapSlot, m_SimChannelSlots[m_SimDisplayIndex], BINDLESS_INVALID_SLOT, BINDLESS_INVALID_SLOT);
+}
+
+void VulkanCore::DrawChannelsPanel()
+{
+    ImGui::Begin("Channels");
+
+    ImGui::Text("iChannel0 : Cube A (cube slot %u)", m_CubemapSlot);
+    ImGui::Text("iChannel1 : Simulation (2D slot %u)", m_SimChannelSlots[m_SimDisplayIndex]);
+    ImGui::Text("Table : %u / %u 2D, %u / %u cube", 
+        m_BindlessImageCount[static_cast<size_t>(BindlessImageType::Texture2D)], BINDLESS_IMAGE_COUNT,
+        m_BindlessImageCount[static_cast<size_t>(BindlessImageType::TextureCube)], BINDLESS_IMAGE_COUNT);
+    ImGui::Text("Descriptor writes : %u", m_DescriptorWritesLastFrame);
+
+    const uint32_t cubemapSizes[] = { 256u, 512u, 1024u, 2048u };
+    const char* cubemapSizeNames[] = { "256", "512", "1024", "2048" };
+
+    int cubemapSizeIndex = 0;
+    for (int i = 0; i < IM_ARRAYSIZE(cubemapSizes); i++)
+        if (cubemapSizes[i] == m_CubemapSize)
+            cubemapSizeIndex = i;
+
+    // Reallocating Cube A only rewrites its slot of the table
+    if (ImGui::Combo("Cube A size", &cubemapSizeIndex, cubemapSizeNames, IM_ARRAYSIZE(cubemapSizeNames)))
+    {
+        m_Disp.deviceWaitIdle();
+
+        CreateCubemapTarget(cubemapSizes[cubemapSizeIndex]);
+    }
+
+    ImGui::End();
+}
+
+void VulkanCore::CreateTimestampQueries()
+{
+    const VkPhysicalDeviceLimits& limits = m_Device.physical_device.properties.limits;
+    m_TimestampPeriod = limits.timestampPeriod;
+
+    // Without timestampComputeAndGraphics, a queue family whose timestampValidBits is 0 has no timestamps
+    const uint32_t graphicsBits = m_Device.queue_families[m_Device.get_queue_index(vkb::QueueType::graphics).value()].timestampValidBits;
+    const uint32_t computeBits = m_ComputeQueue != VK_NULL_HANDLE ? m_Device.queue_families[m_ComputeQueueFamily].timestampValidBits : 0u;
+    m_GraphicsTimestamps = limits.timestampComputeAndGraphics || graphicsBits > 0;
+    m_ComputeTimestamps = m_ComputeQueue != VK_NULL_HANDLE && (limits.timestampComputeAndGraphics || computeBits > 0);
+
+    // The counters wrap at timestampValidBits, deltas are taken modulo the narrowest counter
+    uint32_t validBits = 64u;
+    for (uint32_t bits : { graphicsBits, computeBits })
+        if (bits > 0)
+            validBits = std::min(validBits, bits);
+    m_TimestampMask = validBits >= 64u ? ~0ull : (1ull << validBits) - 1ull;
+
+    if (!m_GraphicsTimestamps)
+        debug_log("The graphics queue has no timestamps, GPU timings disabled");
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = MAX_FRAMES_IN_FLIGHT * TIMESTAMPS_PER_FRAME;
+
+    VK_CHECK(m_Disp.createQueryPool(&queryPoolInfo, nullptr, &m_TimestampQueryPool));
+}
+
+void VulkanCore::CreateUniformRing(uint32_t subFrameCount)
+{
+    const VkDeviceSize alignment = m_Device.physical_device.properties.limits.minUniformBufferOffsetAlignment;
+    m_UniformRingStride = (sizeof(ShaderInputs) + alignment - 1) & ~(alignment - 1);
+    m_UniformSlicesPerFrame = subFrameCount > 1 ? subFrameCount + 1 : 1;
+
+    VkBufferCreateInfo bufferCreateInfo{};
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.size = m_UniformRingStride * MAX_FRAMES_IN_FLIGHT * m_UniformSlicesPerFrame;
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    // Prefers host visible device local memory (ReBAR) when available, written sequentially once per frame
+    VmaAllocationCreateInfo allocCreateInfo = {};
+    allocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
+    allocCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VmaAllocationInfo allocInfo{};
+    VK_CHECK(vmaCreateBuffer(m_Allocator, &bufferCreateInfo, &allocCreateInfo, &m_UniformRing.Buffer, &m_UniformRing.BufferAllocation, &allocInfo));
+
+    m_UniformRingData = static_cast<uint8_t*>(allocInfo.pMappedData);
+
+    VkDescriptorPoolSize pool_size = { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 };
+
+    VkDescriptorPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.maxSets = 1;
+    pool_info.poolSizeCount = 1;
+    pool_info.pPoolSizes = &pool_size;
+
+    VK_CHECK(m_Disp.createDescriptorPool(&pool_info, nullptr, &m_FrameDescriptorPool));
+
+    VkDescriptorSetAllocateInfo setAllocInfo{};
+    setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    setAllocInfo.descriptorPool = m_FrameDescriptorPool;
+    setAllocInfo.descriptorSetCount = 1;
+    setAllocInfo.pSetLayouts = &m_FrameSetLayout;
+
+    VK_CHECK(m_Disp.allocateDescriptorSets(&setAllocInfo, &m_FrameDescriptorSet));
+
+    VkDescriptorBufferInfo bufferInfo{ m_UniformRing.Buffer, 0, sizeof(ShaderInputs) };
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = m_FrameDescriptorSet;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    write.pBufferInfo = &bufferInfo;
+
+    m_Disp.updateDescriptorSets(1, &write, 0, nullptr);
+}
+
 void VulkanCore::InitImGui()
 {
     // Setup Dear ImGui context
@@ -587,15 +1913,11 @@ void VulkanCore::InitImGui()
     VK_CHECK(m_Disp.createSampler(&sampler_info, nullptr, &m_ImGuiSampler));
 }
 
-void VulkanCore::RecordCommandBuffer(uint32_t imageIndex, ImDrawData* imGui_draw_data)
+void VulkanCore::RecordCubemapPass(VkCommandBuffer commandBuffer)
 {
-    VkCommandBufferBeginInfo beginInfo;
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.pNext = NULL;
-    beginInfo.flags = 0;
-    beginInfo.pInheritanceInfo = NULL; //ignored if VK_COMMAND_BUFFER_LEVEL_PRIMARY
-
-    VK_CHECK(m_Disp.beginCommandBuffer(m_CommandBuffers[m_CurrentFrame], &beginInfo));
+    // Without a cube shader the target only needs to be cleared once so that it can be sampled
+    if (m_CubemapPipeline == VK_NULL_HANDLE && m_CubemapInitialized)
+        return;
 
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -603,103 +1925,98 @@ void VulkanCore::RecordCommandBuffer(uint32_t imageIndex, ImDrawData* imGui_draw
     barrier.newLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL_KHR;
     barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = m_RTImages[m_CurrentFrame].Image;
+    barrier.image = m_CubemapImage.Image;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseMipLevel = 0;
     barrier.subresourceRange.levelCount = 1;
     barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
+    barrier.subresourceRange.layerCount = 6;
     barrier.srcAccessMask = 0;
     barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
+    // The previous frame's Image pass may still be sampling the cubemap
     vkCmdPipelineBarrier(
-        m_CommandBuffers[m_CurrentFrame],
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        commandBuffer,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
         0,
         0, nullptr,
         0, nullptr,
         1, &barrier);
 
-    VkRenderingAttachmentInfoKHR color_attachment_info;
+    VkRenderingAttachmentInfoKHR color_attachment_info{};
     color_attachment_info.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
-    color_attachment_info.pNext = nullptr;
-    color_attachment_info.imageView = m_RTImages[m_CurrentFrame].ImageView;
+    color_attachment_info.imageView = m_CubemapAttachmentView;
     color_attachment_info.imageLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL_KHR;
     color_attachment_info.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     color_attachment_info.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     color_attachment_info.clearValue = { { { 0.0f, 0.0f, 0.0f, 1.0f } } };
     color_attachment_info.resolveMode = VK_RESOLVE_MODE_NONE;
-    color_attachment_info.resolveImageView = VK_NULL_HANDLE;
-    color_attachment_info.resolveImageLayout = VK_IMAGE_LAYOUT_GENERAL;
 
-    VkExtent2D ImageExtent = { m_RTWidth, m_RTHeight };
+    VkExtent2D faceExtent = { m_CubemapSize, m_CubemapSize };
 
-    VkRenderingInfoKHR render_info;
+    VkRenderingInfoKHR render_info{};
     render_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
-    render_info.pNext = nullptr;
-    render_info.flags = 0;
     render_info.renderArea.offset = { 0, 0 };
-    render_info.renderArea.extent = ImageExtent;
-    render_info.layerCount = 1;
-    render_info.viewMask = 0;
+    render_info.renderArea.extent = faceExtent;
+    render_info.layerCount = 1; // ignored when viewMask != 0
+    render_info.viewMask = CUBEMAP_VIEW_MASK;
     render_info.colorAttachmentCount = 1;
     render_info.pColorAttachments = &color_attachment_info;
-    render_info.pDepthAttachment = nullptr;
-    render_info.pStencilAttachment = nullptr;
 
-    m_Disp.cmdBeginRendering(m_CommandBuffers[m_CurrentFrame], &render_info);
+    m_Disp.cmdBeginRendering(commandBuffer, &render_info);
 
-    VkViewport viewport;
-    viewport.x = 0.0;
-    viewport.y = 0.0;
-    viewport.width = static_cast<float>(ImageExtent.width);
-    viewport.height = static_cast<float>(ImageExtent.height);
-    viewport.minDepth = 0.0;
-    viewport.maxDepth = 1.f;
+    if (m_CubemapPipeline != VK_NULL_HANDLE)
+    {
+        VkViewport viewport;
+        viewport.x = 0.0;
+        viewport.y = 0.0;
+        viewport.width = static_cast<float>(faceExtent.width);
+        viewport.height = static_cast<float>(faceExtent.height);
+        viewport.minDepth = 0.0;
+        viewport.maxDepth = 1.f;
 
-    m_Disp.cmdSetViewport(m_CommandBuffers[m_CurrentFrame], 0, 1, &viewport);
+        m_Disp.cmdSetViewport(commandBuffer, 0, 1, &viewport);
 
-    VkRect2D scissor;
-    scissor.offset = { 0, 0 };
-    scissor.extent = ImageExtent;
+        VkRect2D scissor;
+        scissor.offset = { 0, 0 };
+        scissor.extent = faceExtent;
 
-    m_Disp.cmdSetScissor(m_CommandBuffers[m_CurrentFrame], 0, 1, &scissor);
+        m_Disp.cmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-    m_Disp.cmdBindPipeline(m_CommandBuffers[m_CurrentFrame], VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicPipeline);
+        m_Disp.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_CubemapPipeline);
 
-    PushConstants pc{};
-    GetPushConstant(pc);
+        m_Disp.cmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicPipelineLayout,
+            0, 1, &m_BindlessDescriptorSet, 0, nullptr);
 
-    vkCmdPushConstants(
-        m_CommandBuffers[m_CurrentFrame],
-        m_GraphicPipelineLayout,
-        VK_SHADER_STAGE_FRAGMENT_BIT,
-        0,
-        sizeof(PushConstants),
-        &pc
-    );
+        BindShaderInputs(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicPipelineLayout);
 
-    m_Disp.cmdDraw(m_CommandBuffers[m_CurrentFrame], 3, 1, 0, 0);
+        PushConstants pc{};
+        pc.iResolution = glm::vec3(faceExtent.width, faceExtent.height, 1.f);
+        // Cube A can't sample itself
+        pc.iChannels = glm::uvec4(BINDLESS_INVALID_SLOT, m_SimChannelSlots[m_SimDisplayIndex], BINDLESS_INVALID_SLOT, BINDLESS_INVALID_SLOT);
 
-    m_Disp.cmdEndRendering(m_CommandBuffers[m_CurrentFrame]);
+        vkCmdPushConstants(
+            commandBuffer,
+            m_GraphicPipelineLayout,
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            0,
+            sizeof(PushConstants),
+            &pc
+        );
+
+        m_Disp.cmdDraw(commandBuffer, 3, 1, 0, 0);
+    }
+
+    m_Disp.cmdEndRendering(commandBuffer);
 
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.oldLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL_KHR;
     barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = m_RTImages[m_CurrentFrame].Image;
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
     barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
     barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
     vkCmdPipelineBarrier(
-        m_CommandBuffers[m_CurrentFrame],
+        commandBuffer,
         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
         0,
@@ -707,19 +2024,570 @@ void VulkanCore::RecordCommandBuffer(uint32_t imageIndex, ImDrawData* imGui_draw
         0, nullptr,
         1, &barrier);
 
-    //ImGui Render
+    m_CubemapInitialized = true;
+}
 
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = m_SwapchainImages[imageIndex];
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
+void VulkanCore::RecordSimulationPass(VkCommandBuffer commandBuffer, bool onComputeQueue)
+{
+    const bool useCompute = m_SimSettings.Backend == SimulationBackend::Compute;
+    VkPipeline pipeline = useCompute ? m_SimComputePipeline : m_SimFragmentPipeline;
+
+    if (pipeline == VK_NULL_HANDLE || !m_Playing)
+        return;
+
+    const VkPipelineStageFlags writerStage = useCompute ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    const VkPipelineStageFlags readerStage = useCompute ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    const VkAccessFlags writerAccess = useCompute ? VK_ACCESS_SHADER_WRITE_BIT : VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    const bool writeTimestamps = onComputeQueue ? m_ComputeTimestamps : m_GraphicsTimestamps;
+    const uint32_t firstQuery = m_CurrentFrame * TIMESTAMPS_PER_FRAME;
+
+    if (writeTimestamps)
+    {
+        m_Disp.cmdResetQueryPool(commandBuffer, m_TimestampQueryPool, firstQuery, 2);
+        m_Disp.cmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_TimestampQueryPool, firstQuery + 0);
+    }
+
+    // WAR against the previous frame : its simulation steps and the Image pass sampling the state.
+    // On the compute queue the Image pass is covered by the graphics timeline wait instead.
+    VkMemoryBarrier memoryBarrier{};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | (onComputeQueue ? 0 : VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+    memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | writerAccess;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        onComputeQueue ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+            : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        readerStage | writerStage,
+        0,
+        1, &memoryBarrier,
+        0, nullptr,
+        0, nullptr);
+
+    const VkPipelineBindPoint bindPoint = useCompute ? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+    m_Disp.cmdBindPipeline(commandBuffer, bindPoint, pipeline);
+
+    BindShaderInputs(commandBuffer, bindPoint, m_SimPipelineLayout);
+
+    SimPushConstants pc{};
+    pc.Pass.iResolution = glm::vec3(m_RTWidth, m_RTHeight, 1.f);
+    pc.iGridSize = m_SimSettings.GridSize;
+
+    VkExtent2D gridExtent = { m_SimSettings.GridSize.x, m_SimSettings.GridSize.y };
+
+    if (!useCompute)
+    {
+        VkViewport viewport = { 0.f, 0.f, static_cast<float>(gridExtent.width), static_cast<float>(gridExtent.height), 0.f, 1.f };
+        VkRect2D scissor = { { 0, 0 }, gridExtent };
+
+        m_Disp.cmdSetViewport(commandBuffer, 0, 1, &viewport);
+        m_Disp.cmdSetScissor(commandBuffer, 0, 1, &scissor);
+    }
+
+    // Start from the latest output, bounce between the intermediate images and finish in the other output,
+    // so the output still sampled by an in-flight Image pass is never overwritten
+    const uint32_t previousOutput = m_SimOutputIndex;
+    const uint32_t nextOutput = 1 - previousOutput;
+    const int steps = m_SimSettings.StepsPerFrame;
+
+    for (int step = 0; step < steps; step++)
+    {
+        const uint32_t src = step == 0 ? previousOutput : SIM_OUTPUT_IMAGE_COUNT + ((step - 1) & 1);
+        const uint32_t dst = step == steps - 1 ? nextOutput : SIM_OUTPUT_IMAGE_COUNT + (step & 1);
+
+        if (step > 0)
+        {
+            memoryBarrier.srcAccessMask = writerAccess;
+            memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | writerAccess;
+
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                writerStage,
+                readerStage | writerStage,
+                0,
+                1, &memoryBarrier,
+                0, nullptr,
+                0, nullptr);
+        }
+
+        m_Disp.cmdBindDescriptorSets(commandBuffer, bindPoint, m_SimPipelineLayout, 0, 1, &m_SimDescriptorSets[src * SIM_IMAGE_COUNT + dst], 0, nullptr);
+
+        pc.iStep = static_cast<uint32_t>(step);
+
+        vkCmdPushConstants(
+            commandBuffer,
+            m_SimPipelineLayout,
+            VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+            0,
+            sizeof(SimPushConstants),
+            &pc
+        );
+
+        if (useCompute)
+        {
+            glm::uvec2 groupCount = (m_SimSettings.GridSize + m_SimSettings.WorkgroupSize - 1u) / m_SimSettings.WorkgroupSize;
+            m_Disp.cmdDispatch(commandBuffer, groupCount.x, groupCount.y, 1);
+        }
+        else
+        {
+            VkRenderingAttachmentInfoKHR color_attachment_info{};
+            color_attachment_info.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+            color_attachment_info.imageView = m_SimImages[dst].ImageView;
+            color_attachment_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+            color_attachment_info.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            color_attachment_info.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+            color_attachment_info.resolveMode = VK_RESOLVE_MODE_NONE;
+
+            VkRenderingInfoKHR render_info{};
+            render_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+            render_info.renderArea.extent = gridExtent;
+            render_info.layerCount = 1;
+            render_info.colorAttachmentCount = 1;
+            render_info.pColorAttachments = &color_attachment_info;
+
+            m_Disp.cmdBeginRendering(commandBuffer, &render_info);
+            m_Disp.cmdDraw(commandBuffer, 3, 1, 0, 0);
+            m_Disp.cmdEndRendering(commandBuffer);
+        }
+    }
+
+    m_SimOutputIndex = nextOutput;
+
+    // Make the final state and the buffer visible to the fragment passes reading them,
+    // across queues the timeline semaphore signal does it
+    if (!onComputeQueue)
+    {
+        memoryBarrier.srcAccessMask = writerAccess;
+        memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            writerStage,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0,
+            1, &memoryBarrier,
+            0, nullptr,
+            0, nullptr);
+    }
+
+    if (writeTimestamps)
+    {
+        m_Disp.cmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_TimestampQueryPool, firstQuery + 1);
+
+        m_TimestampsHaveSim[m_CurrentFrame] = true;
+        m_TimestampsBackend[m_CurrentFrame] = m_SimSettings.Backend;
+    }
+}
+
+bool VulkanCore::UseAsyncCompute() const
+{
+    return m_SimSettings.AsyncCompute && m_SimSettings.Backend == SimulationBackend::Compute
+        && m_ComputeQueue != VK_NULL_HANDLE && m_SimComputePipeline != VK_NULL_HANDLE;
+}
+
+void VulkanCore::SubmitSimulation()
+{
+    // Synchronous path : recorded into the graphics command buffer by RecordCommandBuffer
+    if (!UseAsyncCompute())
+    {
+        m_SimWaitValue = m_SimTimelineValue;
+        return;
+    }
+
+    // The Image pass of this frame samples the output of the previous simulation frame
+    m_SimDisplayIndex = m_SimOutputIndex;
+    m_SimWaitValue = m_SimTimelineValue;
+
+    if (!m_Playing)
+        return;
+
+    // The command buffer of this slot may still be executing, the graphics fence does not cover it
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &m_SimTimeline;
+    waitInfo.pValues = &m_SimSlotValues[m_CurrentFrame];
+
+    VK_CHECK(m_Disp.waitSemaphores(&waitInfo, UINT64_MAX));
+
+    VkCommandBuffer commandBuffer = m_ComputeCommandBuffers[m_CurrentFrame];
+
+    VK_CHECK(m_Disp.resetCommandBuffer(commandBuffer, 0));
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VK_CHECK(m_Disp.beginCommandBuffer(commandBuffer, &beginInfo));
+
+    RecordSimulationPass(commandBuffer, true);
+
+    VK_CHECK(m_Disp.endCommandBuffer(commandBuffer));
+
+    // Wait for every graphics frame already submitted : the previous Image pass may still sample the output we overwrite
+    const uint64_t waitValue = m_GraphicsTimelineValue;
+    const uint64_t signalValue = ++m_SimTimelineValue;
+    const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+    VkTimelineSemaphoreSubmitInfo timelineSubmitInfo{};
+    timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineSubmitInfo.waitSemaphoreValueCount = 1;
+    timelineSubmitInfo.pWaitSemaphoreValues = &waitValue;
+    timelineSubmitInfo.signalSemaphoreValueCount = 1;
+    timelineSubmitInfo.pSignalSemaphoreValues = &signalValue;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineSubmitInfo;
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = &m_GraphicsTimeline;
+    submitInfo.pWaitDstStageMask = &waitStage;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &m_SimTimeline;
+
+    VK_CHECK(m_Disp.queueSubmit(m_ComputeQueue, 1, &submitInfo, VK_NULL_HANDLE));
+
+    m_SimSlotValues[m_CurrentFrame] = signalValue;
+}
+
+// Milliseconds between two timestamps of the same queue
+float VulkanCore::TimestampDeltaMs(uint64_t begin, uint64_t end) const
+{
+    return ((end - begin) & m_TimestampMask) * m_TimestampPeriod * 1e-6f;
+}
+
+void VulkanCore::ReadTimestamps(uint32_t frameIndex)
+{
+    if (!m_TimestampsWritten[frameIndex] && !m_TimestampsHaveSim[frameIndex])
+        return;
+
+    const float alpha = 0.05f;
+    auto accumulate = [alpha](float& average, float value) {
+        average = average < 0.f ? value : value * alpha + (1.f - alpha) * average;
+    };
+
+    std::array<uint64_t, 2> timestamps{};
+    const uint32_t firstQuery = frameIndex * TIMESTAMPS_PER_FRAME;
+
+    if (m_TimestampsHaveSim[frameIndex] &&
+        m_Disp.getQueryPoolResults(m_TimestampQueryPool, firstQuery, 2, sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+    {
+        accumulate(m_SimGpuTimeMs[static_cast<size_t>(m_TimestampsBackend[frameIndex])], TimestampDeltaMs(timestamps[0], timestamps[1]));
+    }
+
+    if (m_TimestampsWritten[frameIndex] &&
+        m_Disp.getQueryPoolResults(m_TimestampQueryPool, firstQuery + 2, 2, sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+    {
+        accumulate(m_ImageGpuTimeMs, TimestampDeltaMs(timestamps[0], timestamps[1]));
+    }
+
+    m_TimestampsWritten[frameIndex] = false;
+    m_TimestampsHaveSim[frameIndex] = false;
+}
+
+void VulkanCore::DrawSimulationPanel()
+{
+    if (m_SimComputePipeline == VK_NULL_HANDLE && m_SimFragmentPipeline == VK_NULL_HANDLE)
+        return;
+
+    ImGui::Begin("Simulation");
+
+    int backend = static_cast<int>(m_SimSettings.Backend);
+    if (m_SimComputePipeline != VK_NULL_HANDLE)
+    {
+        ImGui::RadioButton("Compute", &backend, static_cast<int>(SimulationBackend::Compute));
+        ImGui::SameLine();
+    }
+    if (m_SimFragmentPipeline != VK_NULL_HANDLE)
+        ImGui::RadioButton("Fragment", &backend, static_cast<int>(SimulationBackend::Fragment));
+    m_SimSettings.Backend = static_cast<SimulationBackend>(backend);
+
+    ImGui::SliderInt("Steps per frame", &m_SimSettings.StepsPerFrame, 1, 64);
+
+    if (m_ComputeQueue != VK_NULL_HANDLE)
+    {
+        if (ImGui::Checkbox("Async compute queue", &m_SimSettings.AsyncCompute))
+            m_Disp.deviceWaitIdle();
+    }
+    else
+    {
+        ImGui::TextDisabled("Async compute queue : unavailable");
+    }
+
+    // Only the sizes within the device limits are listed
+    const std::array<glm::uvec2, 4> allWorkgroupSizes = { glm::uvec2(8u, 8u), glm::uvec2(16u, 16u), glm::uvec2(32u, 8u), glm::uvec2(32u, 32u) };
+    const std::array<const char*, 4> allWorkgroupNames = { "8x8", "16x16", "32x8", "32x32" };
+
+    std::vector<glm::uvec2> workgroupSizes;
+    std::vector<const char*> workgroupNames;
+    for (size_t i = 0; i < allWorkgroupSizes.size(); i++)
+    {
+        if (IsWorkgroupSizeSupported(allWorkgroupSizes[i]))
+        {
+            workgroupSizes.push_back(allWorkgroupSizes[i]);
+            workgroupNames.push_back(allWorkgroupNames[i]);
+        }
+    }
+
+    int workgroupIndex = 0;
+    for (int i = 0; i < static_cast<int>(workgroupSizes.size()); i++)
+        if (workgroupSizes[i] == m_SimSettings.WorkgroupSize)
+            workgroupIndex = i;
+
+    if (ImGui::Combo("Workgroup size", &workgroupIndex, workgroupNames.data(), static_cast<int>(workgroupNames.size())))
+    {
+        m_Disp.deviceWaitIdle();
+
+        m_SimSettings.WorkgroupSize = workgroupSizes[workgroupIndex];
+
+        m_Disp.destroyPipeline(m_SimComputePipeline, nullptr);
+        m_Disp.destroyPipeline(m_SimFragmentPipeline, nullptr);
+        m_SimComputePipeline = VK_NULL_HANDLE;
+        m_SimFragmentPipeline = VK_NULL_HANDLE;
+
+        CreateSimulationPipelines();
+
+        m_SimGpuTimeMs[static_cast<size_t>(SimulationBackend::Compute)] = -1.f;
+    }
+
+    ImGui::Separator();
+
+    for (SimulationBackend b : { SimulationBackend::Compute, SimulationBackend::Fragment })
+    {
+        float time = m_SimGpuTimeMs[static_cast<size_t>(b)];
+        const char* name = b == SimulationBackend::Compute ? "Compute" : "Fragment";
+
+        if (time >= 0.f)
+            ImGui::Text("%s : %.3f ms (%.3f ms/step)", name, time, time / m_SimSettings.StepsPerFrame);
+        else
+            ImGui::Text("%s : -", name);
+    }
+
+    if (m_ImageGpuTimeMs >= 0.f)
+        ImGui::Text("Image pass : %.3f ms", m_ImageGpuTimeMs);
+
+    ImGui::Text("Frame : %.3f ms (%s)", m_fps > 0.f ? 1000.f / m_fps : 0.f, UseAsyncCompute() ? "async" : "serialized");
+
+    ImGui::End();
+}
+
+void VulkanCore::DrawProgressivePanel()
+{
+    ImGui::Begin("Progressive");
+
+    if (ImGui::Checkbox("Accumulate", &m_Progressive.Enabled))
+    {
+        if (m_Progressive.Enabled)
+        {
+            CreateProgressivePipeline();
+
+            if (m_ProgressivePipeline == VK_NULL_HANDLE)
+            {
+                m_Progressive.Enabled = false;
+            }
+            else
+            {
+                CreateProgressiveTarget(m_RTWidth, m_RTHeight);
+                m_Playing = false;  // a moving iTime restarts the average every frame
+            }
+        }
+        else
+        {
+            // The frames in flight may still accumulate into the target or show it
+            m_Disp.deviceWaitIdle();
+            DestroyProgressiveTarget();
+        }
+
+        ResetProgressive();
+    }
+
+    ImGui::InputInt("Max samples", &m_Progressive.MaxSamples);
+    m_Progressive.MaxSamples = std::max(m_Progressive.MaxSamples, 0);
+
+    ImGui::InputFloat("Target variance", &m_Progressive.TargetVariance, 0.f, 0.f, "%.2e");
+    m_Progressive.TargetVariance = std::max(m_Progressive.TargetVariance, 0.f);
+
+    if (m_Progressive.Enabled)
+    {
+        ImGui::Separator();
+
+        ImGui::Text("Samples : %u", m_ProgressiveSamples);
+
+        if (m_ProgressiveVariance >= 0.f)
+            ImGui::Text("Variance : %.3e", m_ProgressiveVariance);
+        else
+            ImGui::Text("Variance : -");
+
+        if (IsProgressiveConverged())
+            ImGui::Text("Converged, GPU idle");
+    }
+
+    ImGui::End();
+}
+
+void VulkanCore::DrawShaderPanel()
+{
+    ImGui::Begin("Shader");
+
+    const char* recipeNames[SPIRV_RECIPE_COUNT];
+    for (uint32_t i = 0; i < SPIRV_RECIPE_COUNT; i++)
+        recipeNames[i] = SPIRV_RECIPES[i].Name;
+
+    // Every pass is compiled again, recipes seen before come from the SPIR-V cache
+    int recipe = static_cast<int>(m_SpirvRecipe);
+    if (ImGui::Combo("SPIR-V recipe", &recipe, recipeNames, static_cast<int>(SPIRV_RECIPE_COUNT)))
+    {
+        SetSpirvRecipe(static_cast<uint32_t>(recipe));
+        ReloadShader();
+    }
+
+    if (SPIRV_RECIPES[m_SpirvRecipe].OptimizerPasses)
+        ImGui::TextWrapped("spirv-opt %s", SPIRV_RECIPES[m_SpirvRecipe].OptimizerPasses);
+
+    ImGui::Text("Watched files : %u", static_cast<uint32_t>(m_ShaderFilePasses.size()));
+
+    if (m_ShaderReload.valid() || m_PendingShaderPasses != 0)
+        ImGui::Text("Compiling...");
+
+    if (!m_ImageSpecConstants.empty())
+    {
+        ImGui::SeparatorText("Specialization constants");
+
+        // Only the pipeline is rebuilt, from the kept module. Typed and dragged values are applied once the edit ends,
+        // not for every keystroke or drag step
+        bool changed = false;
+        for (SpecConstant& constant : m_ImageSpecConstants)
+        {
+            ImGui::PushID(static_cast<int>(constant.Id));
+
+            switch (constant.Type)
+            {
+            case SpecConstantType::Bool:
+            {
+                bool value = constant.Value != 0;
+                if (ImGui::Checkbox(constant.Name.c_str(), &value))
+                {
+                    constant.Value = value ? 1u : 0u;
+                    changed = true;
+                }
+                break;
+            }
+            case SpecConstantType::Int:
+            case SpecConstantType::UInt:
+            {
+                int value = static_cast<int>(constant.Value);
+                if (ImGui::InputInt(constant.Name.c_str(), &value))
+                {
+                    if (constant.Type == SpecConstantType::UInt)
+                        value = std::max(value, 0);
+                    constant.Value = static_cast<uint32_t>(value);
+                }
+                changed |= ImGui::IsItemDeactivatedAfterEdit();
+                break;
+            }
+            case SpecConstantType::Float:
+            {
+                float value = std::bit_cast<float>(constant.Value);
+                if (ImGui::DragFloat(constant.Name.c_str(), &value, 0.01f))
+                    constant.Value = std::bit_cast<uint32_t>(value);
+                changed |= ImGui::IsItemDeactivatedAfterEdit();
+                break;
+            }
+            }
+
+            ImGui::PopID();
+        }
+
+        if (ImGui::Button("Defaults"))
+        {
+            for (SpecConstant& constant : m_ImageSpecConstants)
+                constant.Value = constant.Default;
+            changed = true;
+        }
+
+        if (changed)
+        {
+            SelectImageVariant();
+            ResetProgressive();
+        }
+
+        ImGui::SameLine();
+        ImGui::Text("Variants : %u / %u", static_cast<uint32_t>(m_ImageVariants.size()), IMAGE_VARIANT_CACHE_SIZE);
+    }
+
+    ImGui::SeparatorText("Image pass backend");
+
+    ImGui::BeginDisabled(!m_ShaderObjectSupported);
+    bool shaderObjects = m_UseShaderObjects;
+    if (ImGui::Checkbox("Shader objects", &shaderObjects))
+        SetShaderObjects(shaderObjects);
+    ImGui::EndDisabled();
+
+    // Creation of the last variant : reload or specialization change, once its modules are compiled
+    ImGui::Text("Last variant : %.2f ms (%s)", m_ImageVariantMs, m_ImageVariantBackend);
+    ImGui::Text("Last build : %u stages, %.1f ms", m_ShaderBuildStages, m_ShaderBuildMs);
+
+    ImGui::End();
+}
+
+void VulkanCore::RecordCommandBuffer(uint32_t imageIndex, ImDrawData* imGui_draw_data)
+{
+    VkCommandBufferBeginInfo beginInfo;
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.pNext = NULL;
+    beginInfo.flags = 0;
+    beginInfo.pInheritanceInfo = NULL; //ignored if VK_COMMAND_BUFFER_LEVEL_PRIMARY
+
+    VK_CHECK(m_Disp.beginCommandBuffer(m_CommandBuffers[m_CurrentFrame], &beginInfo));
+
+    if (!IsProgressiveConverged())
+    {
+        if (m_GraphicsTimestamps)
+            m_Disp.cmdResetQueryPool(m_CommandBuffers[m_CurrentFrame], m_TimestampQueryPool, m_CurrentFrame * TIMESTAMPS_PER_FRAME + 2, 2);
+
+        RecordCubemapPass(m_CommandBuffers[m_CurrentFrame]);
+
+        if (!UseAsyncCompute())
+        {
+            RecordSimulationPass(m_CommandBuffers[m_CurrentFrame], false);
+            m_SimDisplayIndex = m_SimOutputIndex;
+        }
+
+        if (m_GraphicsTimestamps)
+            m_Disp.cmdWriteTimestamp(m_CommandBuffers[m_CurrentFrame], VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_TimestampQueryPool, m_CurrentFrame * TIMESTAMPS_PER_FRAME + 2);
+
+        RecordImagePass(m_CommandBuffers[m_CurrentFrame], m_RTImages[m_CurrentFrame], { { 0, 0 }, { m_RTWidth, m_RTHeight } });
+
+        if (m_GraphicsTimestamps)
+        {
+            m_Disp.cmdWriteTimestamp(m_CommandBuffers[m_CurrentFrame], VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_TimestampQueryPool, m_CurrentFrame * TIMESTAMPS_PER_FRAME + 3);
+            m_TimestampsWritten[m_CurrentFrame] = true;
+        }
+
+        if (m_Progressive.Enabled)
+            RecordProgressivePass(m_CommandBuffers[m_CurrentFrame]);
+    }
+
+    VkImageMemoryBarrier barrier{};
+    VkRenderingAttachmentInfoKHR color_attachment_info;
+    VkRenderingInfoKHR render_info;
+
+    //ImGui Render
+
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = m_SwapchainImages[imageIndex];
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
     barrier.srcAccessMask = 0;
     barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
@@ -757,243 +2625,1660 @@ void VulkanCore::RecordCommandBuffer(uint32_t imageIndex, ImDrawData* imGui_draw
     render_info.pDepthAttachment = nullptr;
     render_info.pStencilAttachment = nullptr;
 
-    m_Disp.cmdBeginRendering(m_CommandBuffers[m_CurrentFrame], &render_info);
+    m_Disp.cmdBeginRendering(m_CommandBuffers[m_CurrentFrame], &render_info);
+
+    ImGui_ImplVulkan_RenderDrawData(imGui_draw_data, m_CommandBuffers[m_CurrentFrame]);
+
+    m_Disp.cmdEndRendering(m_CommandBuffers[m_CurrentFrame]);
+
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL_KHR;
+    barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = m_SwapchainImages[imageIndex];
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+
+    vkCmdPipelineBarrier(
+        m_CommandBuffers[m_CurrentFrame],
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0,
+        0, nullptr,
+        0, nullptr,
+        1, &barrier);
+
+    VK_CHECK(m_Disp.endCommandBuffer(m_CommandBuffers[m_CurrentFrame]));
+}
+
+// region : part of the iResolution image rendered into the top left corner of target (the whole image outside poster mode)
+void VulkanCore::RecordImagePass(VkCommandBuffer commandBuffer, const ImageData& target, const VkRect2D& region, VkPipeline pipeline,
+    uint32_t subFrameCount, bool subPixelJitter)
+{
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL_KHR;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = target.Image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        0,
+        0, nullptr,
+        0, nullptr,
+        1, &barrier);
+
+    VkRenderingAttachmentInfoKHR color_attachment_info;
+    color_attachment_info.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    color_attachment_info.pNext = nullptr;
+    color_attachment_info.imageView = target.ImageView;
+    color_attachment_info.imageLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL_KHR;
+    color_attachment_info.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    color_attachment_info.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    color_attachment_info.clearValue = { { { 0.0f, 0.0f, 0.0f, 1.0f } } };
+    color_attachment_info.resolveMode = VK_RESOLVE_MODE_NONE;
+    color_attachment_info.resolveImageView = VK_NULL_HANDLE;
+    color_attachment_info.resolveImageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    VkExtent2D ImageExtent = region.extent;
+
+    VkRenderingInfoKHR render_info;
+    render_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    render_info.pNext = nullptr;
+    render_info.flags = 0;
+    render_info.renderArea.offset = { 0, 0 };
+    render_info.renderArea.extent = ImageExtent;
+    render_info.layerCount = 1;
+    render_info.viewMask = 0;
+    render_info.colorAttachmentCount = 1;
+    render_info.pColorAttachments = &color_attachment_info;
+    render_info.pDepthAttachment = nullptr;
+    render_info.pStencilAttachment = nullptr;
+
+    m_Disp.cmdBeginRendering(commandBuffer, &render_info);
+
+    VkViewport viewport;
+    viewport.x = 0.0;
+    viewport.y = 0.0;
+    viewport.width = static_cast<float>(ImageExtent.width);
+    viewport.height = static_cast<float>(ImageExtent.height);
+    viewport.minDepth = 0.0;
+    viewport.maxDepth = 1.f;
+
+    VkRect2D scissor;
+    scissor.offset = { 0, 0 };
+    scissor.extent = ImageExtent;
+
+    const bool accumulate = subFrameCount > 1 && pipeline == VK_NULL_HANDLE && m_AccumulatePipeline != VK_NULL_HANDLE;
+
+    // Shader objects only draw the live image pass, the batch and accumulation pipelines are passed explicitly
+    const bool shaderObjects = m_UseShaderObjects && pipeline == VK_NULL_HANDLE && !accumulate && !m_ImageVariants.empty();
+
+    if (accumulate)
+        pipeline = m_AccumulatePipeline;
+    else if (pipeline == VK_NULL_HANDLE)
+        pipeline = m_GraphicPipeline;
+
+    if (shaderObjects)
+    {
+        BindImageShaders(commandBuffer, m_ImageVariants.front().FragmentShader);
+
+        m_Disp.cmdSetViewportWithCount(commandBuffer, 1, &viewport);
+        m_Disp.cmdSetScissorWithCount(commandBuffer, 1, &scissor);
+    }
+    else
+    {
+        m_Disp.cmdSetViewport(commandBuffer, 0, 1, &viewport);
+        m_Disp.cmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+        m_Disp.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    }
+
+    m_Disp.cmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicPipelineLayout,
+        0, 1, &m_BindlessDescriptorSet, 0, nullptr);
+
+    PushConstants pc{};
+    pc.iResolution = glm::vec3(m_RTWidth, m_RTHeight, 1.f);
+    pc.iChannels = GetChannelSlots();
+    pc.iFragCoordOffset = glm::vec2(region.offset.x, region.offset.y);
+
+    if (!accumulate)
+    {
+        BindShaderInputs(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicPipelineLayout);
+
+        vkCmdPushConstants(
+            commandBuffer,
+            m_GraphicPipelineLayout,
+            VK_SHADER_STAGE_FRAGMENT_BIT,
+            0,
+            sizeof(PushConstants),
+            &pc
+        );
+
+        m_Disp.cmdDraw(commandBuffer, 3, 1, 0, 0);
+    }
+
+    // Running average in primitive order : sub-frame k is weighted 1 / (k + 1), the first one replaces the clear color
+    for (uint32_t subFrame = 0; accumulate && subFrame < subFrameCount; subFrame++)
+    {
+        BindShaderInputs(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicPipelineLayout, subFrame + 1);
+
+        PushConstants subFramePc = pc;
+        if (subPixelJitter)
+            subFramePc.iFragCoordOffset += glm::vec2(Halton(subFrame + 1, 2), Halton(subFrame + 1, 3)) - 0.5f;
+
+        vkCmdPushConstants(commandBuffer, m_GraphicPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstants), &subFramePc);
+
+        const float weight = 1.f / (subFrame + 1);
+        const float blendConstants[4] = { weight, weight, weight, weight };
+        m_Disp.cmdSetBlendConstants(commandBuffer, blendConstants);
+
+        m_Disp.cmdDraw(commandBuffer, 3, 1, 0, 0);
+    }
+
+    m_Disp.cmdEndRendering(commandBuffer);
+
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL_KHR;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = target.Image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0,
+        0, nullptr,
+        0, nullptr,
+        1, &barrier);
+}
+
+void VulkanCore::ReloadShader(uint32_t passes)
+{
+    m_PendingShaderPasses |= passes;
+}
+
+void VulkanCore::StartShaderWatch()
+{
+    m_WatchShaders = true;
+
+    // Every file read by the passes so far, includes included
+    std::vector<std::string> files;
+    for (const auto& [file, passes] : m_ShaderFilePasses)
+        files.push_back(file);
+
+    m_ShaderWatcher.Start(files, SHADER_WATCH_DEBOUNCE_SECONDS);
+}
+
+void VulkanCore::UpdateShaderReload()
+{
+    // Only the passes reading a file whose content changed
+    for (const std::string& path : m_ShaderWatcher.PollChanges())
+    {
+        auto file = m_ShaderFilePasses.find(path);
+        if (file != m_ShaderFilePasses.end() && m_ShaderCompiler.HasChanged(path))
+            m_PendingShaderPasses |= file->second;
+    }
+
+    // One compilation at a time, the passes saved meanwhile go to the next one
+    if (m_ShaderReload.valid())
+    {
+        if (m_ShaderReload.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return;
+
+        ShaderPassModules modules = m_ShaderReload.get();
+
+        m_Disp.deviceWaitIdle();
+        CreatePassPipelines(modules);
+
+        ResetProgressive();
+    }
+
+    if (m_PendingShaderPasses != 0)
+    {
+        uint32_t passes = m_PendingShaderPasses;
+        m_PendingShaderPasses = 0;
+
+        m_ShaderReload = std::async(std::launch::async, [this, passes, recipe = m_SpirvRecipe, workgroupSize = m_SimSettings.WorkgroupSize]() {
+            return CompileShaderPasses(passes, recipe, workgroupSize); });
+    }
+}
+
+void VulkanCore::Draw()
+{
+    m_Disp.waitForFences(1, &m_InFlightFences[m_CurrentFrame], VK_TRUE, UINT64_MAX);
+
+    // The simulation timestamps of this slot may come from the compute queue
+    VkSemaphoreWaitInfo simWaitInfo{};
+    simWaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    simWaitInfo.semaphoreCount = 1;
+    simWaitInfo.pSemaphores = &m_SimTimeline;
+    simWaitInfo.pValues = &m_SimSlotValues[m_CurrentFrame];
+    m_Disp.waitSemaphores(&simWaitInfo, UINT64_MAX);
+
+    ReadTimestamps(m_CurrentFrame);
+
+    UpdateShaderReload();
+
+    UpdateImageVariants();
+
+    uint32_t imageIndex;
+
+    VkResult result = m_Disp.acquireNextImageKHR(m_Swapchain, UINT64_MAX, 
+        m_ImageAvailableSemaphores[m_CurrentFrame], VK_NULL_HANDLE, &imageIndex);
+
+    if (result == VK_ERROR_OUT_OF_DATE_KHR)
+    {
+        RecreateSwapChain();
+        return;
+    }
+    else if (result != VK_SUCCESS) {
+        debug_log("Failed to acquire next image !");
+        return;
+    }
+
+    VK_CHECK(m_Disp.resetCommandBuffer(m_CommandBuffers[m_CurrentFrame], 0));
+
+    m_DescriptorWritesLastFrame = m_DescriptorWriteCount;
+    m_DescriptorWriteCount = 0;
+
+    ImGui_ImplVulkan_NewFrame();
+    ImGui_ImplGlfw_NewFrame();
+    ImGui::NewFrame();
+
+    if (m_Playing)
+    {
+        auto currentTime = std::chrono::high_resolution_clock::now();
+        m_DeltaTime = std::chrono::duration<float>(currentTime - m_LastTime).count();
+        m_LastTime = currentTime;
+        m_SimulationTime += m_DeltaTime;
+
+        const float alpha = 0.005f;
+        m_fps = m_fps < 0.f ? (1.f / m_DeltaTime) : (1.f / m_DeltaTime) * alpha + (1.f - alpha) * m_fps;
+    }
+
+    {
+        ImGui::DockSpaceOverViewport();
+    }
+
+    /*
+    {
+        m_ImGuiGlslEditor.Draw();
+    }
+    */
+
+    DrawSimulationPanel();
+
+    DrawProgressivePanel();
+
+    DrawShaderPanel();
+
+    DrawUniformsPanel();
+
+    DrawChannelsPanel();
+
+    {
+        ImGuiWindowFlags window_flags = ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoNavFocus | ImGuiWindowFlags_NoNavInputs;
+
+        ImGui::Begin("Scene", nullptr, window_flags);
+        {
+            ImVec2 ImageRegionAvail = ImGui::GetContentRegionAvail();
+
+            std::string text = std::format("{:.2f}", static_cast<float>(m_SimulationTime))
+                + "\t" + std::format("{:.1f}", m_fps) + " fps"
+                + "\t" + std::to_string(m_RTWidth) + "x" + std::to_string(m_RTHeight);
+
+            const char* buttonRestartText = "Restart";
+            const char* buttonPlayText = m_Playing ? "Stop" : "Play";
+            const char* butttonRecompileText = "Recompile";
+
+            ImGuiStyle& style = ImGui::GetStyle();
+
+            ImVec2 FramePadding = ImVec2(style.FramePadding.x * 2.0f, style.FramePadding.y * 2.0f);
+            float buttonRestartY = ImGui::CalcTextSize(buttonRestartText).y + FramePadding.y * 2.0f + style.ItemSpacing.y;
+            float buttonStartSizeY = ImGui::CalcTextSize(buttonPlayText).y + FramePadding.y * 2.0f + style.ItemSpacing.y;
+            float textSizeY = ImGui::CalcTextSize(text.c_str()).y + style.ItemSpacing.y;
+            ImVec2 buttonRecompileSize = ImGui::CalcTextSize(butttonRecompileText);
+            buttonRecompileSize.x += FramePadding.x;
+            buttonRecompileSize.y += FramePadding.y + style.ItemSpacing.y;
+
+            ImageRegionAvail.y -= std::max(std::max(std::max(textSizeY, buttonStartSizeY), buttonRestartY), buttonRecompileSize.y);
+
+            ImGui::BeginChild("Render", ImVec2(0, ImageRegionAvail.y), false, window_flags);
+
+            if (m_RTWidth != ImageRegionAvail.x || m_RTHeight != ImageRegionAvail.y)
+            {
+                m_RTWidth = static_cast<uint32_t>(std::max(ImageRegionAvail.x, 1.f));
+                m_RTHeight = static_cast<uint32_t>(std::max(ImageRegionAvail.y, 1.f));
+
+                RecreateRenderTarget(m_RTWidth, m_RTHeight);
+            }
+
+            ImVec2 offset = ImGui::GetCursorScreenPos();
+            ImGui::ImageButton(
+                (ImTextureID)(m_Progressive.Enabled ? m_ProgressiveImGuiDescriptor : m_ImGuiDescriptors[m_CurrentFrame]),
+                ImageRegionAvail,
+                ImVec2(0, 0),
+                ImVec2(1, 1),
+                0
+            );
+
+            ImVec2 MousePos = ImGui::GetMousePos();
+
+            if (offset.x < MousePos.x && MousePos.x < offset.x + ImageRegionAvail.x && 
+                offset.y < MousePos.y && MousePos.y < offset.y + ImageRegionAvail.y && 
+                ImGui::IsAnyMouseDown())
+            {
+                m_CurrentMousePose = glm::vec2(MousePos.x - offset.x, ImageRegionAvail.y - (MousePos.y - offset.y));
+
+                if (!m_MouseDown)
+                {
+                    m_LastClickMousePose = m_CurrentMousePose;
+                    m_MouseDown = true;
+                }
+            }
+            else
+            {
+                m_MouseDown = false;
+            }
+
+            ImGui::EndChild();
+
+            ImGui::BeginChild("RenderBar", ImVec2(0, 0), false, window_flags);
+
+            if (ImGui::Button(buttonRestartText))
+            {
+                m_SimulationTime = 0.;
+                m_FrameCount = 0;
+                ResetProgressive();
+            }
+            ImGui::SameLine(0.0f, 10.0f);
+            if (ImGui::Button(buttonPlayText))
+            {
+                m_Playing = !m_Playing;
+                if (m_Playing)
+                    m_LastTime = std::chrono::high_resolution_clock::now();
+            }
+            ImGui::SameLine(0.0f, 30.0f);
+            ImGui::Text(text.c_str());
+            ImGui::SameLine(ImageRegionAvail.x - buttonRecompileSize.x);
+            if (ImGui::Button(butttonRecompileText))
+            {
+                ReloadShader();
+                m_SimulationTime = 0.;
+                m_FrameCount = 0;
+            }
+       
+            ImGui::EndChild();
+            
+        }
+        ImGui::End();
+    }
+
+    ImGui::Render();
+    ImDrawData* main_draw_data = ImGui::GetDrawData();
+
+    UpdateProgressiveState();
+
+    // Once converged the accumulated image is only presented again
+    const bool progressiveIdle = IsProgressiveConverged();
+
+    WriteShaderInputs();
+
+    if (!progressiveIdle)
+        SubmitSimulation();
+
+    RecordCommandBuffer(imageIndex, main_draw_data);
+
+    // Binary semaphores ignore their timeline value
+    VkSemaphore waitSemaphores[] = { m_ImageAvailableSemaphores[m_CurrentFrame], m_SimTimeline };
+    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT };
+    uint64_t waitValues[] = { 0, m_SimWaitValue };
+    VkSemaphore signalSemaphores[] = { m_RenderFinishedSemaphores[m_CurrentFrame], m_GraphicsTimeline };
+    uint64_t signalValues[] = { 0, ++m_GraphicsTimelineValue };
+
+    VkTimelineSemaphoreSubmitInfo timelineSubmitInfo{};
+    timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineSubmitInfo.waitSemaphoreValueCount = 2;
+    timelineSubmitInfo.pWaitSemaphoreValues = waitValues;
+    timelineSubmitInfo.signalSemaphoreValueCount = 2;
+    timelineSubmitInfo.pSignalSemaphoreValues = signalValues;
+
+    VkSubmitInfo submitsInfo;
+    submitsInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitsInfo.pNext = &timelineSubmitInfo;
+    submitsInfo.waitSemaphoreCount = 2;
+    submitsInfo.pWaitSemaphores = waitSemaphores;
+    submitsInfo.pWaitDstStageMask = waitStages;
+    submitsInfo.commandBufferCount = 1;
+    submitsInfo.pCommandBuffers = &m_CommandBuffers[m_CurrentFrame];
+    submitsInfo.signalSemaphoreCount = 2;
+    submitsInfo.pSignalSemaphores = signalSemaphores;
+
+    m_Disp.resetFences(1, &m_InFlightFences[m_CurrentFrame]);
+
+    VK_CHECK(m_Disp.queueSubmit(m_GraphicsQueue, 1, &submitsInfo, m_InFlightFences[m_CurrentFrame]));
+
+    // Path tracers seed their samples with iFrame, it keeps moving while the paused image accumulates
+    if (m_Playing || (m_Progressive.Enabled && !progressiveIdle))
+        m_FrameCount++;
+
+    VkPresentInfoKHR presentInfo{};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = &m_RenderFinishedSemaphores[m_CurrentFrame];
+
+    VkSwapchainKHR swapChains[] = { m_Swapchain };
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = swapChains;
+    presentInfo.pImageIndices = &imageIndex;
+    presentInfo.pResults = nullptr; // Optionnel
+
+    result = vkQueuePresentKHR(m_PresentQueue, &presentInfo);
+
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+    {
+        RecreateSwapChain();
+        return;
+    }
+    else if (result != VK_SUCCESS) {
+        debug_log("Failed to present image!");
+        return;
+    }
+
+    m_CurrentFrame = (m_CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+}
+
+void VulkanCore::SetImageShaderPath(const std::string& path)
+{
+    m_ImageShaderPath = path;
+}
+
+void VulkanCore::SetSpirvRecipe(uint32_t recipe)
+{
+    m_SpirvRecipe = std::min(recipe, SPIRV_RECIPE_COUNT - 1);
+}
+
+bool VulkanCore::RenderOffline(const OfflineRenderSettings& settings)
+{
+    if (settings.Benchmark.Enabled)
+        return RenderBenchmark(settings);
+
+    if (settings.Batch.IsEnabled())
+        return RenderBatch(settings);
+
+    return RenderOffline(settings, { this });
+}
+
+bool VulkanCore::RenderOffline(const OfflineRenderSettings& settings, const std::vector<VulkanCore*>& devices)
+{
+    for (VulkanCore* device : devices)
+    {
+        if (device->m_GraphicPipeline == VK_NULL_HANDLE)
+        {
+            debug_log("Offline render : " << device->m_ImageShaderPath << " failed to compile !");
+            return false;
+        }
+    }
+
+    const uint32_t deviceCount = static_cast<uint32_t>(devices.size());
+    const bool poster = settings.TileSize.x > 0 && settings.TileSize.y > 0;
+
+    // Every device must cut the poster in the same bands : the tile size is clamped to the smallest limit
+    OfflineRenderSettings jobSettings = settings;
+    for (VulkanCore* device : devices)
+    {
+        const uint32_t maxDimension = device->m_Device.physical_device.properties.limits.maxImageDimension2D;
+        jobSettings.TileSize = glm::min(jobSettings.TileSize, glm::uvec2(maxDimension));
+    }
+    jobSettings.TileSize = glm::min(jobSettings.TileSize, glm::uvec2(settings.Width, settings.Height));
+
+    char fileName[1024];
+    snprintf(fileName, sizeof(fileName), settings.OutputPattern.c_str(), settings.StartFrame);
+
+    std::unique_ptr<ImageStreamWriter> posterWriter;
+    VideoStreamWriter videoWriter;
+    const bool video = !poster && !settings.VideoTarget.empty();
+
+    uint32_t jobCount = 0;
+
+    if (poster)
+    {
+        posterWriter = ImageStreamWriter::Create(fileName);
+        if (!posterWriter || !posterWriter->Open(fileName, settings.Width, settings.Height))
+        {
+            debug_log("Poster : cannot write " << fileName << " (expected .png or .exr) !");
+            return false;
+        }
+
+        // One job per band (row of tiles), written in order
+        jobCount = (settings.Height + jobSettings.TileSize.y - 1) / jobSettings.TileSize.y;
+    }
+    else
+    {
+        if (video && !videoWriter.Open(settings.VideoTarget, settings.VideoOutputFormat, settings.Width, settings.Height, settings.Fps))
+        {
+            debug_log("Offline render : cannot stream video to " << settings.VideoTarget << " !");
+            return false;
+        }
+
+        const uint32_t frameCount = settings.EndFrame > settings.StartFrame ? settings.EndFrame - settings.StartFrame : 0;
+        jobCount = (frameCount + OFFLINE_FRAMES_PER_JOB - 1) / OFFLINE_FRAMES_PER_JOB;
+    }
+
+    // Image files don't need ordering, video frames and poster bands are written in order and move the write head
+    OfflineJobQueue jobs(jobCount, deviceCount, poster || video ? deviceCount * OFFLINE_JOBS_AHEAD_PER_DEVICE : 0);
+    std::unique_ptr<OrderedOutput> output;
+
+    if (poster)
+    {
+        output = std::make_unique<OrderedOutput>(0, [&](uint32_t band, const void* data)
+        {
+            const uint32_t tileHeight = jobSettings.TileSize.y;
+            const bool written = posterWriter->WriteRows(static_cast<const uint8_t*>(data), std::min(tileHeight, settings.Height - band * tileHeight));
+            jobs.SetWriteHead(band + 1);
+            return written;
+        });
+    }
+    else if (video)
+    {
+        output = std::make_unique<OrderedOutput>(settings.StartFrame, [&](uint32_t frame, const void* data)
+        {
+            const bool written = videoWriter.WriteFrame(data);
+            jobs.SetWriteHead((frame + 1 - settings.StartFrame) / OFFLINE_FRAMES_PER_JOB);
+            return written;
+        });
+    }
+
+    std::vector<OfflineDeviceStats> stats(deviceCount);
+
+    // The conversion pipelines are created before the device threads start, the jobs only reuse them
+    for (VulkanCore* device : devices)
+        device->CreateColorConvertPipeline();
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    // One thread per device, each one records and submits on its own queue
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < deviceCount; i++)
+    {
+        threads.emplace_back([&, i]()
+        {
+            stats[i].DeviceName = devices[i]->m_Device.physical_device.properties.deviceName;
+
+            auto deviceStart = std::chrono::steady_clock::now();
+            stats[i].Success = poster
+                ? devices[i]->RenderPosterJobs(jobSettings, jobs, i, posterWriter->GetPixelSize(), *output, stats[i])
+                : devices[i]->RenderSequenceJobs(jobSettings, jobs, i, output.get(), stats[i]);
+
+            // The jobs of a failed device are lost, the render fails as a whole instead of leaving a hole in the output
+            if (!stats[i].Success)
+                jobs.Abort();
+
+            stats[i].Seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - deviceStart).count();
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    float elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+
+    bool success = !output || output->Succeeded();
+    for (const OfflineDeviceStats& deviceStats : stats)
+        success &= deviceStats.Success;
+
+    if (poster)
+        success &= posterWriter->Close();
+
+    uint32_t outputCount = 0;
+    for (uint32_t i = 0; i < deviceCount; i++)
+    {
+        outputCount += stats[i].Outputs;
+        if (deviceCount > 1)
+        {
+            debug_log("Offline render : device " << i << " (" << stats[i].DeviceName << ") " << stats[i].Jobs << " jobs (" << stats[i].StolenJobs << " stolen), "
+                << stats[i].Outputs << (poster ? " bands, " : " frames, ") << stats[i].Outputs / std::max(stats[i].Seconds, 1e-6f) << " per second");
+        }
+    }
+
+    if (poster)
+    {
+        debug_log("Poster : " << settings.Width << "x" << settings.Height << " in tiles of " << jobSettings.TileSize.x << "x" << jobSettings.TileSize.y << ", " << elapsed << " s");
+
+        if (!success)
+            debug_log("Poster : failed to write " << fileName << " !");
+
+        return success;
+    }
+
+    debug_log("Offline render : " << outputCount << " frames in " << elapsed << " s (" << outputCount / std::max(elapsed, 1e-6f) << " fps)");
+
+    if (output && deviceCount > 1)
+        debug_log("Offline render : up to " << output->GetMaxPending() << " frames waited for an earlier one");
+
+    if (video)
+    {
+        // stdout may carry the stream, the report always goes to stderr
+        videoWriter.Close();
+        std::cerr << "Video : " << videoWriter.GetFrameCount() << " frames, " << videoWriter.GetFramesPerSecond() << " fps sustained" << std::endl;
+    }
+
+    return success;
+}
+
+bool VulkanCore::RenderSequenceJobs(const OfflineRenderSettings& settings, OfflineJobQueue& jobs, uint32_t device, OrderedOutput* output, OfflineDeviceStats& stats)
+{
+    SetupOfflineInputs(settings);
+
+    // Video and PNG frames are packed on the GPU, the readback buffers then hold exactly what is written out.
+    // Only .hdr frames are read back as RGBA32F.
+    const bool video = output != nullptr;
+    const std::string& pattern = settings.OutputPattern;
+    const bool packed = video || pattern.size() < 4 || pattern.compare(pattern.size() - 4, 4, ".hdr") != 0;
+    const VideoFormat captureFormat = video ? settings.VideoOutputFormat : VideoFormat::Rgba8;
+
+    if (packed)
+    {
+        CreateColorConvertPipeline();
+
+        if (m_ConvertPipeline == VK_NULL_HANDLE)
+            return false;
+    }
+
+    // Motion blur : the sub-frames are averaged in the render target, the readback size doesn't change
+    uint32_t subFrameCount = std::min(settings.SubFrames, m_UniformSlicesPerFrame > 1 ? m_UniformSlicesPerFrame - 1 : 1u);
+    if (subFrameCount > 1)
+        CreateAccumulatePipeline();
+
+    if (subFrameCount > 1 && m_AccumulatePipeline == VK_NULL_HANDLE)
+    {
+        debug_log("Offline render : " << m_Device.physical_device.name << " can't blend RT_IMAGE_FORMAT, sub-frames disabled");
+        subFrameCount = 1;
+    }
+
+    // One readback buffer per frame in flight, the CPU encodes frame N while the GPU renders N + 1 and N + 2
+    const VkDeviceSize rawSize = static_cast<VkDeviceSize>(settings.Width) * settings.Height * 4 * sizeof(float);
+    const size_t frameSize = packed ? VideoStreamWriter::GetFrameSize(captureFormat, settings.Width, settings.Height) : rawSize;
+    const VkDeviceSize readbackSize = (frameSize + 3) & ~VkDeviceSize(3);
+
+    if (device == 0)
+        debug_log("Offline render : " << readbackSize << " bytes read back per frame (" << static_cast<float>(rawSize) / readbackSize << "x less than RGBA32F)");
+
+    std::array<BufferData, MAX_FRAMES_IN_FLIGHT> readbackBuffers;
+    std::array<void*, MAX_FRAMES_IN_FLIGHT> readbackData = {};
+    std::array<int64_t, MAX_FRAMES_IN_FLIGHT> pendingFrames;
+    pendingFrames.fill(-1);
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        if (packed)
+        {
+            readbackData[i] = CreateReadbackBuffer(readbackSize, readbackBuffers[i], VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+            WriteColorConvertDescriptors(i, m_RTImages[i], readbackBuffers[i]);
+        }
+        else
+        {
+            readbackData[i] = CreateReadbackBuffer(readbackSize, readbackBuffers[i]);
+        }
+    }
+
+    bool success = true;
+
+    auto flushFrame = [&](uint32_t slot)
+    {
+        if (pendingFrames[slot] < 0)
+            return;
+
+        vmaInvalidateAllocation(m_Allocator, readbackBuffers[slot].BufferAllocation, 0, VK_WHOLE_SIZE);
+
+        if (video)
+            output->Push(static_cast<uint32_t>(pendingFrames[slot]), readbackData[slot], frameSize);
+        else
+            success &= WriteOfflineFrame(settings, static_cast<uint32_t>(pendingFrames[slot]), readbackData[slot]);
+        pendingFrames[slot] = -1;
+        stats.Outputs++;
+    };
+
+    uint32_t submission = 0;
+    uint32_t nextFrame = 0;   // first frame this device hasn't simulated yet
+    bool deviceLost = false;
+
+    // Frames in flight, oldest first
+    auto drainFrames = [&]()
+    {
+        m_Disp.deviceWaitIdle();
+
+        for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+            flushFrame((submission + i) % MAX_FRAMES_IN_FLIGHT);
+    };
+
+    uint32_t job;
+    bool stolen;
+    while (!deviceLost && jobs.Pop(device, job, stolen, drainFrames))
+    {
+        stats.Jobs++;
+        stats.StolenJobs += stolen ? 1 : 0;
+
+        const uint32_t firstFrame = settings.StartFrame + job * OFFLINE_FRAMES_PER_JOB;
+        const uint32_t endFrame = std::min(firstFrame + OFFLINE_FRAMES_PER_JOB, settings.EndFrame);
+
+        // The simulation only moves forward : an earlier chunk replays it from frame 0 (iFrame == 0 resets its state)
+        if (firstFrame < nextFrame)
+            nextFrame = 0;
+
+        // Frames before firstFrame only run the passes the next frames depend on
+        for (uint32_t frame = nextFrame; frame < endFrame; frame++)
+        {
+            m_CurrentFrame = submission++ % MAX_FRAMES_IN_FLIGHT;
+
+            if (m_Disp.waitForFences(1, &m_InFlightFences[m_CurrentFrame], VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+            {
+                debug_log("Offline render : " << m_Device.physical_device.name << " lost !");
+                deviceLost = true;
+                break;
+            }
+            VK_CHECK(m_Disp.resetFences(1, &m_InFlightFences[m_CurrentFrame]));
+
+            flushFrame(m_CurrentFrame);
+
+            SetOfflineFrame(settings, frame);
+
+            WriteShaderInputs();
+
+            // Stratified shutter times, jittered per frame so the strata don't line up between frames
+            if (subFrameCount > 1 && frame >= firstFrame)
+            {
+                for (uint32_t subFrame = 0; subFrame < subFrameCount; subFrame++)
+                {
+                    const float offset = (subFrame + HashToUnitFloat(frame * subFrameCount + subFrame)) / subFrameCount;
+                    m_SimulationTime = (frame + settings.Shutter * offset) / settings.Fps;
+                    WriteShaderInputs(subFrame + 1);
+                }
+                SetOfflineFrame(settings, frame);
+            }
+
+            VkCommandBuffer commandBuffer = m_CommandBuffers[m_CurrentFrame];
+
+            VK_CHECK(m_Disp.resetCommandBuffer(commandBuffer, 0));
+
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            VK_CHECK(m_Disp.beginCommandBuffer(commandBuffer, &beginInfo));
+
+            RecordCubemapPass(commandBuffer);
+
+            RecordSimulationPass(commandBuffer, false);
+            m_SimDisplayIndex = m_SimOutputIndex;
+
+            if (frame >= firstFrame)
+            {
+                RecordImagePass(commandBuffer, m_RTImages[m_CurrentFrame], { { 0, 0 }, { settings.Width, settings.Height } },
+                    VK_NULL_HANDLE, subFrameCount, settings.SubPixelJitter);
+
+                if (packed)
+                    RecordColorConvert(commandBuffer, m_CurrentFrame, { settings.Width, settings.Height }, captureFormat, settings.Capture, frame, readbackBuffers[m_CurrentFrame]);
+                else
+                    RecordReadback(commandBuffer, m_RTImages[m_CurrentFrame], { settings.Width, settings.Height }, readbackBuffers[m_CurrentFrame]);
+            }
+
+            VK_CHECK(m_Disp.endCommandBuffer(commandBuffer));
+
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &commandBuffer;
+
+            VK_CHECK(m_Disp.queueSubmit(m_GraphicsQueue, 1, &submitInfo, m_InFlightFences[m_CurrentFrame]));
+
+            if (frame >= firstFrame)
+                pendingFrames[m_CurrentFrame] = frame;
+        }
+
+        nextFrame = endFrame;
+    }
+
+    if (deviceLost)
+        m_Disp.deviceWaitIdle();
+    else
+        drainFrames();
+
+    for (auto& readbackBuffer : readbackBuffers)
+        readbackBuffer.Clenup(m_Allocator);
+
+    return success && !deviceLost;
+}
+
+void VulkanCore::SetupOfflineInputs(const OfflineRenderSettings& settings)
+{
+    // Every input is derived from the frame index, the simulation runs inline to keep the same ordering on every run
+    m_RTWidth = settings.Width;
+    m_RTHeight = settings.Height;
+    m_Playing = true;
+    m_SimSettings.AsyncCompute = false;
+    m_fps = static_cast<float>(settings.Fps);
+    m_DeltaTime = static_cast<float>(1. / settings.Fps);
+}
+
+void VulkanCore::SetOfflineFrame(const OfflineRenderSettings& settings, uint32_t frame)
+{
+    m_FrameCount = frame;
+    m_SimulationTime = frame / settings.Fps;
+}
+
+void* VulkanCore::CreateReadbackBuffer(VkDeviceSize size, BufferData& buffer, VkBufferUsageFlags usage)
+{
+    VkBufferCreateInfo bufferCreateInfo{};
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.size = size;
+    bufferCreateInfo.usage = usage;
+    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocCreateInfo = {};
+    allocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
+    allocCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VmaAllocationInfo allocInfo{};
+    VK_CHECK(vmaCreateBuffer(m_Allocator, &bufferCreateInfo, &allocCreateInfo, &buffer.Buffer, &buffer.BufferAllocation, &allocInfo));
+
+    return allocInfo.pMappedData;
+}
+
+// Copies the top left extent of source (left in SHADER_READ_ONLY_OPTIMAL by RecordImagePass) into buffer, tightly packed
+void VulkanCore::RecordReadback(VkCommandBuffer commandBuffer, const ImageData& source, VkExtent2D extent, const BufferData& buffer)
+{
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = source.Image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    // Chained with the SHADER_READ_ONLY transition at the end of RecordImagePass
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0,
+        0, nullptr,
+        0, nullptr,
+        1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = { 0, 0, 0 };
+    region.imageExtent = { extent.width, extent.height, 1 };
+
+    m_Disp.cmdCopyImageToBuffer(commandBuffer, source.Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        buffer.Buffer, 1, &region);
+
+    VkBufferMemoryBarrier bufferBarrier{};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = buffer.Buffer;
+    bufferBarrier.offset = 0;
+    bufferBarrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_HOST_BIT,
+        0,
+        0, nullptr,
+        1, &bufferBarrier,
+        0, nullptr);
+}
+
+bool VulkanCore::RenderPosterJobs(const OfflineRenderSettings& settings, OfflineJobQueue& jobs, uint32_t device, uint32_t pixelSize, OrderedOutput& output, OfflineDeviceStats& stats)
+{
+    // The render targets only hold one tile, iResolution stays the full poster size
+    const uint32_t tileWidth = settings.TileSize.x;
+    const uint32_t tileHeight = settings.TileSize.y;
+    const uint32_t tileCountX = (settings.Width + tileWidth - 1) / tileWidth;
+
+    RecreateRenderTarget(tileWidth, tileHeight);
+
+    SetupOfflineInputs(settings);
+
+    // PNG tiles are packed to RGBA8 on the GPU, EXR tiles are the raw RGBA32F copy
+    const bool packed = pixelSize != 4 * sizeof(float);
+
+    if (packed)
+    {
+        CreateColorConvertPipeline();
+
+        if (m_ConvertPipeline == VK_NULL_HANDLE)
+            return false;
+    }
+
+    // Host memory : one readback buffer per tile in flight and one band (row of tiles) in the file pixel format
+    std::vector<uint8_t> band(static_cast<size_t>(settings.Width) * tileHeight * pixelSize);
+
+    std::array<BufferData, MAX_FRAMES_IN_FLIGHT> readbackBuffers;
+    std::array<uint8_t*, MAX_FRAMES_IN_FLIGHT> readbackData = {};
+    std::array<int64_t, MAX_FRAMES_IN_FLIGHT> pendingTiles;
+    pendingTiles.fill(-1);
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        const VkDeviceSize readbackSize = static_cast<VkDeviceSize>(tileWidth) * tileHeight * pixelSize;
+
+        if (packed)
+        {
+            readbackData[i] = static_cast<uint8_t*>(CreateReadbackBuffer(readbackSize, readbackBuffers[i], VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
+            WriteColorConvertDescriptors(i, m_RTImages[i], readbackBuffers[i]);
+        }
+        else
+        {
+            readbackData[i] = static_cast<uint8_t*>(CreateReadbackBuffer(readbackSize, readbackBuffers[i]));
+        }
+    }
+
+    auto getTileRect = [&](uint32_t tile)
+    {
+        uint32_t x = (tile % tileCountX) * tileWidth;
+        uint32_t y = (tile / tileCountX) * tileHeight;
+        VkRect2D rect{};
+        rect.offset = { static_cast<int32_t>(x), static_cast<int32_t>(y) };
+        rect.extent = { std::min(tileWidth, settings.Width - x), std::min(tileHeight, settings.Height - y) };
+        return rect;
+    };
+
+    // Tiles complete in submission order, a band is handed to the output as soon as its last tile is read back
+    auto flushTile = [&](uint32_t slot)
+    {
+        if (pendingTiles[slot] < 0)
+            return;
+
+        uint32_t tile = static_cast<uint32_t>(pendingTiles[slot]);
+        pendingTiles[slot] = -1;
+
+        vmaInvalidateAllocation(m_Allocator, readbackBuffers[slot].BufferAllocation, 0, VK_WHOLE_SIZE);
+
+        // Rows are already in the file layout, the host only places them in the band
+        VkRect2D rect = getTileRect(tile);
+        const size_t rowSize = static_cast<size_t>(rect.extent.width) * pixelSize;
+        for (uint32_t row = 0; row < rect.extent.height; row++)
+        {
+            memcpy(band.data() + (static_cast<size_t>(row) * settings.Width + rect.offset.x) * pixelSize,
+                readbackData[slot] + row * rowSize, rowSize);
+        }
+
+        if (tile % tileCountX == tileCountX - 1)
+        {
+            output.Push(tile / tileCountX, band.data(), static_cast<size_t>(settings.Width) * rect.extent.height * pixelSize);
+            stats.Outputs++;
+        }
+    };
+
+    bool deviceLost = false;
+
+    // VK_NULL_HANDLE once the device is lost
+    auto beginCommandBuffer = [&](uint32_t submission) -> VkCommandBuffer
+    {
+        m_CurrentFrame = submission % MAX_FRAMES_IN_FLIGHT;
+
+        if (m_Disp.waitForFences(1, &m_InFlightFences[m_CurrentFrame], VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+        {
+            debug_log("Poster : " << m_Device.physical_device.name << " lost !");
+            deviceLost = true;
+            return VK_NULL_HANDLE;
+        }
+        VK_CHECK(m_Disp.resetFences(1, &m_InFlightFences[m_CurrentFrame]));
+
+        flushTile(m_CurrentFrame);
+
+        // Same inputs for every tile, each frame in flight has its own uniform slice
+        WriteShaderInputs();
+
+        VkCommandBuffer commandBuffer = m_CommandBuffers[m_CurrentFrame];
+
+        VK_CHECK(m_Disp.resetCommandBuffer(commandBuffer, 0));
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        VK_CHECK(m_Disp.beginCommandBuffer(commandBuffer, &beginInfo));
+
+        return commandBuffer;
+    };
+
+    auto submitCommandBuffer = [&](VkCommandBuffer commandBuffer)
+    {
+        VK_CHECK(m_Disp.endCommandBuffer(commandBuffer));
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+
+        VK_CHECK(m_Disp.queueSubmit(m_GraphicsQueue, 1, &submitInfo, m_InFlightFences[m_CurrentFrame]));
+    };
+
+    uint32_t submission = 0;
+    bool warmedUp = false;
+
+    // Tiles in flight, oldest first : the last one completes the band of the job
+    auto drainTiles = [&]()
+    {
+        m_Disp.deviceWaitIdle();
+
+        for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+            flushTile((submission + i) % MAX_FRAMES_IN_FLIGHT);
+    };
+
+    uint32_t job;
+    bool stolen;
+    while (!deviceLost && jobs.Pop(device, job, stolen, drainTiles))
+    {
+        stats.Jobs++;
+        stats.StolenJobs += stolen ? 1 : 0;
+
+        // The Cube A and simulation state of the poster frame depend on the previous frames, the Image pass doesn't
+        if (!warmedUp)
+        {
+            for (uint32_t frame = 0; frame <= settings.StartFrame; frame++)
+            {
+                SetOfflineFrame(settings, frame);
+
+                VkCommandBuffer commandBuffer = beginCommandBuffer(submission++);
+                if (commandBuffer == VK_NULL_HANDLE)
+                    break;
+
+                RecordCubemapPass(commandBuffer);
+
+                RecordSimulationPass(commandBuffer, false);
+                m_SimDisplayIndex = m_SimOutputIndex;
+
+                submitCommandBuffer(commandBuffer);
+            }
+
+            warmedUp = true;
+        }
+
+        for (uint32_t tile = job * tileCountX; tile < (job + 1) * tileCountX; tile++)
+        {
+            VkCommandBuffer commandBuffer = beginCommandBuffer(submission++);
+            if (commandBuffer == VK_NULL_HANDLE)
+                break;
+
+            // One bounded draw per tile, a single full size draw could hit the device lost timeout
+            VkRect2D rect = getTileRect(tile);
+
+            RecordImagePass(commandBuffer, m_RTImages[m_CurrentFrame], rect);
+
+            if (packed)
+                RecordColorConvert(commandBuffer, m_CurrentFrame, rect.extent, VideoFormat::Rgba8, settings.Capture, settings.StartFrame, readbackBuffers[m_CurrentFrame], rect.offset);
+            else
+                RecordReadback(commandBuffer, m_RTImages[m_CurrentFrame], rect.extent, readbackBuffers[m_CurrentFrame]);
+
+            submitCommandBuffer(commandBuffer);
+
+            pendingTiles[m_CurrentFrame] = tile;
+        }
+    }
+
+    if (deviceLost)
+        m_Disp.deviceWaitIdle();
+    else
+        drainTiles();
+
+    for (auto& readbackBuffer : readbackBuffers)
+        readbackBuffer.Clenup(m_Allocator);
+
+    return !deviceLost;
+}
+
+void VulkanCore::CreateColorConvertPipeline()
+{
+    if (m_ConvertPipeline != VK_NULL_HANDLE)
+        return;
+
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo{};
+    setLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutCreateInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    setLayoutCreateInfo.pBindings = bindings.data();
+
+    VK_CHECK(m_Disp.createDescriptorSetLayout(&setLayoutCreateInfo, nullptr, &m_ConvertSetLayout));
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(ConvertPushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+    pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutCreateInfo.setLayoutCount = 1;
+    pipelineLayoutCreateInfo.pSetLayouts = &m_ConvertSetLayout;
+    pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+
+    VK_CHECK(m_Disp.createPipelineLayout(&pipelineLayoutCreateInfo, nullptr, &m_ConvertPipelineLayout));
+
+    std::array<VkDescriptorPoolSize, 2> pool_sizes = { {
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_FRAMES_IN_FLIGHT },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, MAX_FRAMES_IN_FLIGHT },
+    } };
 
-    ImGui_ImplVulkan_RenderDrawData(imGui_draw_data, m_CommandBuffers[m_CurrentFrame]);
+    VkDescriptorPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.maxSets = MAX_FRAMES_IN_FLIGHT;
+    pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+    pool_info.pPoolSizes = pool_sizes.data();
 
-    m_Disp.cmdEndRendering(m_CommandBuffers[m_CurrentFrame]);
+    VK_CHECK(m_Disp.createDescriptorPool(&pool_info, nullptr, &m_ConvertDescriptorPool));
 
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL_KHR;
-    barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = m_SwapchainImages[imageIndex];
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
-    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    barrier.dstAccessMask = 0;
+    std::array<VkDescriptorSetLayout, MAX_FRAMES_IN_FLIGHT> setLayouts;
+    setLayouts.fill(m_ConvertSetLayout);
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_ConvertDescriptorPool;
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(setLayouts.size());
+    allocInfo.pSetLayouts = setLayouts.data();
+
+    VK_CHECK(m_Disp.allocateDescriptorSets(&allocInfo, m_ConvertDescriptorSets.data()));
+
+    VkComputePipelineCreateInfo computePipelineCreateInfo{};
+    computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    computePipelineCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    computePipelineCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    computePipelineCreateInfo.stage.module = m_BuiltinModules[BUILTIN_SHADER_COLOR_CONVERT];
+    computePipelineCreateInfo.stage.pName = "main";
+    computePipelineCreateInfo.layout = m_ConvertPipelineLayout;
+    computePipelineCreateInfo.basePipelineIndex = -1;
+
+    VK_CHECK(m_Disp.createComputePipelines(VK_NULL_HANDLE, 1, &computePipelineCreateInfo, nullptr, &m_ConvertPipeline));
+}
+
+void VulkanCore::WriteColorConvertDescriptors(uint32_t slot, const ImageData& source, const BufferData& destination)
+{
+    VkDescriptorImageInfo imageInfo{ m_ChannelSampler, source.ImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    VkDescriptorBufferInfo bufferInfo{ destination.Buffer, 0, VK_WHOLE_SIZE };
+
+    std::array<VkWriteDescriptorSet, 2> writes{};
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = m_ConvertDescriptorSets[slot];
+    writes[0].dstBinding = 0;
+    writes[0].descriptorCount = 1;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[0].pImageInfo = &imageInfo;
+    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[1].dstSet = m_ConvertDescriptorSets[slot];
+    writes[1].dstBinding = 1;
+    writes[1].descriptorCount = 1;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[1].pBufferInfo = &bufferInfo;
+
+    m_Disp.updateDescriptorSets(static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
 
+// Packs the render target of slot (left in SHADER_READ_ONLY_OPTIMAL by RecordImagePass) into destination
+void VulkanCore::RecordColorConvert(VkCommandBuffer commandBuffer, uint32_t slot, VkExtent2D extent, VideoFormat format, const CaptureSettings& capture, uint32_t seed, const BufferData& destination,
+    VkOffset2D offset)
+{
+    VkMemoryBarrier memoryBarrier{};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    // Chained with the SHADER_READ_ONLY transition at the end of RecordImagePass
     vkCmdPipelineBarrier(
-        m_CommandBuffers[m_CurrentFrame],
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        commandBuffer,
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
         0,
+        1, &memoryBarrier,
         0, nullptr,
-        0, nullptr,
-        1, &barrier);
+        0, nullptr);
+
+    ConvertPushConstants pc{};
+    pc.iSize = glm::uvec2(extent.width, extent.height);
+    pc.iFormat = static_cast<uint32_t>(format);
+    pc.iByteCount = static_cast<uint32_t>(VideoStreamWriter::GetFrameSize(format, extent.width, extent.height));
+    pc.iToneMap = static_cast<uint32_t>(capture.ToneMap);
+    pc.iFlags = (capture.SrgbEncode ? CONVERT_FLAG_SRGB : 0u) | (capture.Dither ? CONVERT_FLAG_DITHER : 0u);
+    pc.iExposure = capture.Exposure;
+    pc.iSeed = seed;
+    pc.iOffset = glm::uvec2(offset.x, offset.y);
+
+    m_Disp.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ConvertPipeline);
+    m_Disp.cmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ConvertPipelineLayout, 0, 1, &m_ConvertDescriptorSets[slot], 0, nullptr);
+    m_Disp.cmdPushConstants(commandBuffer, m_ConvertPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ConvertPushConstants), &pc);
+
+    // One invocation per output word, rows of 1024 groups to stay under maxComputeWorkGroupCount
+    const uint32_t groupCount = ((pc.iByteCount + 3) / 4 + 63) / 64;
+    const uint32_t groupsPerRow = 1024;
+    m_Disp.cmdDispatch(commandBuffer, std::min(groupCount, groupsPerRow), (groupCount + groupsPerRow - 1) / groupsPerRow, 1);
+
+    VkBufferMemoryBarrier bufferBarrier{};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = destination.Buffer;
+    bufferBarrier.offset = 0;
+    bufferBarrier.size = VK_WHOLE_SIZE;
 
-    VK_CHECK(m_Disp.endCommandBuffer(m_CommandBuffers[m_CurrentFrame]));
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_HOST_BIT,
+        0,
+        0, nullptr,
+        1, &bufferBarrier,
+        0, nullptr);
 }
 
-void VulkanCore::ReloadShader()
+void VulkanCore::CreateProgressivePipeline()
 {
-    m_Disp.deviceWaitIdle();
+    if (m_ProgressiveSetLayout != VK_NULL_HANDLE)
+        return;
 
-    m_Disp.destroyPipeline(m_GraphicPipeline, nullptr);
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[2].binding = 2;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[2].descriptorCount = 1;
+    bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo{};
+    setLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutCreateInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    setLayoutCreateInfo.pBindings = bindings.data();
+
+    VK_CHECK(m_Disp.createDescriptorSetLayout(&setLayoutCreateInfo, nullptr, &m_ProgressiveSetLayout));
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(AccumulatePushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+    pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutCreateInfo.setLayoutCount = 1;
+    pipelineLayoutCreateInfo.pSetLayouts = &m_ProgressiveSetLayout;
+    pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+
+    VK_CHECK(m_Disp.createPipelineLayout(&pipelineLayoutCreateInfo, nullptr, &m_ProgressivePipelineLayout));
+
+    std::array<VkDescriptorPoolSize, 3> pool_sizes = { {
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_FRAMES_IN_FLIGHT },
+        { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, MAX_FRAMES_IN_FLIGHT },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, MAX_FRAMES_IN_FLIGHT },
+    } };
 
-    CreateGraphicPipeline();
-}
+    VkDescriptorPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.maxSets = MAX_FRAMES_IN_FLIGHT;
+    pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+    pool_info.pPoolSizes = pool_sizes.data();
 
-void VulkanCore::Draw()
-{
-    m_Disp.waitForFences(1, &m_InFlightFences[m_CurrentFrame], VK_TRUE, UINT64_MAX);
+    VK_CHECK(m_Disp.createDescriptorPool(&pool_info, nullptr, &m_ProgressiveDescriptorPool));
 
-    uint32_t imageIndex;
+    std::array<VkDescriptorSetLayout, MAX_FRAMES_IN_FLIGHT> setLayouts;
+    setLayouts.fill(m_ProgressiveSetLayout);
 
-    VkResult result = m_Disp.acquireNextImageKHR(m_Swapchain, UINT64_MAX, 
-        m_ImageAvailableSemaphores[m_CurrentFrame], VK_NULL_HANDLE, &imageIndex);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_ProgressiveDescriptorPool;
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(setLayouts.size());
+    allocInfo.pSetLayouts = setLayouts.data();
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR)
-    {
-        RecreateSwapChain();
-        return;
-    }
-    else if (result != VK_SUCCESS) {
-        debug_log("Failed to acquire next image !");
-        return;
-    }
+    VK_CHECK(m_Disp.allocateDescriptorSets(&allocInfo, m_ProgressiveDescriptorSets.data()));
 
-    VK_CHECK(m_Disp.resetCommandBuffer(m_CommandBuffers[m_CurrentFrame], 0));
+    WriteProgressiveDescriptors();
 
-    ImGui_ImplVulkan_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
-    ImGui::NewFrame();
+    VkComputePipelineCreateInfo computePipelineCreateInfo{};
+    computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    computePipelineCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    computePipelineCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    computePipelineCreateInfo.stage.module = m_BuiltinModules[BUILTIN_SHADER_ACCUMULATE];
+    computePipelineCreateInfo.stage.pName = "main";
+    computePipelineCreateInfo.layout = m_ProgressivePipelineLayout;
+    computePipelineCreateInfo.basePipelineIndex = -1;
 
-    if (m_Playing)
-    {
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        m_DeltaTime = std::chrono::duration<float>(currentTime - m_LastTime).count();
-        m_LastTime = currentTime;
-        m_SimulationTime += m_DeltaTime;
+    VK_CHECK(m_Disp.createComputePipelines(VK_NULL_HANDLE, 1, &computePipelineCreateInfo, nullptr, &m_ProgressivePipeline));
+}
 
-        const float alpha = 0.005f;
-        m_fps = m_fps < 0.f ? (1.f / m_DeltaTime) : (1.f / m_DeltaTime) * alpha + (1.f - alpha) * m_fps;
-    }
+void VulkanCore::CreateProgressiveTarget(uint32_t width, uint32_t height)
+{
+    VkImageCreateInfo imageCreateInfo{};
+    imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageCreateInfo.extent.width = width;
+    imageCreateInfo.extent.height = height;
+    imageCreateInfo.extent.depth = 1;
+    imageCreateInfo.mipLevels = 1;
+    imageCreateInfo.arrayLayers = 1;
+    imageCreateInfo.format = RT_IMAGE_FORMAT;
+    imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageCreateInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+    imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocCreateInfo = {};
+    allocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
+    allocCreateInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+
+    VK_CHECK(vmaCreateImage(m_Allocator, &imageCreateInfo, &allocCreateInfo, &m_ProgressiveImage.Image, &m_ProgressiveImage.ImageAllocation, nullptr));
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = m_ProgressiveImage.Image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = RT_IMAGE_FORMAT;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    VK_CHECK(m_Disp.createImageView(&viewInfo, nullptr, &m_ProgressiveImage.ImageView));
+
+    m_ProgressiveImGuiDescriptor = ImGui_ImplVulkan_AddTexture(m_ImGuiSampler, m_ProgressiveImage.ImageView, VK_IMAGE_LAYOUT_GENERAL);
+
+    // One partial sum per workgroup, added on the CPU
+    m_ProgressiveGroupCount = ((width + ACCUMULATE_GROUP_SIZE - 1) / ACCUMULATE_GROUP_SIZE) * ((height + ACCUMULATE_GROUP_SIZE - 1) / ACCUMULATE_GROUP_SIZE);
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        m_ProgressiveErrorData[i] = static_cast<float*>(CreateReadbackBuffer(m_ProgressiveGroupCount * sizeof(float), m_ProgressiveErrorBuffers[i], VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
+
+    WriteProgressiveDescriptors();
+
+    ResetProgressive();
+}
+
+void VulkanCore::DestroyProgressiveTarget()
+{
+    if (m_ProgressiveImGuiDescriptor != VK_NULL_HANDLE)
+        ImGui_ImplVulkan_RemoveTexture(m_ProgressiveImGuiDescriptor);
+    m_ProgressiveImGuiDescriptor = VK_NULL_HANDLE;
+
+    m_ProgressiveImage.Clenup(m_Allocator, m_Disp);
+    m_ProgressiveImage = ImageData();
 
+    for (auto& errorBuffer : m_ProgressiveErrorBuffers)
     {
-        ImGui::DockSpaceOverViewport();
+        errorBuffer.Clenup(m_Allocator);
+        errorBuffer = BufferData();
     }
+    m_ProgressiveErrorData.fill(nullptr);
+}
 
-    /*
+void VulkanCore::WriteProgressiveDescriptors()
+{
+    if (m_ProgressiveDescriptorPool == VK_NULL_HANDLE || m_ProgressiveImage.Image == VK_NULL_HANDLE)
+        return;
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
-        m_ImGuiGlslEditor.Draw();
+        VkDescriptorImageInfo sampleInfo{ m_ChannelSampler, m_RTImages[i].ImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        VkDescriptorImageInfo accumulationInfo{ VK_NULL_HANDLE, m_ProgressiveImage.ImageView, VK_IMAGE_LAYOUT_GENERAL };
+        VkDescriptorBufferInfo errorInfo{ m_ProgressiveErrorBuffers[i].Buffer, 0, VK_WHOLE_SIZE };
+
+        std::array<VkWriteDescriptorSet, 3> writes{};
+        writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[0].dstSet = m_ProgressiveDescriptorSets[i];
+        writes[0].dstBinding = 0;
+        writes[0].descriptorCount = 1;
+        writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[0].pImageInfo = &sampleInfo;
+        writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[1].dstSet = m_ProgressiveDescriptorSets[i];
+        writes[1].dstBinding = 1;
+        writes[1].descriptorCount = 1;
+        writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[1].pImageInfo = &accumulationInfo;
+        writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[2].dstSet = m_ProgressiveDescriptorSets[i];
+        writes[2].dstBinding = 2;
+        writes[2].descriptorCount = 1;
+        writes[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[2].pBufferInfo = &errorInfo;
+
+        m_Disp.updateDescriptorSets(static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
     }
-    */
+}
 
-    {
-        ImGuiWindowFlags window_flags = ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoNavFocus | ImGuiWindowFlags_NoNavInputs;
+void VulkanCore::ResetProgressive()
+{
+    m_ProgressiveSamples = 0;
+    m_ProgressiveVariance = -1.f;
+    // Estimates still in flight belong to the previous average
+    m_ProgressiveErrorSamples.fill(0);
+}
 
-        ImGui::Begin("Scene", nullptr, window_flags);
-        {
-            ImVec2 ImageRegionAvail = ImGui::GetContentRegionAvail();
+void VulkanCore::UpdateProgressiveState()
+{
+    if (!m_Progressive.Enabled)
+        return;
 
-            std::string text = std::format("{:.2f}", static_cast<float>(m_SimulationTime))
-                + "\t" + std::format("{:.1f}", m_fps) + " fps"
-                + "\t" + std::to_string(m_RTWidth) + "x" + std::to_string(m_RTHeight);
+    // The fence of this slot was waited on in Draw
+    const uint32_t errorSamples = m_ProgressiveErrorSamples[m_CurrentFrame];
+    if (errorSamples > 0)
+    {
+        vmaInvalidateAllocation(m_Allocator, m_ProgressiveErrorBuffers[m_CurrentFrame].BufferAllocation, 0, VK_WHOLE_SIZE);
 
-            const char* buttonRestartText = "Restart";
-            const char* buttonPlayText = m_Playing ? "Stop" : "Play";
-            const char* butttonRecompileText = "Recompile";
+        double sum = 0.;
+        for (uint32_t i = 0; i < m_ProgressiveGroupCount; i++)
+            sum += m_ProgressiveErrorData[m_CurrentFrame][i];
 
-            ImGuiStyle& style = ImGui::GetStyle();
+        // Per pixel variance of one sample, the mean of n samples has n times less
+        const double sampleVariance = sum / (static_cast<double>(m_RTWidth) * m_RTHeight);
+        m_ProgressiveVariance = static_cast<float>(sampleVariance / errorSamples);
+        m_ProgressiveErrorSamples[m_CurrentFrame] = 0;
+    }
 
-            ImVec2 FramePadding = ImVec2(style.FramePadding.x * 2.0f, style.FramePadding.y * 2.0f);
-            float buttonRestartY = ImGui::CalcTextSize(buttonRestartText).y + FramePadding.y * 2.0f + style.ItemSpacing.y;
-            float buttonStartSizeY = ImGui::CalcTextSize(buttonPlayText).y + FramePadding.y * 2.0f + style.ItemSpacing.y;
-            float textSizeY = ImGui::CalcTextSize(text.c_str()).y + style.ItemSpacing.y;
-            ImVec2 buttonRecompileSize = ImGui::CalcTextSize(butttonRecompileText);
-            buttonRecompileSize.x += FramePadding.x;
-            buttonRecompileSize.y += FramePadding.y + style.ItemSpacing.y;
+    // iFrame is left out : it seeds the samples
+    ShaderInputs inputs{};
+    GetShaderInputs(inputs);
+    const glm::uvec4 channels = GetChannelSlots();
 
-            ImageRegionAvail.y -= std::max(std::max(std::max(textSizeY, buttonStartSizeY), buttonRestartY), buttonRecompileSize.y);
+    bool changed = inputs.iTime != m_ProgressiveInputs.iTime
+        || inputs.iMouse != m_ProgressiveInputs.iMouse
+        || memcmp(inputs.iUserParams, m_ProgressiveInputs.iUserParams, sizeof(inputs.iUserParams)) != 0
+        || channels != m_ProgressiveChannels;
 
-            ImGui::BeginChild("Render", ImVec2(0, ImageRegionAvail.y), false, window_flags);
+    if (changed)
+        ResetProgressive();
 
-            if (m_RTWidth != ImageRegionAvail.x || m_RTHeight != ImageRegionAvail.y)
-            {
-                m_RTWidth = static_cast<uint32_t>(std::max(ImageRegionAvail.x, 1.f));
-                m_RTHeight = static_cast<uint32_t>(std::max(ImageRegionAvail.y, 1.f));
+    m_ProgressiveInputs = inputs;
+    m_ProgressiveChannels = channels;
+}
 
-                RecreateRenderTarget(m_RTWidth, m_RTHeight);
-            }
+bool VulkanCore::IsProgressiveConverged() const
+{
+    if (!m_Progressive.Enabled || m_ProgressiveSamples == 0)
+        return false;
 
-            ImVec2 offset = ImGui::GetCursorScreenPos();
-            ImGui::ImageButton(
-                (ImTextureID)m_ImGuiDescriptors[m_CurrentFrame],
-                ImageRegionAvail,
-                ImVec2(0, 0),
-                ImVec2(1, 1),
-                0
-            );
+    if (m_Progressive.MaxSamples > 0 && m_ProgressiveSamples >= static_cast<uint32_t>(m_Progressive.MaxSamples))
+        return true;
 
-            ImVec2 MousePos = ImGui::GetMousePos();
+    return m_Progressive.TargetVariance > 0.f && m_ProgressiveVariance >= 0.f && m_ProgressiveVariance <= m_Progressive.TargetVariance;
+}
 
-            if (offset.x < MousePos.x && MousePos.x < offset.x + ImageRegionAvail.x && 
-                offset.y < MousePos.y && MousePos.y < offset.y + ImageRegionAvail.y && 
-                ImGui::IsAnyMouseDown())
-            {
-                m_CurrentMousePose = glm::vec2(MousePos.x - offset.x, ImageRegionAvail.y - (MousePos.y - offset.y));
+// Folds m_RTImages[m_CurrentFrame] (left in SHADER_READ_ONLY_OPTIMAL by RecordImagePass) into m_ProgressiveImage
+void VulkanCore::RecordProgressivePass(VkCommandBuffer commandBuffer)
+{
+    if (m_ProgressivePipeline == VK_NULL_HANDLE || m_ProgressiveImage.Image == VK_NULL_HANDLE)
+        return;
 
-                if (!m_MouseDown)
-                {
-                    m_LastClickMousePose = m_CurrentMousePose;
-                    m_MouseDown = true;
-                }
-            }
-            else
-            {
-                m_MouseDown = false;
-            }
+    const uint32_t sampleCount = ++m_ProgressiveSamples;
+    const bool writeError = sampleCount > 1 && sampleCount % ACCUMULATE_ERROR_INTERVAL == 0;
 
-            ImGui::EndChild();
+    VkMemoryBarrier memoryBarrier{};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-            ImGui::BeginChild("RenderBar", ImVec2(0, 0), false, window_flags);
+    // The previous frame displayed the running mean, the first sample discards it
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = sampleCount == 1 ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_GENERAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = m_ProgressiveImage.Image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
 
-            if (ImGui::Button(buttonRestartText))
-            {
-                m_SimulationTime = 0.;
-            }
-            ImGui::SameLine(0.0f, 10.0f);
-            if (ImGui::Button(buttonPlayText))
-            {
-                m_Playing = !m_Playing;
-                if (m_Playing)
-                    m_LastTime = std::chrono::high_resolution_clock::now();
-            }
-            ImGui::SameLine(0.0f, 30.0f);
-            ImGui::Text(text.c_str());
-            ImGui::SameLine(ImageRegionAvail.x - buttonRecompileSize.x);
-            if (ImGui::Button(butttonRecompileText))
-            {
-                ReloadShader();
-                m_SimulationTime = 0.;
-            }
-       
-            ImGui::EndChild();
-            
-        }
-        ImGui::End();
-    }
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1, &memoryBarrier,
+        0, nullptr,
+        1, &barrier);
 
-    ImGui::Render();
-    ImDrawData* main_draw_data = ImGui::GetDrawData();
+    AccumulatePushConstants pc{};
+    pc.iSize = glm::uvec2(m_RTWidth, m_RTHeight);
+    pc.iSampleCount = sampleCount;
+    pc.iWriteError = writeError ? 1u : 0u;
 
-    RecordCommandBuffer(imageIndex, main_draw_data);
+    m_Disp.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ProgressivePipeline);
+    m_Disp.cmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ProgressivePipelineLayout, 0, 1, &m_ProgressiveDescriptorSets[m_CurrentFrame], 0, nullptr);
+    m_Disp.cmdPushConstants(commandBuffer, m_ProgressivePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(AccumulatePushConstants), &pc);
 
-    VkSemaphore waitSemaphores[] = { m_ImageAvailableSemaphores[m_CurrentFrame] };
-    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    VkSemaphore signalSemaphores[] = { m_RenderFinishedSemaphores[m_CurrentFrame] };
+    m_Disp.cmdDispatch(commandBuffer, (m_RTWidth + ACCUMULATE_GROUP_SIZE - 1) / ACCUMULATE_GROUP_SIZE, (m_RTHeight + ACCUMULATE_GROUP_SIZE - 1) / ACCUMULATE_GROUP_SIZE, 1);
 
-    VkSubmitInfo submitsInfo;
-    submitsInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitsInfo.pNext = NULL;
-    submitsInfo.waitSemaphoreCount = 1;
-    submitsInfo.pWaitSemaphores = waitSemaphores;
-    submitsInfo.pWaitDstStageMask = waitStages;
-    submitsInfo.commandBufferCount = 1;
-    submitsInfo.pCommandBuffers = &m_CommandBuffers[m_CurrentFrame];
-    submitsInfo.signalSemaphoreCount = 1;
-    submitsInfo.pSignalSemaphores = signalSemaphores;
+    // Sampled by the ImGui pass
+    barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-    m_Disp.resetFences(1, &m_InFlightFences[m_CurrentFrame]);
+    VkBufferMemoryBarrier bufferBarrier{};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = m_ProgressiveErrorBuffers[m_CurrentFrame].Buffer;
+    bufferBarrier.offset = 0;
+    bufferBarrier.size = VK_WHOLE_SIZE;
 
-    VK_CHECK(m_Disp.queueSubmit(m_GraphicsQueue, 1, &submitsInfo, m_InFlightFences[m_CurrentFrame]));
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | (writeError ? VK_PIPELINE_STAGE_HOST_BIT : 0),
+        0,
+        0, nullptr,
+        writeError ? 1u : 0u, &bufferBarrier,
+        1, &barrier);
 
-    VkPresentInfoKHR presentInfo{};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    if (writeError)
+        m_ProgressiveErrorSamples[m_CurrentFrame] = sampleCount;
+}
 
-    presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
+bool VulkanCore::WriteOfflineFrame(const OfflineRenderSettings& settings, uint32_t frame, const void* pixels)
+{
+    char fileName[1024];
+    snprintf(fileName, sizeof(fileName), settings.OutputPattern.c_str(), frame);
 
-    VkSwapchainKHR swapChains[] = { m_Swapchain };
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = swapChains;
-    presentInfo.pImageIndices = &imageIndex;
-    presentInfo.pResults = nullptr; // Optionnel
+    const int width = static_cast<int>(settings.Width);
+    const int height = static_cast<int>(settings.Height);
 
-    result = vkQueuePresentKHR(m_PresentQueue, &presentInfo);
+    std::string path = fileName;
+    bool hdr = path.size() >= 4 && path.compare(path.size() - 4, 4, ".hdr") == 0;
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+    int result = 0;
+    if (hdr)
     {
-        RecreateSwapChain();
-        return;
+        result = stbi_write_hdr(fileName, width, height, 4, static_cast<const float*>(pixels));
     }
-    else if (result != VK_SUCCESS) {
-        debug_log("Failed to present image!");
-        return;
+    else
+    {
+        // Already packed to RGBA8 by ColorConvert.comp
+        result = stbi_write_png(fileName, width, height, 4, pixels, width * 4);
     }
 
-    m_CurrentFrame = (m_CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    if (result == 0)
+        debug_log("Failed to write " << fileName << " !");
+
+    return result != 0;
 }
 
 VulkanCore::~VulkanCore()
 {
     m_Disp.deviceWaitIdle();
 
+    m_ShaderWatcher.Stop();
+    if (m_ShaderReload.valid())
+        DestroyShaderModules(m_ShaderReload.get());
+
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
         m_Disp.destroySemaphore(m_ImageAvailableSemaphores[i], nullptr);
         m_Disp.destroySemaphore(m_RenderFinishedSemaphores[i], nullptr);
@@ -1002,9 +4287,43 @@ VulkanCore::~VulkanCore()
 
     m_Disp.destroyCommandPool(m_GraphicPool, nullptr);
     m_Disp.destroyCommandPool(m_TransferPool, nullptr);
-
-    m_Disp.destroyPipeline(m_GraphicPipeline, nullptr);
+    if (m_ComputePool != VK_NULL_HANDLE)
+        m_Disp.destroyCommandPool(m_ComputePool, nullptr);
+
+    m_Disp.destroySemaphore(m_SimTimeline, nullptr);
+    m_Disp.destroySemaphore(m_GraphicsTimeline, nullptr);
+
+    ClearImageVariants();
+    for (const auto& [pipeline, frames] : m_RetiredPipelines)
+        m_Disp.destroyPipeline(pipeline, nullptr);
+    for (VkPipeline library : m_ImageLibraries)
+        m_Disp.destroyPipeline(library, nullptr);
+    m_Disp.destroyShaderEXT(m_ImageVertexShader, nullptr);
+    for (VkShaderModule shaderModule : m_BuiltinModules)
+        m_Disp.destroyShaderModule(shaderModule, nullptr);
+    m_Disp.destroyShaderModule(m_ImageFragmentModule, nullptr);
+    m_Disp.destroyPipeline(m_CubemapPipeline, nullptr);
+    m_Disp.destroyPipeline(m_SimComputePipeline, nullptr);
+    m_Disp.destroyPipeline(m_SimFragmentPipeline, nullptr);
     m_Disp.destroyPipelineLayout(m_GraphicPipelineLayout, nullptr);
+    m_Disp.destroyPipelineCache(m_PipelineCache, nullptr);
+    m_Disp.destroyPipelineLayout(m_SimPipelineLayout, nullptr);
+    m_Disp.destroyDescriptorSetLayout(m_SimSetLayout, nullptr);
+    m_Disp.destroyDescriptorPool(m_SimDescriptorPool, nullptr);
+    m_Disp.destroyQueryPool(m_TimestampQueryPool, nullptr);
+    m_Disp.destroyDescriptorSetLayout(m_FrameSetLayout, nullptr);
+    m_Disp.destroyDescriptorPool(m_FrameDescriptorPool, nullptr);
+    m_Disp.destroyDescriptorSetLayout(m_BindlessSetLayout, nullptr);
+    m_Disp.destroyPipeline(m_ConvertPipeline, nullptr);
+    m_Disp.destroyPipelineLayout(m_ConvertPipelineLayout, nullptr);
+    m_Disp.destroyDescriptorSetLayout(m_ConvertSetLayout, nullptr);
+    m_Disp.destroyDescriptorPool(m_ConvertDescriptorPool, nullptr);
+    m_Disp.destroyPipeline(m_ProgressivePipeline, nullptr);
+    m_Disp.destroyPipelineLayout(m_ProgressivePipelineLayout, nullptr);
+    m_Disp.destroyDescriptorSetLayout(m_ProgressiveSetLayout, nullptr);
+    m_Disp.destroyDescriptorPool(m_ProgressiveDescriptorPool, nullptr);
+    DestroyProgressiveTarget();
+    m_Disp.destroyDescriptorPool(m_BindlessDescriptorPool, nullptr);
 
     m_Swapchain.destroy_image_views(m_SwapchainImageViews);
 
@@ -1013,11 +4332,24 @@ VulkanCore::~VulkanCore()
         m_RTImages[i].Clenup(m_Allocator, m_Disp);
     }
 
+    if (m_CubemapAttachmentView != VK_NULL_HANDLE)
+        m_Disp.destroyImageView(m_CubemapAttachmentView, nullptr);
+    m_CubemapImage.Clenup(m_Allocator, m_Disp);
+
+    for (auto& simImage : m_SimImages)
+        simImage.Clenup(m_Allocator, m_Disp);
+    m_SimBuffer.Clenup(m_Allocator);
+    m_UniformRing.Clenup(m_Allocator);
+
+    m_Disp.destroySampler(m_ChannelSampler, nullptr);
     m_Disp.destroySampler(m_ImGuiSampler, nullptr);
 
-    ImGui_ImplVulkan_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
+    if (!m_Offline)
+    {
+        ImGui_ImplVulkan_Shutdown();
+        ImGui_ImplGlfw_Shutdown();
+        ImGui::DestroyContext();
+    }
 
     vmaDestroyAllocator(m_Allocator);
 
@@ -1029,13 +4361,72 @@ VulkanCore::~VulkanCore()
     vkb::destroy_instance(m_Instance);
 }
 
-void VulkanCore::GetPushConstant(PushConstants& pushConstant)
+void VulkanCore::GetShaderInputs(ShaderInputs& shaderInputs)
+{
+    shaderInputs.iFrame = m_FrameCount;
+    shaderInputs.iFrameRate = m_fps;
+    shaderInputs.iTime = static_cast<float>(m_SimulationTime);
+    shaderInputs.iTimeDelta = m_DeltaTime;
+    shaderInputs.iMouse = glm::vec4(m_CurrentMousePose, (m_MouseDown ? 1.f : -1.f) * m_LastClickMousePose.x, -m_LastClickMousePose.y);
+
+    if (m_Offline)
+    {
+        // Offline frames must not depend on the wall clock
+        shaderInputs.iDate = glm::vec4(2000.f, 0.f, 1.f, static_cast<float>(m_SimulationTime));
+    }
+    else
+    {
+        // Shadertoy convention : year, month (0-11), day (1-31), seconds since midnight
+        auto now = std::chrono::system_clock::now();
+        auto today = std::chrono::floor<std::chrono::days>(now);
+        std::chrono::year_month_day ymd{ today };
+        float seconds = std::chrono::duration<float>(now - today).count();
+        shaderInputs.iDate = glm::vec4(static_cast<int>(ymd.year()), static_cast<unsigned>(ymd.month()) - 1, static_cast<unsigned>(ymd.day()), seconds);
+    }
+
+    for (int i = 0; i < 4; i++)
+        shaderInputs.iChannelTime[i] = glm::vec4(static_cast<float>(m_SimulationTime), 0.f, 0.f, 0.f);
+
+    shaderInputs.iChannelResolution[0] = glm::vec4(m_CubemapSize, m_CubemapSize, 1.f, 0.f);
+    shaderInputs.iChannelResolution[1] = glm::vec4(m_SimSettings.GridSize, 1.f, 0.f);
+    shaderInputs.iChannelResolution[2] = glm::vec4(0.f);
+    shaderInputs.iChannelResolution[3] = glm::vec4(0.f);
+
+    shaderInputs.iSampleRate = 44100.f;
+
+    for (uint32_t i = 0; i < USER_PARAM_COUNT; i++)
+        shaderInputs.iUserParams[i] = m_UserParams[i];
+}
+
+void VulkanCore::WriteShaderInputs(uint32_t slice)
+{
+    ShaderInputs shaderInputs{};
+    GetShaderInputs(shaderInputs);
+
+    // The slices of this frame are no longer read : its fence (and simulation timeline value) were waited on in Draw
+    const VkDeviceSize offset = (m_CurrentFrame * m_UniformSlicesPerFrame + slice) * m_UniformRingStride;
+    memcpy(m_UniformRingData + offset, &shaderInputs, sizeof(ShaderInputs));
+
+    // No-op on HOST_COHERENT memory
+    vmaFlushAllocation(m_Allocator, m_UniformRing.BufferAllocation, offset, sizeof(ShaderInputs));
+}
+
+void VulkanCore::BindShaderInputs(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t slice)
 {
-    pushConstant.iResolution = glm::vec3(m_RTWidth, m_RTHeight, 1.f);
-    pushConstant.iFrame = m_FrameCount;
-    pushConstant.iFrameRate = m_fps;
-    pushConstant.iTime = static_cast<float>(m_SimulationTime);
-    pushConstant.iTimeDelta = m_DeltaTime;
-    pushConstant.iMouse = glm::vec4(m_CurrentMousePose, (m_MouseDown ? 1.f : -1.f) * m_LastClickMousePose.x, -m_LastClickMousePose.y);
-    pushConstant.iDate = glm::vec4(0.f);
+    const uint32_t dynamicOffset = static_cast<uint32_t>((m_CurrentFrame * m_UniformSlicesPerFrame + slice) * m_UniformRingStride);
+
+    m_Disp.cmdBindDescriptorSets(commandBuffer, bindPoint, layout, 1, 1, &m_FrameDescriptorSet, 1, &dynamicOffset);
+}
+
+void VulkanCore::DrawUniformsPanel()
+{
+    ImGui::Begin("Uniforms");
+
+    for (uint32_t i = 0; i < USER_PARAM_COUNT; i++)
+    {
+        std::string label = "iUserParams[" + std::to_string(i) + "]";
+        ImGui::DragFloat4(label.c_str(), &m_UserParams[i].x, 0.01f);
+    }
+
+    ImGui::End();
 }
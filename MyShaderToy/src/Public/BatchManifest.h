@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct BatchShaderEntry
+{
+    std::string Path;
+    std::string Name;               // output file name, unique in the list : the manifest path without extension, '_' between the directories
+    std::vector<float> Timestamps;
+    std::vector<uint64_t> Hashes;   // expected HashImage per timestamp, 0 : not recorded
+};
+
+// The shaders of manifest in order, or the .frag files of directory sorted by path when manifest is empty.
+// Manifest lines : <shader> [timestamps] [expected hashes], '#' starts a comment, the paths are relative to the manifest.
+// timestamps : used by the shaders without their own list.
+bool ListBatchShaders(const std::string& manifest, const std::string& directory, const std::vector<float>& timestamps, std::vector<BatchShaderEntry>& entries);
+
+// Rewrites the timestamps and hashes of every shader line of manifest, entries as listed by ListBatchShaders with the hashes of a run.
+// A hash of 0 is written as "-", the comments and the other lines are kept.
+bool RecordBatchHashes(const std::string& manifest, const std::vector<BatchShaderEntry>& entries);
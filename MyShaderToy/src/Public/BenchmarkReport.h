@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+struct FrameTimeStats
+{
+    double Mean = 0.;
+    double Median = 0.;
+    double P95 = 0.;
+    double P99 = 0.;
+    double StdDev = 0.;
+    size_t Count = 0;
+
+    // times : milliseconds, in any order
+    static FrameTimeStats Compute(std::vector<float> times);
+
+    // b.Mean - a.Mean, ci95 : half-width of its 95 % confidence interval (normal approximation, unequal variances)
+    static double MeanDifference(const FrameTimeStats& a, const FrameTimeStats& b, double& ci95);
+};
+
+struct BenchmarkResult
+{
+    std::string Name;
+    std::string Path;
+    bool Success = false;       // false : the shader didn't compile or timed out
+    FrameTimeStats Gpu;         // Image pass, from the timestamp queries
+    FrameTimeStats Cpu;         // inputs, recording and submission of a frame
+    std::string Recipe;         // SPIR-V recipe of Gpu and Cpu
+
+    // A/B mode, CompareRecipe is empty when off
+    std::string CompareRecipe;
+    FrameTimeStats CompareGpu;
+    FrameTimeStats CompareCpu;
+    double DeltaMs = 0.;        // CompareGpu.Mean - Gpu.Mean
+    double DeltaCi95Ms = 0.;
+};
+
+// Benchmark results as JSON, one shader per line so that a baseline can be read back without a JSON library
+class BenchmarkReport
+{
+public:
+    void Add(const BenchmarkResult& result) { m_Results.push_back(result); }
+
+    const std::vector<BenchmarkResult>& GetResults() const { return m_Results; }
+
+    bool Write(const std::string& path, uint32_t width, uint32_t height, uint32_t frames) const;
+
+    // Median GPU time per shader name of a report written by Write
+    static bool LoadBaseline(const std::string& path, std::map<std::string, double>& gpuMedians);
+
+private:
+    std::vector<BenchmarkResult> m_Results;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+// Shaders that never change with the user's shaders, compiled by the custom build steps of MyShaderToy.vcxproj
+enum BuiltinShader : uint32_t
+{
+    BUILTIN_SHADER_FULLSCREEN_VERTEX,   // Shader/Vertex/Shader0.vert, shared by every fullscreen pass
+    BUILTIN_SHADER_COLOR_CONVERT,       // Shader/Compute/ColorConvert.comp
+    BUILTIN_SHADER_ACCUMULATE,          // Shader/Compute/Accumulate.comp
+    BUILTIN_SHADER_COUNT,
+};
+
+// Embedded SPIR-V words
+std::span<const uint32_t> GetBuiltinShaderCode(BuiltinShader shader);
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Watches a set of files on a background thread. The directories are watched through change notifications,
+// they are polled every PollSeconds when a notification can't be registered. A burst of writes on a file is
+// reported once, after the file stayed untouched for DebounceSeconds.
+class FileWatcher
+{
+public:
+    ~FileWatcher();
+
+    void Start(const std::vector<std::string>& paths, float debounceSeconds, float pollSeconds = 0.5f);
+
+    void Stop();
+
+    // Files modified since the last call, each one listed once
+    std::vector<std::string> PollChanges();
+
+private:
+    struct WatchedFile
+    {
+        std::string Path;
+        std::filesystem::file_time_type WriteTime;
+        std::chrono::steady_clock::time_point LastChange;
+        bool Pending = false;
+    };
+
+    void Run();
+
+    // Returns true while a change waits for its debounce window
+    bool ScanFiles();
+
+    std::vector<WatchedFile> m_Files;
+    std::vector<std::string> m_Directories;
+    std::chrono::duration<float> m_Debounce{ 0.f };
+    std::chrono::duration<float> m_PollInterval{ 0.f };
+
+    std::vector<std::string> m_Changes;
+    std::mutex m_Mutex;
+
+    std::thread m_Thread;
+    void* m_StopEvent = nullptr;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "ImageDiff.h"
+
+#include <string>
+
+enum class GoldenStatus
+{
+    Passed,
+    MissingReference,   // no readable reference of the render size
+    Failed,
+};
+
+struct GoldenComparison
+{
+    GoldenStatus Status = GoldenStatus::Passed;
+    std::string Report;         // why the comparison failed
+    bool Written = true;        // false : the heat map couldn't be written
+};
+
+// render : tightly packed RGBA8, compared to the PNG referencePath.
+// A failed diff writes its heat map to heatMapPath.
+GoldenComparison CompareGolden(const uint8_t* render, uint32_t width, uint32_t height, const std::string& referencePath, const ImageDiffTolerance& tolerance,
+    const std::string& heatMapPath);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// A comparison fails when more than MaxDifferentPixels (fraction of the image) differ by more than
+// PixelThreshold on any channel, or when the structural similarity drops below MinSsim
+struct ImageDiffTolerance
+{
+    uint8_t PixelThreshold = 2;
+    float MaxDifferentPixels = 0.001f;
+    float MinSsim = 0.98f;
+};
+
+struct ImageDiffResult
+{
+    uint32_t DifferentPixels = 0;
+    uint8_t MaxDifference = 0;      // largest channel difference
+    double MeanDifference = 0.;     // mean absolute channel difference
+    double Ssim = 1.;               // mean SSIM of the 8x8 luma blocks
+
+    bool Passed(const ImageDiffTolerance& tolerance, uint32_t pixelCount) const;
+};
+
+// a, b : tightly packed RGBA8 images of the same size.
+// heatMap (RGBA8, optional) : the reference dimmed to grey, the pixels above the threshold from yellow to red.
+ImageDiffResult DiffImages(const uint8_t* a, const uint8_t* b, uint32_t width, uint32_t height, uint8_t threshold, uint8_t* heatMap = nullptr);
+
+// FNV-1a 64 of the pixel bytes : exact match of two renders
+uint64_t HashImage(const uint8_t* pixels, size_t size);
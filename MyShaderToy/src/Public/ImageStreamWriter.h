@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Writes an image band by band, top row first, so that posters larger than the host memory can be saved.
+// Rows are handed to WriteRows in the file pixel layout (GetPixelSize bytes) : RGBA8 packed on the GPU for PNG, RGBA32F for EXR.
+class ImageStreamWriter
+{
+public:
+    virtual ~ImageStreamWriter() = default;
+
+    virtual bool Open(const std::string& path, uint32_t width, uint32_t height) = 0;
+
+    virtual uint32_t GetPixelSize() const = 0;
+
+    virtual bool WriteRows(const uint8_t* rows, uint32_t rowCount) = 0;
+
+    virtual bool Close() = 0;
+
+    // PngStreamWriter or ExrStreamWriter from the extension of path, nullptr if unsupported
+    static std::unique_ptr<ImageStreamWriter> Create(const std::string& path);
+};
+
+// RGBA8 PNG, adaptive filtering and one fixed Huffman deflate block per row, each in its own IDAT.
+// Only the previous row and the last 32K of the zlib stream window are kept.
+class PngStreamWriter : public ImageStreamWriter
+{
+public:
+    bool Open(const std::string& path, uint32_t width, uint32_t height) override;
+
+    uint32_t GetPixelSize() const override { return 4; }
+
+    bool WriteRows(const uint8_t* rows, uint32_t rowCount) override;
+
+    bool Close() override;
+
+private:
+    void WriteChunk(const char type[4], const uint8_t* data, size_t size);
+
+    std::ofstream m_File;
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+    uint32_t m_RowsWritten = 0;
+    uint32_t m_Adler = 1;
+    uint32_t m_BitBuffer = 0;   // deflate bits not written yet
+    uint32_t m_BitCount = 0;
+    std::vector<uint8_t> m_PreviousRow;
+    std::vector<uint8_t> m_Window;
+    std::vector<uint8_t> m_Chunk;
+};
+
+// Uncompressed scanline OpenEXR, 32 bits float RGBA. Every scanline has the same size so the offset table is known upfront.
+class ExrStreamWriter : public ImageStreamWriter
+{
+public:
+    bool Open(const std::string& path, uint32_t width, uint32_t height) override;
+
+    uint32_t GetPixelSize() const override { return 4 * sizeof(float); }
+
+    bool WriteRows(const uint8_t* rows, uint32_t rowCount) override;
+
+    bool Close() override;
+
+private:
+    std::ofstream m_File;
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+    uint32_t m_RowsWritten = 0;
+    std::vector<float> m_Scanline;
+};
+
+// Conversions of an --output pattern, -1 when it holds anything but %% and %d / %Nd / %0Nd : it's used as a printf format
+int CountFrameConversions(const std::string& pattern);
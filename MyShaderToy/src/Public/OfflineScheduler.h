@@ -0,0 +1,74 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Jobs (frame chunks or poster bands) spread over the offline devices.
+// Job j starts in the deque of device j % deviceCount, a device pops the front of its own deque
+// and, once it is empty, steals the back of the longest one.
+// window : when not 0, no job is handed out window jobs or more past the write head, so that the outputs
+// waiting for an earlier one stay bounded. The earliest job is stolen instead, or Pop waits for the head.
+class OfflineJobQueue
+{
+public:
+    OfflineJobQueue(uint32_t jobCount, uint32_t deviceCount, uint32_t window = 0);
+
+    // false once every job has been taken or the queue was aborted.
+    // drain : called before waiting on the write head, it must hand every output of the device to the writer.
+    bool Pop(uint32_t device, uint32_t& job, bool& stolen, const std::function<void()>& drain = {});
+
+    // First job whose outputs aren't all written yet
+    void SetWriteHead(uint32_t job);
+
+    // A device failed : the jobs it took are lost, the other devices stop at their next Pop
+    void Abort();
+
+private:
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    std::vector<std::deque<uint32_t>> m_Deques;
+    uint32_t m_Window;
+    uint32_t m_WriteHead = 0;
+    bool m_Aborted = false;
+};
+
+// Hands the outputs of every device to a single writer in index order (video frames, poster bands).
+// An output pushed in order is written from the caller buffer, the others are copied until their turn.
+class OrderedOutput
+{
+public:
+    using WriteFunction = std::function<bool(uint32_t index, const void* data)>;
+
+    OrderedOutput(uint32_t firstIndex, WriteFunction write);
+
+    void Push(uint32_t index, const void* data, size_t size);
+
+    bool Succeeded() const { return m_Success; }
+
+    // Outputs waiting for an earlier one, sampled for the report
+    size_t GetMaxPending() const { return m_MaxPending; }
+
+private:
+    std::mutex m_Mutex;
+    WriteFunction m_Write;
+    uint32_t m_NextIndex;
+    std::map<uint32_t, std::vector<uint8_t>> m_Pending;
+    size_t m_MaxPending = 0;
+    bool m_Success = true;
+};
+
+struct OfflineDeviceStats
+{
+    std::string DeviceName;
+    uint32_t Jobs = 0;
+    uint32_t StolenJobs = 0;
+    uint32_t Outputs = 0;       // frames or bands
+    float Seconds = 0.f;
+    bool Success = true;
+};
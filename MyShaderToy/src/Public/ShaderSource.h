@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Shadertoy style sources : a fragment shader without #version only holds mainImage and its helpers.
+// The inputs, the channels and main are generated around it, #line keeps the errors on the lines of name.
+// Sources with a #version are returned unchanged.
+std::string ComposeFragmentSource(const std::string& source, const std::string& name);
+
+// A source with its own #version and main : nothing is generated around it, iFragCoordOffset is not applied
+bool IsCompleteShaderSource(const std::string& source);
+
+// SPIR-V optimization recipe : glslc optimization level, then spirv-opt passes when OptimizerPasses is set
+struct SpirvRecipe
+{
+    const char* Name;
+    const char* GlslcFlags;
+    const char* OptimizerPasses;
+};
+
+constexpr SpirvRecipe SPIRV_RECIPES[] = {
+    { "O0", "-O0", nullptr },
+    { "O", "-O", nullptr },
+    { "Os", "-Os", nullptr },
+    { "O+unroll", "-O", "--loop-unroll-partial=4 --ccp --eliminate-dead-code-aggressive --eliminate-dead-branches" },
+};
+
+constexpr uint32_t SPIRV_RECIPE_COUNT = static_cast<uint32_t>(sizeof(SPIRV_RECIPES) / sizeof(SPIRV_RECIPES[0]));
+// glslc's own default
+constexpr uint32_t SPIRV_DEFAULT_RECIPE = 0;
+
+// Index in SPIRV_RECIPES, -1 when name is unknown
+int32_t FindSpirvRecipe(const std::string& name);
+
+// glslc through pipes : the source goes to stdin, the SPIR-V comes back on stdout, no file is written.
+// errors : the glslc diagnostics, also filled when the compilation succeeds with warnings.
+// A glslc or spirv-opt process still running after 30 seconds is terminated and the compilation fails.
+bool CompileGlsl(const std::string& source, const std::string& stage, const std::string& flags, std::string& spirv, std::string& errors);
+
+// spirv-opt through pipes, spirv is replaced by the optimized module on success
+bool OptimizeSpirv(std::string& spirv, const std::string& passes, std::string& errors);
+
+enum class SpecConstantType
+{
+    Bool,
+    Int,
+    UInt,
+    Float,
+};
+
+// layout(constant_id = Id) const <type> Name = Default;
+struct SpecConstant
+{
+    uint32_t Id = 0;
+    std::string Name;       // "constant_id <Id>" when the module has no debug names
+    SpecConstantType Type = SpecConstantType::Int;
+    uint32_t Default = 0;   // bit pattern, VkBool32 for booleans
+    uint32_t Value = 0;
+};
+
+// 32 bits scalar specialization constants of a SPIR-V module, sorted by Id
+std::vector<SpecConstant> ReflectSpecConstants(const std::string& spirv);
+
+// Absolute and lexically normal : the key of a shader file in the include guard, the dependency graph and the watcher
+std::string NormalizeShaderPath(const std::filesystem::path& path);
+
+// #include "file" resolution and SPIR-V cache, shared by the compilation threads.
+// Includes are relative to the including file and expanded once per source. Every file read is a node of the
+// dependency graph with the hash of its content. The SPIR-V of the last compilation is kept per shader, stage and
+// recipe with the hash of its expanded source, so an unchanged pass is not compiled again and an edit replaces it.
+class ShaderCompiler
+{
+public:
+    // dependencies : every file read, the shader first, also filled when the compilation fails
+    bool Compile(const std::string& path, const std::string& stage, uint32_t recipe, std::string& spirv, std::vector<std::string>& dependencies, std::string& errors);
+
+    // Reads the file again, false when its content hash didn't change since the last compilation
+    bool HasChanged(const std::string& path);
+
+    // Appends path to source with its includes in place, each behind a #line naming its file.
+    // dependencies : the files already expanded, skipped when included again, path is appended
+    bool ExpandIncludes(const std::filesystem::path& path, std::string& source, std::vector<std::string>& dependencies, std::string& errors);
+
+private:
+    struct CachedSpirv
+    {
+        uint64_t SourceHash = 0;
+        std::string Spirv;
+    };
+
+    std::map<std::string, uint64_t> m_FileHashes;
+    std::map<std::string, CachedSpirv> m_Spirv;
+    std::mutex m_Mutex;
+};
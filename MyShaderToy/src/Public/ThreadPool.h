@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of workers with one queue each, Submit returns a future of the task result.
+// Tasks submitted from outside are spread round robin and run in submission order, a worker submitting a task
+// keeps it on its own queue and runs its newest one first. An idle worker steals the oldest task of another queue.
+class ThreadPool
+{
+public:
+    // 0 : one worker per hardware thread
+    explicit ThreadPool(uint32_t threadCount = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template<typename F>
+    std::future<std::invoke_result_t<F>> Submit(F&& task)
+    {
+        using Result = std::invoke_result_t<F>;
+
+        // std::function needs a copyable callable, the packaged_task is shared
+        auto packagedTask = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> future = packagedTask->get_future();
+
+        Push([packagedTask]() { (*packagedTask)(); });
+
+        return future;
+    }
+
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Threads.size()); }
+
+private:
+    struct WorkerQueue
+    {
+        std::deque<std::function<void()>> Submitted;    // from outside the pool, FIFO
+        std::deque<std::function<void()>> Spawned;      // by the worker itself, LIFO
+        std::mutex Mutex;
+    };
+
+    void Push(std::function<void()> task);
+
+    // Own newest spawned task first, then own oldest submitted task, then the oldest task of the other queues
+    std::function<void()> TakeTask(uint32_t worker);
+
+    void WorkerLoop(uint32_t worker);
+
+    std::vector<std::thread> m_Threads;
+    std::vector<std::unique_ptr<WorkerQueue>> m_Queues;
+    std::atomic<uint32_t> m_NextQueue = 0;
+    // Queued tasks not yet claimed by a worker
+    uint32_t m_PendingCount = 0;
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    bool m_Stopping = false;
+};
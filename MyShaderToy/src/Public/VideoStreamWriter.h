@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Layout of the frames packed on the GPU by Shader/Compute/ColorConvert.comp
+enum class VideoFormat
+{
+    Rgba8,
+    Rgba16,
+    Yuv420,     // YUV4MPEG2, planar 4:2:0
+    Yuv444,     // YUV4MPEG2, planar 4:4:4
+    Nv12,       // raw, Y plane then interleaved UV 4:2:0
+};
+
+// Raw frames for an external encoder (ffmpeg -f rawvideo / -f yuv4mpegpipe) on stdout ("-"), a named pipe or a file.
+// Frames are written straight from the readback buffer, the CPU only moves bytes.
+class VideoStreamWriter
+{
+public:
+    ~VideoStreamWriter();
+
+    // Keeps the real stdout for the video and redirects everything else printed on it (logs, validation) to stderr.
+    // Must be called before anything is logged.
+    static void ReserveStdout();
+
+    bool Open(const std::string& target, VideoFormat format, uint32_t width, uint32_t height, double fps);
+
+    bool WriteFrame(const void* data);
+
+    void Close();
+
+    // Sustained frames per second since the first frame
+    float GetFramesPerSecond() const;
+
+    uint32_t GetFrameCount() const { return m_FrameCount; }
+
+    static size_t GetFrameSize(VideoFormat format, uint32_t width, uint32_t height);
+
+    static bool ParseFormat(const std::string& name, VideoFormat& format);
+
+private:
+    static FILE* s_ReservedStdout;
+
+    FILE* m_File = nullptr;
+    bool m_OwnsFile = false;
+    VideoFormat m_Format = VideoFormat::Rgba8;
+    size_t m_FrameSize = 0;
+    uint32_t m_FrameCount = 0;
+    std::chrono::steady_clock::time_point m_FirstFrameTime;
+};
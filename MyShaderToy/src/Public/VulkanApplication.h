@@ -1,6 +1,8 @@
 ﻿#pragma once
 
 #include <iostream>
+#include <memory>
+#include <optional>
 #include "GlfwWindow.h"
 #include "VulkanCore.h"
 
@@ -10,11 +12,20 @@ class VulkanApplication
 public:
     explicit VulkanApplication(const std::string& ApplicationName = "DefaultApplication", uint32_t ApplicationVersion = 0, const std::string& EngineName = "DefaultEngine", uint32_t EngineVersion = 0, int width = 1080, int height = 720);
 
-    void run();
+    // Headless application rendering settings.EndFrame frames to disk
+    VulkanApplication(const std::string& ApplicationName, uint32_t ApplicationVersion, const std::string& EngineName, uint32_t EngineVersion, const OfflineRenderSettings& settings);
+
+    // Process exit code : 0, or 1 when an offline render, batch, golden or benchmark run failed
+    int run();
     
     ~VulkanApplication();
     
 private:
     GlfwWindow m_GlfwWindow;
     VulkanCore m_VulkanCore;
+    std::optional<OfflineRenderSettings> m_OfflineSettings;
+    // Offline multi device : devices 1..N-1, m_VulkanCore is device 0
+    std::vector<std::unique_ptr<VulkanCore>> m_ExtraDevices;
+
+    void CreateResources(VulkanCore& core, int width, int height);
 };
@@ -8,10 +8,27 @@
 #include <imgui/imgui_impl_vulkan.h>
 #include <imgui/imgui_stdlib.h>
 #include <glm/glm.hpp>
+#include "BatchManifest.h"
+#include "BenchmarkReport.h"
+#include "BuiltinShaders.h"
+#include "FileWatcher.h"
 #include "GlfwWindow.h"
+#include "GoldenImage.h"
+#include "ImageDiff.h"
+#include "ImageStreamWriter.h"
+#include "OfflineScheduler.h"
+#include "ShaderSource.h"
+#include "ThreadPool.h"
+#include "VideoStreamWriter.h"
 #include "ImGuiGlslEditor.h"
 #include "log.h"
+#include <array>
 #include <chrono>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <unordered_map>
 #include <vector>
 #include <iostream>
 #define NOMINMAX
@@ -23,45 +40,55 @@ constexpr auto MAX_FRAMES_IN_FLIGHT = 3;
 
 #define PRESENT_MODE VK_PRESENT_MODE_FIFO_KHR
 
-#ifdef NDEBUG
-constexpr bool enableValidationLayers = false;
+#define IMAGE_SHADER_PATH ".\\Shader\\Frag\\Shader0.frag"
 
-inline void CompileShaderCommand(const std::string& command)
-{
-    std::wstring cmd = L"cmd.exe /C " + std::wstring(command.begin(), command.end());
+#define CUBEMAP_SIZE 1024u
 
-    STARTUPINFOW si = { sizeof(STARTUPINFOW) };
-    PROCESS_INFORMATION pi;
+#define CUBEMAP_SHADER_PATH ".\\Shader\\Frag\\Cube0.frag"
 
-    // Important : buffer modifiable pour CreateProcessW
-    std::wstring mutable_cmd = cmd;
+// One view per cube face (+X, -X, +Y, -Y, +Z, -Z), all rendered by a single multiview draw
+constexpr uint32_t CUBEMAP_VIEW_MASK = 0x3Fu;
 
-    if (CreateProcessW(
-        NULL,
-        &mutable_cmd[0],
-        NULL, NULL, FALSE,
-        CREATE_NO_WINDOW, NULL, NULL,
-        &si, &pi))
-    {
-        WaitForSingleObject(pi.hProcess, INFINITE);
-        CloseHandle(pi.hProcess);
-        CloseHandle(pi.hThread);
-    }
-    else
-    {
-        DWORD error = GetLastError();
-        std::wcerr << L"CreateProcessW failed with error code: " << error << std::endl;
-    }
-}
+// Capacity of the bindless channel table, passes index it with PushConstants::iChannels
+#define BINDLESS_IMAGE_COUNT 64u
+#define BINDLESS_SAMPLER_COUNT 4u
+constexpr uint32_t BINDLESS_INVALID_SLOT = ~0u;
 
-#else
-constexpr bool enableValidationLayers = true;
+#define ACCUMULATE_GROUP_SIZE 8u
+// The variance estimate is read back every ACCUMULATE_ERROR_INTERVAL samples
+#define ACCUMULATE_ERROR_INTERVAL 16u
 
-inline void CompileShaderCommand(const std::string& command)
-{
-    std::system(command.c_str());
-}
+// Offline frames are distributed over the devices by chunks, each device replays the simulation up to its chunk
+#define OFFLINE_FRAMES_PER_JOB 8u
+// Ordered outputs (video frames, poster bands) : a device doesn't take a job further than this many jobs per device past the write head
+#define OFFLINE_JOBS_AHEAD_PER_DEVICE 2u
 
+#define SIM_COMPUTE_SHADER_PATH ".\\Shader\\Compute\\Sim0.comp"
+#define SIM_FRAGMENT_SHADER_PATH ".\\Shader\\Frag\\Sim0.frag"
+
+#define SIM_IMAGE_FORMAT VK_FORMAT_R32G32B32A32_SFLOAT
+
+// Saves of a shader closer than this are folded into a single reload
+#define SHADER_WATCH_DEBOUNCE_SECONDS 0.2f
+
+// Image pass pipelines kept per set of specialization constant values
+#define IMAGE_VARIANT_CACHE_SIZE 8u
+
+#define SIM_SIZE 512u
+
+constexpr uint32_t SIM_BUFFER_SIZE = 64u * sizeof(glm::vec4);
+
+// m_SimImages[0..1] are the per-frame outputs read by the Image pass, [2..3] the intermediate steps
+constexpr uint32_t SIM_OUTPUT_IMAGE_COUNT = 2u;
+constexpr uint32_t SIM_IMAGE_COUNT = 4u;
+
+// Per frame in flight : simulation begin/end, Image pass begin/end
+constexpr uint32_t TIMESTAMPS_PER_FRAME = 4u;
+
+#ifdef NDEBUG
+constexpr bool enableValidationLayers = false;
+#else
+constexpr bool enableValidationLayers = true;
 #endif
 
 #define VK_CHECK(x)                                                 \
@@ -94,15 +121,231 @@ struct ImageData
     }
 };
 
+struct BufferData
+{
+    VkBuffer Buffer = VK_NULL_HANDLE;
+    VmaAllocation BufferAllocation;
+
+    void Clenup(VmaAllocator allocator)
+    {
+        if (Buffer != VK_NULL_HANDLE)
+            vmaDestroyBuffer(allocator, Buffer, BufferAllocation);
+    }
+};
+
+// Per pass values, the frame inputs live in the ShaderInputs uniform ring
 struct PushConstants {
     glm::vec3 iResolution;    // 12 bytes
-    float iTime;              // 4 bytes
-    float iTimeDelta;         // 4 bytes
-    float iFrameRate;         // 4 bytes
-    uint32_t iFrame;               // 4 bytes
-    float padding0;           // 4 bytes (pour aligner les vec4 à 16 bytes)
-    glm::vec4 iMouse;         // 16 bytes
-    glm::vec4 iDate;          // 16 bytes
+    float padding0;           // 4 bytes
+    glm::uvec4 iChannels;     // 16 bytes, bindless slots of iChannel0..3
+    glm::vec2 iFragCoordOffset; // 8 bytes, position of the rendered tile inside iResolution
+    glm::vec2 padding1;       // 8 bytes
+};
+
+struct SimPushConstants {
+    PushConstants Pass;       // 48 bytes
+    glm::uvec2 iGridSize;     // 8 bytes
+    uint32_t iStep;           // 4 bytes
+    uint32_t padding0;        // 4 bytes
+};
+
+constexpr uint32_t USER_PARAM_COUNT = 8u;
+
+#define CONVERT_FLAG_SRGB 0x1u
+#define CONVERT_FLAG_DITHER 0x2u
+
+struct ConvertPushConstants {
+    glm::uvec2 iSize;         // 8 bytes
+    uint32_t iFormat;         // 4 bytes, VideoFormat
+    uint32_t iByteCount;      // 4 bytes
+    uint32_t iToneMap;        // 4 bytes, ToneMapOperator
+    uint32_t iFlags;          // 4 bytes, CONVERT_FLAG_*
+    float iExposure;          // 4 bytes
+    uint32_t iSeed;           // 4 bytes, dithering pattern
+    glm::uvec2 iOffset;       // 8 bytes, origin of the converted tile in the whole image
+};
+
+struct AccumulatePushConstants {
+    glm::uvec2 iSize;         // 8 bytes
+    uint32_t iSampleCount;    // 4 bytes, including the new sample
+    uint32_t iWriteError;     // 4 bytes, 1 : the per workgroup error sums are written
+};
+
+// std140 block shared by every pass (set 1, binding 0), one slice per frame in flight
+struct ShaderInputs {
+    float iTime;                        // 4 bytes
+    float iTimeDelta;                   // 4 bytes
+    float iFrameRate;                   // 4 bytes
+    uint32_t iFrame;                    // 4 bytes
+    glm::vec4 iMouse;                   // 16 bytes
+    glm::vec4 iDate;                    // 16 bytes
+    glm::vec4 iChannelTime[4];          // 64 bytes (std140 array stride, only x is used)
+    glm::vec4 iChannelResolution[4];    // 64 bytes (vec3 in GLSL)
+    float iSampleRate;                  // 4 bytes
+    float padding0[3];                  // 12 bytes
+    glm::vec4 iUserParams[USER_PARAM_COUNT]; // 128 bytes
+};
+
+enum class BindlessImageType
+{
+    Texture2D,
+    TextureCube,
+};
+
+enum class SimulationBackend
+{
+    Compute,
+    Fragment,
+};
+
+struct SimulationSettings
+{
+    SimulationBackend Backend = SimulationBackend::Compute;
+    glm::uvec2 GridSize = glm::uvec2(SIM_SIZE);
+    glm::uvec2 WorkgroupSize = glm::uvec2(16u, 16u);
+    int StepsPerFrame = 8;
+    // Run on a separate compute queue, the Image pass then shows the state of the previous frame
+    bool AsyncCompute = true;
+};
+
+// Passes rebuilt by a shader reload
+enum ShaderPassBits : uint32_t
+{
+    SHADER_PASS_IMAGE = 1u << 0,
+    SHADER_PASS_CUBEMAP = 1u << 1,
+    SHADER_PASS_SIMULATION = 1u << 2,
+    SHADER_PASS_ALL = SHADER_PASS_IMAGE | SHADER_PASS_CUBEMAP | SHADER_PASS_SIMULATION,
+};
+
+// Image pass pipelines for one set of specialization constant values
+struct ImageVariant
+{
+    uint64_t Key = 0;
+    VkPipeline Pipeline = VK_NULL_HANDLE;
+    VkPipeline Accumulate = VK_NULL_HANDLE;    // built by CreateAccumulatePipeline, VK_NULL_HANDLE until then or when RT_IMAGE_FORMAT can't be blended
+    VkPipeline FragmentLibrary = VK_NULL_HANDLE;   // graphics pipeline library mode only
+    VkShaderEXT FragmentShader = VK_NULL_HANDLE;    // shader object mode only, replaces every pipeline
+    // Link time optimized Pipeline, built in the background and swapped in once ready
+    std::future<VkPipeline> Optimized;
+};
+
+// Prebuilt parts of the image pass pipelines, VK_EXT_graphics_pipeline_library
+enum ImageLibraryPart : uint32_t
+{
+    IMAGE_LIBRARY_VERTEX_INPUT,
+    IMAGE_LIBRARY_PRE_RASTERIZATION,
+    IMAGE_LIBRARY_OUTPUT,
+    IMAGE_LIBRARY_ACCUMULATE_OUTPUT,    // blending into the target, VK_NULL_HANDLE when RT_IMAGE_FORMAT can't be blended
+    IMAGE_LIBRARY_PART_COUNT,
+};
+
+// A pass whose module is missing keeps its current pipelines
+struct ShaderPassModules
+{
+    uint32_t Passes = 0;
+    VkShaderModule Image = VK_NULL_HANDLE;
+    VkShaderModule Cubemap = VK_NULL_HANDLE;
+    VkShaderModule SimCompute = VK_NULL_HANDLE;
+    VkShaderModule SimFragment = VK_NULL_HANDLE;
+    // Created on the compilation workers with their module, the image pass builds its variants on the render thread
+    VkPipeline CubemapPipeline = VK_NULL_HANDLE;
+    VkPipeline SimComputePipeline = VK_NULL_HANDLE;
+    VkPipeline SimFragmentPipeline = VK_NULL_HANDLE;
+    // local_size specialization of SimComputePipeline
+    glm::uvec2 WorkgroupSize{ 0u };
+    std::vector<SpecConstant> ImageConstants;
+    // Code of Image, its shader objects are created from it
+    std::string ImageSpirv;
+    // Dependency graph of this compilation : file -> SHADER_PASS_* reading it
+    std::map<std::string, uint32_t> Files;
+    // Stages compiled and wall time of the whole build
+    uint32_t StageCount = 0;
+    float BuildMs = 0.f;
+};
+
+// Tone curve of 8/16 bits captures, the values must match TONEMAP_* in ColorConvert.comp
+enum class ToneMapOperator
+{
+    Clamp,
+    Reinhard,
+    Aces,
+};
+
+// Applied by ColorConvert.comp to every 8/16 bits capture, float outputs (.hdr, .exr) are read back untouched
+struct CaptureSettings
+{
+    ToneMapOperator ToneMap = ToneMapOperator::Clamp;
+    float Exposure = 1.f;
+    bool SrgbEncode = false;    // for shaders writing linear colors
+    bool Dither = false;
+};
+
+// Windowed progressive rendering : the Image pass samples are averaged until one of the stop conditions is met
+struct ProgressiveSettings
+{
+    bool Enabled = false;
+    int MaxSamples = 4096;          // 0 : no limit
+    float TargetVariance = 0.f;     // variance of the mean luminance, 0 : disabled
+};
+
+// Thumbnails of every .frag of Directory : one image per shader and timestamp plus a contact sheet (one row per shader)
+struct BatchRenderSettings
+{
+    std::string Directory;
+    std::string OutputDirectory = "thumbnails";
+    std::vector<float> Timestamps = { 1.f, 5.f, 10.f };   // iTime of each thumbnail, in seconds
+    float TimeoutSeconds = 2.f; // per shader : pipeline creation, then GPU time of a thumbnail or benchmark frame, one still running stops the run
+    uint32_t ThreadCount = 0;   // compilation workers, 0 without --threads : one per hardware thread
+    // Golden image tests : one "<shader path> [t0,t1,...]" per line, relative to the manifest, Timestamps when no time is given
+    std::string Manifest;
+    // Thumbnails are compared to <ReferenceDirectory>/<name>_<t>.png, only the failures are written (render and heat map)
+    std::string ReferenceDirectory;
+    ImageDiffTolerance Tolerance;
+    // Rewrites the expected hashes of Manifest with the ones of this run
+    bool RecordHashes = false;
+
+    bool IsEnabled() const { return !Directory.empty() || !Manifest.empty(); }
+};
+
+// Shader benchmark over the shaders of Batch.Directory / Batch.Manifest at Width x Height :
+// WarmupFrames of StartFrame, then frames StartFrame to EndFrame are measured
+struct BenchmarkSettings
+{
+    bool Enabled = false;
+    std::string OutputPath = "benchmark.json";
+    std::string BaselinePath;           // previous report, compared on the median GPU time
+    uint32_t WarmupFrames = 60;
+    float RegressionThreshold = 0.05f;  // relative slowdown counted as a regression
+    // A/B mode when set : each frame is rendered by the SpirvRecipe and CompareRecipe pipelines of each shader, in alternating order
+    int32_t CompareRecipe = -1;
+};
+
+// Command line driven render (MyShaderToy.exe --offline ...), no window, no swapchain
+struct OfflineRenderSettings
+{
+    std::string ShaderPath = IMAGE_SHADER_PATH;
+    uint32_t Width = 1920;
+    uint32_t Height = 1080;
+    double Fps = 60.;
+    uint32_t StartFrame = 0;
+    uint32_t EndFrame = 600;    // exclusive
+    std::string OutputPattern = "frame_%05d.png"; // printf pattern with a single %d, .png (8 bits) or .hdr (32 bits float)
+    // Poster mode when non zero : only StartFrame is written, rendered tile by tile and streamed to a .png or .exr
+    glm::uvec2 TileSize = glm::uvec2(0u);
+    // Raw video stream instead of image files when set : "-" (stdout), a named pipe or a file
+    std::string VideoTarget;
+    VideoFormat VideoOutputFormat = VideoFormat::Yuv420;
+    CaptureSettings Capture;
+    // Batch thumbnail mode when Batch.Directory is set, Width x Height is then the thumbnail size
+    BatchRenderSettings Batch;
+    // Frame chunks or poster bands are spread over this many physical devices, 0 : every eligible one
+    uint32_t DeviceCount = 1;
+    // Motion blur : sub-frames averaged on the GPU per output frame, iTime jittered within the shutter interval
+    uint32_t SubFrames = 1;
+    float Shutter = 0.5f;       // fraction of the frame interval the shutter stays open
+    bool SubPixelJitter = false;
+    BenchmarkSettings Benchmark;
+    uint32_t SpirvRecipe = SPIRV_DEFAULT_RECIPE;    // index in SPIRV_RECIPES
 };
 
 class VulkanCore
@@ -111,7 +354,7 @@ public:
 
     void SetWindow(GlfwWindow* window);
 
-    void CreateDevice(const std::string& ApplicationName, uint32_t ApplicationVersion, const std::string& EngineName, uint32_t EngineVersion);
+    bool CreateDevice(const std::string& ApplicationName, uint32_t ApplicationVersion, const std::string& EngineName, uint32_t EngineVersion);
 
     void CreateSwapChain();
 
@@ -123,9 +366,19 @@ public:
 
     void CreateVmaAllocator();
 
-    void CompileShader(const std::string& spv_path);
+    VkShaderModule createModuleFromCode(std::span<const uint32_t> code);
+
+    VkShaderModule createModuleFromCode(const std::string& spirv);
+
+    // Modules of the embedded shaders, created once and shared by every pass
+    void CreateBuiltinModules();
 
-    VkShaderModule createModule(const std::string& spv_path);
+    // Compiled in memory through m_ShaderCompiler, Shadertoy style fragment sources get the generated preamble and main.
+    // dependencies : the files read, includes included.
+    // recipe : index in SPIRV_RECIPES
+    // specConstants : filled with the specialization constants of the module when not null, spirv : with its code
+    VkShaderModule CompileShaderModule(const std::string& path, const std::string& stage, uint32_t recipe, std::vector<std::string>& dependencies,
+        std::vector<SpecConstant>* specConstants = nullptr, std::string* spirv = nullptr);
 
     void CreateGraphicPipeline();
 
@@ -133,23 +386,196 @@ public:
 
     void CreateSyncObject();
 
+    void ImmediateSubmit(const std::function<void(VkCommandBuffer)>& record);
+
     void CreateRenderTarget(uint32_t width, uint32_t height);
 
     void RecreateRenderTarget(uint32_t width, uint32_t height);
 
+    void CreateCubemapTarget(uint32_t size);
+
+    void CreateSimulation(const SimulationSettings& settings);
+
+    void CreateBindlessTable();
+
+    void CreateTimestampQueries();
+
+    // subFrameCount > 1 : each frame in flight also gets one slice per accumulated sub-frame
+    void CreateUniformRing(uint32_t subFrameCount = 1);
+
     void InitImGui();
 
     void RecordCommandBuffer(uint32_t imageIndex, ImDrawData* imGui_draw_data);
 
-    void ReloadShader();
+    // Asynchronous : the passes are compiled on a background thread and swapped in by a later Draw
+    void ReloadShader(uint32_t passes = SHADER_PASS_ALL);
+
+    // Reloads the passes of the shader files saved from an external editor
+    void StartShaderWatch();
 
     void Draw();
 
+    void SetImageShaderPath(const std::string& path);
+
+    // Used by the next compilations, ReloadShader applies it to the live passes
+    void SetSpirvRecipe(uint32_t recipe);
+
+    bool RenderOffline(const OfflineRenderSettings& settings);
+
+    // Renders the frames or poster bands of settings over several devices, the outputs are merged in order
+    static bool RenderOffline(const OfflineRenderSettings& settings, const std::vector<VulkanCore*>& devices);
+
+    // Offline multi device : index in the list of eligible physical devices, -1 lets the selector pick one
+    void SetPhysicalDeviceIndex(int32_t index);
+
+    uint32_t GetEligibleDeviceCount() const { return m_EligibleDeviceCount; }
+
     ~VulkanCore();
 
 private:
 
-    void GetPushConstant(PushConstants& pushConstant);
+    void GetShaderInputs(ShaderInputs& shaderInputs);
+
+    // slice 0 : frame inputs, 1..N : sub-frames of an accumulated Image pass
+    void WriteShaderInputs(uint32_t slice = 0);
+
+    void BindShaderInputs(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t slice = 0);
+
+    void DrawUniformsPanel();
+
+    uint32_t RegisterBindlessImage(BindlessImageType type, VkImageView view, VkImageLayout layout);
+
+    void WriteBindlessImage(BindlessImageType type, uint32_t slot, VkImageView view, VkImageLayout layout);
+
+    glm::uvec4 GetChannelSlots() const;
+
+    void DrawChannelsPanel();
+
+    // accumulate : blends with the target using the dynamic blend constants, dst * (1 - c) + src * c
+    // libraryParts : a pipeline library holding only these parts of the state when non zero
+    VkPipeline CreateFullscreenPipeline(VkShaderModule vertexShaderModule, VkShaderModule fragmentShaderModule, VkPipelineLayout layout, VkFormat format, uint32_t viewMask, bool accumulate = false,
+        const VkSpecializationInfo* fragmentSpecialization = nullptr, VkGraphicsPipelineLibraryFlagsEXT libraryParts = 0);
+
+    // Vertex input, pre-rasterization and output parts of the image pass, built once around the built-in vertex shader
+    void CreateImageLibraries();
+
+    // Thread safe, optimize : link time optimization, otherwise a fast link
+    VkPipeline LinkImagePipeline(VkPipeline fragmentLibrary, bool accumulate, bool optimize);
+
+    // Swaps in the finished optimized links, destroys the pipelines they replaced once no frame uses them
+    void UpdateImageVariants();
+
+    // Waits for the background link of variant first
+    void DestroyImageVariant(ImageVariant& variant);
+
+    // Unlinked VK_EXT_shader_object stage of the image pass, with the layout of m_GraphicPipelineLayout
+    VkShaderEXT CreateImageShader(VkShaderStageFlagBits stage, std::span<const uint32_t> code, const VkSpecializationInfo* specialization);
+
+    // Binds the image shader objects and sets every state a pipeline would have baked
+    void BindImageShaders(VkCommandBuffer commandBuffer, VkShaderEXT fragmentShader);
+
+    // Recreates the image variants with the other backend, to compare their creation time
+    void SetShaderObjects(bool enabled);
+
+    void RecordCubemapPass(VkCommandBuffer commandBuffer);
+
+    void CreateSimulationPipelines();
+
+    // Thread safe : every stage compiles and creates its pipeline as a task of m_CompilePool, the results are joined in pass order.
+    // workgroupSize : m_SimSettings.WorkgroupSize read on the render thread
+    ShaderPassModules CompileShaderPasses(uint32_t passes, uint32_t recipe, glm::uvec2 workgroupSize);
+
+    bool IsWorkgroupSizeSupported(glm::uvec2 size) const;
+
+    VkPipeline CreateSimComputePipeline(VkShaderModule computeShaderModule, glm::uvec2 workgroupSize);
+
+    // Swaps in the pipelines of the compiled passes and destroys the modules, the passes must be idle
+    void CreatePassPipelines(ShaderPassModules modules);
+
+    // Points m_GraphicPipeline and m_AccumulatePipeline to the variant of the current m_ImageSpecConstants values,
+    // created from the kept image modules through m_PipelineCache when it isn't in m_ImageVariants
+    void SelectImageVariant();
+
+    // Only sub-frame renders blend into the target : the accumulate pipeline of the current variant is built on their first use
+    void CreateAccumulatePipeline();
+
+    void ClearImageVariants();
+
+    // Modules and the pipelines that weren't swapped in
+    void DestroyShaderModules(const ShaderPassModules& modules);
+
+    // compiledPasses now depend on the files of modules only, the watcher follows the new set of files
+    void UpdateShaderDependencies(const ShaderPassModules& modules, uint32_t compiledPasses);
+
+    // Collects the watched changes, starts the pending compilation and applies the finished one
+    void UpdateShaderReload();
+
+    void RecordSimulationPass(VkCommandBuffer commandBuffer, bool onComputeQueue);
+
+    bool UseAsyncCompute() const;
+
+    void SubmitSimulation();
+
+    float TimestampDeltaMs(uint64_t begin, uint64_t end) const;
+
+    void ReadTimestamps(uint32_t frameIndex);
+
+    void DrawSimulationPanel();
+
+    void DrawProgressivePanel();
+
+    void DrawShaderPanel();
+
+    void CreateProgressivePipeline();
+
+    void CreateProgressiveTarget(uint32_t width, uint32_t height);
+
+    void DestroyProgressiveTarget();
+
+    void WriteProgressiveDescriptors();
+
+    void ResetProgressive();
+
+    // Called before the shader inputs of the frame are written, restarts the average when they changed
+    void UpdateProgressiveState();
+
+    bool IsProgressiveConverged() const;
+
+    void RecordProgressivePass(VkCommandBuffer commandBuffer);
+
+    // pipeline : m_GraphicPipeline when VK_NULL_HANDLE.
+    // subFrameCount > 1 : the sub-frames (ShaderInputs slices 1..N) are averaged into target within one rendering
+    void RecordImagePass(VkCommandBuffer commandBuffer, const ImageData& target, const VkRect2D& region, VkPipeline pipeline = VK_NULL_HANDLE,
+        uint32_t subFrameCount = 1, bool subPixelJitter = false);
+
+    void* CreateReadbackBuffer(VkDeviceSize size, BufferData& buffer, VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+
+    void CreateColorConvertPipeline();
+
+    void WriteColorConvertDescriptors(uint32_t slot, const ImageData& source, const BufferData& destination);
+
+    // offset : position of the tile in the poster, the dithering is keyed by the pixel of the whole image
+    void RecordColorConvert(VkCommandBuffer commandBuffer, uint32_t slot, VkExtent2D extent, VideoFormat format, const CaptureSettings& capture, uint32_t seed, const BufferData& destination,
+        VkOffset2D offset = {});
+
+    void RecordReadback(VkCommandBuffer commandBuffer, const ImageData& source, VkExtent2D extent, const BufferData& buffer);
+
+    void SetupOfflineInputs(const OfflineRenderSettings& settings);
+
+    void SetOfflineFrame(const OfflineRenderSettings& settings, uint32_t frame);
+
+    bool WriteOfflineFrame(const OfflineRenderSettings& settings, uint32_t frame, const void* pixels);
+
+    bool RenderSequenceJobs(const OfflineRenderSettings& settings, OfflineJobQueue& jobs, uint32_t device, OrderedOutput* output, OfflineDeviceStats& stats);
+
+    bool RenderPosterJobs(const OfflineRenderSettings& settings, OfflineJobQueue& jobs, uint32_t device, uint32_t pixelSize, OrderedOutput& output, OfflineDeviceStats& stats);
+
+    bool RenderBatch(const OfflineRenderSettings& settings);
+
+    bool RenderBenchmark(const OfflineRenderSettings& settings);
+
+    // Called from the batch compilation workers, VK_NULL_HANDLE if the shader doesn't compile
+    VkPipeline CreateBatchPipeline(const std::string& shaderPath, uint32_t recipe);
 
     vkb::Instance m_Instance;
     vkb::InstanceDispatchTable m_Inst_disp;
@@ -159,14 +585,131 @@ private:
     VkQueue m_GraphicsQueue = VK_NULL_HANDLE;
     VkQueue m_TranferQueue = VK_NULL_HANDLE;
     VkQueue m_PresentQueue = VK_NULL_HANDLE;
+    VkQueue m_ComputeQueue = VK_NULL_HANDLE;
+    uint32_t m_ComputeQueueFamily = VK_QUEUE_FAMILY_IGNORED;
+    bool m_ComputeTimestamps = false;
+    bool m_GraphicsTimestamps = false;
     VkCommandPool m_GraphicPool = VK_NULL_HANDLE;
     VkCommandPool m_TransferPool = VK_NULL_HANDLE;
-    GlfwWindow* m_Window;
+    VkCommandPool m_ComputePool = VK_NULL_HANDLE;
+    GlfwWindow* m_Window = nullptr;  // nullptr when rendering offline
+    std::string m_ImageShaderPath = IMAGE_SHADER_PATH;
+    uint32_t m_SpirvRecipe = SPIRV_DEFAULT_RECIPE;
+    bool m_Offline = false;
+    int32_t m_PhysicalDeviceIndex = -1;
+    uint32_t m_EligibleDeviceCount = 1;
+    uint32_t m_TransferQueueFamily = 0;
 
     VmaAllocator m_Allocator;
 
     VkPipelineLayout m_GraphicPipelineLayout = VK_NULL_HANDLE;
     VkPipeline m_GraphicPipeline = VK_NULL_HANDLE;
+    VkPipeline m_CubemapPipeline = VK_NULL_HANDLE;
+    // Image shader blending into its target, VK_NULL_HANDLE when RT_IMAGE_FORMAT can't be blended
+    VkPipeline m_AccumulatePipeline = VK_NULL_HANDLE;
+    VkPipelineCache m_PipelineCache = VK_NULL_HANDLE;
+    // VK_EXT_graphics_pipeline_library : image variants are linked from m_ImageLibraries, monolithic otherwise
+    bool m_PipelineLibrary = false;
+    std::array<VkPipeline, IMAGE_LIBRARY_PART_COUNT> m_ImageLibraries = {};
+    // Replaced by an optimized link, destroyed when the frame count reaches 0
+    std::vector<std::pair<VkPipeline, uint32_t>> m_RetiredPipelines;
+    // VK_EXT_shader_object : the live image pass binds shader objects instead of pipelines
+    bool m_ShaderObjectSupported = false;
+    bool m_UseShaderObjects = false;
+    VkShaderEXT m_ImageVertexShader = VK_NULL_HANDLE;
+    std::string m_ImageFragmentSpirv;
+    // Creation time of the last image variant, with the backend that created it
+    float m_ImageVariantMs = 0.f;
+    const char* m_ImageVariantBackend = "";
+
+    // Indexed by BuiltinShader
+    std::array<VkShaderModule, BUILTIN_SHADER_COUNT> m_BuiltinModules = {};
+
+    // Fragment module of the image pass, kept to build its specialization variants
+    VkShaderModule m_ImageFragmentModule = VK_NULL_HANDLE;
+    std::vector<SpecConstant> m_ImageSpecConstants;
+    // Most recently used first, m_GraphicPipeline and m_AccumulatePipeline belong to the front one
+    std::list<ImageVariant> m_ImageVariants;
+    std::unordered_map<uint64_t, std::list<ImageVariant>::iterator> m_ImageVariantIndex;
+
+    ShaderCompiler m_ShaderCompiler;
+    // Shared by every shader build of this device, work stealing keeps the workers busy when the passes differ in cost
+    std::unique_ptr<ThreadPool> m_CompilePool;
+    // Last build, shown against its stage count in the Shader panel
+    uint32_t m_ShaderBuildStages = 0;
+    float m_ShaderBuildMs = 0.f;
+    std::map<std::string, uint32_t> m_ShaderFilePasses;
+    FileWatcher m_ShaderWatcher;
+    bool m_WatchShaders = false;
+    std::future<ShaderPassModules> m_ShaderReload;
+    uint32_t m_PendingShaderPasses = 0;
+
+    // Persistently mapped, MAX_FRAMES_IN_FLIGHT slices bound with a dynamic offset
+    BufferData m_UniformRing;
+    uint8_t* m_UniformRingData = nullptr;
+    VkDeviceSize m_UniformRingStride = 0;
+    uint32_t m_UniformSlicesPerFrame = 1;
+    VkDescriptorSetLayout m_FrameSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool m_FrameDescriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet m_FrameDescriptorSet = VK_NULL_HANDLE;
+    std::array<glm::vec4, USER_PARAM_COUNT> m_UserParams = {};
+
+    // Single update-after-bind set : reallocating a channel only rewrites its array slot
+    VkDescriptorSetLayout m_BindlessSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool m_BindlessDescriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet m_BindlessDescriptorSet = VK_NULL_HANDLE;
+    std::array<uint32_t, 2> m_BindlessImageCount = {};  // per BindlessImageType
+    uint32_t m_DescriptorWriteCount = 0;
+    uint32_t m_DescriptorWritesLastFrame = 0;
+    VkSampler m_ChannelSampler = VK_NULL_HANDLE;
+    uint32_t m_CubemapSlot = BINDLESS_INVALID_SLOT;
+    // Capture packing (ColorConvert.comp), one set per frame in flight : render target -> readback buffer
+    VkDescriptorSetLayout m_ConvertSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout m_ConvertPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_ConvertPipeline = VK_NULL_HANDLE;
+    VkDescriptorPool m_ConvertDescriptorPool = VK_NULL_HANDLE;
+    std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> m_ConvertDescriptorSets = {};
+    // Progressive accumulation (Accumulate.comp), one set per frame in flight : render target -> m_ProgressiveImage
+    ProgressiveSettings m_Progressive;
+    VkDescriptorSetLayout m_ProgressiveSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout m_ProgressivePipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_ProgressivePipeline = VK_NULL_HANDLE;
+    VkDescriptorPool m_ProgressiveDescriptorPool = VK_NULL_HANDLE;
+    std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> m_ProgressiveDescriptorSets = {};
+    ImageData m_ProgressiveImage;  // running mean, always in VK_IMAGE_LAYOUT_GENERAL once written
+    VkDescriptorSet m_ProgressiveImGuiDescriptor = VK_NULL_HANDLE;
+    std::array<BufferData, MAX_FRAMES_IN_FLIGHT> m_ProgressiveErrorBuffers;
+    std::array<float*, MAX_FRAMES_IN_FLIGHT> m_ProgressiveErrorData = {};
+    std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> m_ProgressiveErrorSamples = {};  // sample count of the pending estimate, 0 : none
+    uint32_t m_ProgressiveGroupCount = 0;
+    uint32_t m_ProgressiveSamples = 0;
+    float m_ProgressiveVariance = -1.f;
+    ShaderInputs m_ProgressiveInputs{};
+    glm::uvec4 m_ProgressiveChannels = glm::uvec4(0u);
+
+    std::array<uint32_t, SIM_OUTPUT_IMAGE_COUNT> m_SimChannelSlots = { BINDLESS_INVALID_SLOT, BINDLESS_INVALID_SLOT };
+
+    SimulationSettings m_SimSettings;
+    std::array<ImageData, SIM_IMAGE_COUNT> m_SimImages;
+    BufferData m_SimBuffer;
+    uint32_t m_SimOutputIndex = 0;  // output holding the latest state
+    uint32_t m_SimDisplayIndex = 0; // output sampled by this frame's Image pass
+    VkDescriptorSetLayout m_SimSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool m_SimDescriptorPool = VK_NULL_HANDLE;
+    // Indexed by source * SIM_IMAGE_COUNT + destination
+    std::array<VkDescriptorSet, SIM_IMAGE_COUNT * SIM_IMAGE_COUNT> m_SimDescriptorSets = {};
+    VkPipelineLayout m_SimPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_SimComputePipeline = VK_NULL_HANDLE;
+    VkPipeline m_SimFragmentPipeline = VK_NULL_HANDLE;
+
+    VkQueryPool m_TimestampQueryPool = VK_NULL_HANDLE;
+    std::array<bool, MAX_FRAMES_IN_FLIGHT> m_TimestampsWritten = {};
+    std::array<bool, MAX_FRAMES_IN_FLIGHT> m_TimestampsHaveSim = {};
+    std::array<SimulationBackend, MAX_FRAMES_IN_FLIGHT> m_TimestampsBackend = {};
+    float m_TimestampPeriod = 1.f;
+    uint64_t m_TimestampMask = ~0ull;
+    std::array<float, 2> m_SimGpuTimeMs = { -1.f, -1.f }; // indexed by SimulationBackend
+    float m_ImageGpuTimeMs = -1.f;
 
     vkb::Swapchain m_Swapchain;
     std::vector<VkImage> m_SwapchainImages;
@@ -177,10 +720,24 @@ private:
     std::vector<VkFence> m_InFlightFences;
 
     std::vector<VkCommandBuffer> m_CommandBuffers;
+    std::vector<VkCommandBuffer> m_ComputeCommandBuffers;
+
+    // Timeline semaphores synchronising the async compute queue with the graphics queue
+    VkSemaphore m_SimTimeline = VK_NULL_HANDLE;
+    VkSemaphore m_GraphicsTimeline = VK_NULL_HANDLE;
+    uint64_t m_SimTimelineValue = 0;
+    uint64_t m_GraphicsTimelineValue = 0;
+    uint64_t m_SimWaitValue = 0;
+    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> m_SimSlotValues = {};
 
     std::vector<ImageData> m_RTImages;
     uint32_t m_RTWidth, m_RTHeight = 1u;
 
+    ImageData m_CubemapImage;
+    VkImageView m_CubemapAttachmentView = VK_NULL_HANDLE;
+    uint32_t m_CubemapSize = CUBEMAP_SIZE;
+    bool m_CubemapInitialized = false;
+
     ImGuiIO* m_io;
     VkDescriptorPool m_ImGuiDescriptorPool = VK_NULL_HANDLE;
     std::vector<VkDescriptorSet> m_ImGuiDescriptors;
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <iostream>
+#include <mutex>
 
 #ifdef NDEBUG
     #define debug_log(msg) do {} while(0)
 #else
-    #define debug_log(msg) std::cout << msg << std::endl
+    // Offline devices and compilation workers log from their own threads, one line at a time
+    inline std::mutex& GetLogMutex() { static std::mutex mutex; return mutex; }
+    #define debug_log(msg) do { std::lock_guard<std::mutex> logLock(GetLogMutex()); std::cout << msg << std::endl; } while(0)
 #endif
\ No newline at end of file